@@ -1,15 +1,6 @@
 layout(location = 0) out vec3 fColor;
 
-layout(std140, binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
-};
+#include <assets/shaders/shared.h>
 
 void main()
 {
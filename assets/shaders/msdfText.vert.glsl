@@ -0,0 +1,27 @@
+layout(location = 4) out vec2 fTexCoords;
+layout(location = 5) flat out vec4 fColor;
+
+#include <assets/shaders/shared.h>
+
+struct GlyphQuad
+{
+	vec2 center;
+	vec2 size;
+	vec4 uvRect;
+	vec4 color;
+};
+
+layout (std430, binding = 1) buffer glyphQuadSSBO
+{
+	GlyphQuad GlyphQuads[];
+};
+
+void main()
+{
+	GlyphQuad quad = GlyphQuads[gl_InstanceID];
+	vec2 pixelPos = quad.center + VA_Position.xy * quad.size;
+	pixelPos.y = -pixelPos.y;
+	gl_Position = PIXEL_SPACE_TO_GL_SPACE(pixelPos);
+	fTexCoords = mix(quad.uvRect.xy, quad.uvRect.zw, VA_UV);
+	fColor = quad.color;
+}
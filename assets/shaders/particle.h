@@ -2,4 +2,7 @@
 	-1.0 : \
 	((PARTICLE_CYCLE_TIME >= spawnTime) ? \
 		(PARTICLE_CYCLE_TIME - spawnTime) : \
-		(PARTICLE_CYCLE_TIME + (PARTICLE_LIFETIME - spawnTime))))
\ No newline at end of file
+		(PARTICLE_CYCLE_TIME + (PARTICLE_LIFETIME - spawnTime))))
+
+// position after timeAlive seconds, initial velocity comes from the particle buffer and acceleration is uniform
+#define PARTICLE_POSITION(position, velocity, timeAlive) ((position) + (velocity) * (timeAlive) + 0.5 * PARTICLE_ACCELERATION * (timeAlive) * (timeAlive))
\ No newline at end of file
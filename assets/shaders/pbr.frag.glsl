@@ -9,17 +9,6 @@ layout(location = 5) in float fVertexAo;
 #define MAX_POINT_LIGHTS 10
 #define PI 3.14159265359
 
-layout (binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
-};
-
 uniform bool useVertexAo = false;
 
 uniform bool useAlbedoTexture = false;
@@ -1,4 +1,23 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+layout(std140, binding = 0) uniform SharedGpuData
+{
+	mat4 cameraMatrix;
+	float cameraPositionX;
+	float cameraPositionY;
+	float cameraPositionZ;
+	float windowSizeX;
+	float windowSizeY;
+};
+
+layout(std140, binding = 1) uniform ObjectGpuData
+{
+	mat4 modelMatrix;
+};
 
 #define WINDOW_SIZE_VEC vec2(windowSizeX, windowSizeY)
 #define CAMERA_POSITION_VEC vec3(cameraPositionX, cameraPositionY, cameraPositionZ)
-#define PIXEL_SPACE_TO_GL_SPACE(vecin) vec4(vecin.x / windowSizeX * 2.0 - 1.0, -vecin.y / windowSizeY * 2.0 + 1.0, 0.0, 1.0)
\ No newline at end of file
+#define PIXEL_SPACE_TO_GL_SPACE(vecin) vec4(vecin.x / windowSizeX * 2.0 - 1.0, -vecin.y / windowSizeY * 2.0 + 1.0, 0.0, 1.0)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef SKINNING_H
+#define SKINNING_H
+
+// SKINNING_DATA holds the bones of every skeleton drawn this frame, SKINNING_OFFSET is the first
+// vec4 of this instance's skeleton or SKINNING_DISABLED when it isn't animated
+#define SKINNING_DISABLED 0xFFFFFFFFu
+
+#if SKINNING_FORMAT_MATRIX4X4
+mat4 LoadBoneMatrix(uint first, uint bone)
+{
+	uint i = first + bone * 4u;
+	return mat4(SKINNING_DATA[i], SKINNING_DATA[i + 1u], SKINNING_DATA[i + 2u], SKINNING_DATA[i + 3u]);
+}
+#elif SKINNING_FORMAT_MATRIX3X4
+// rows of the matrix, the last one is always 0 0 0 1
+mat4 LoadBoneMatrix(uint first, uint bone)
+{
+	uint i = first + bone * 3u;
+	return transpose(mat4(SKINNING_DATA[i], SKINNING_DATA[i + 1u], SKINNING_DATA[i + 2u], vec4(0.0, 0.0, 0.0, 1.0)));
+}
+#endif
+
+mat4 ComputeSkinningMatrix(uvec4 bones, vec4 weights)
+{
+	uint first = SKINNING_OFFSET;
+	if (first == SKINNING_DISABLED)
+		return mat4(1.0);
+#if SKINNING_FORMAT_DUAL_QUATERNION
+	// real part then dual part per bone, blended in the hemisphere of the first bone
+	vec4 real0 = SKINNING_DATA[first + bones.x * 2u];
+	vec4 real = weights.x * real0;
+	vec4 dual = weights.x * SKINNING_DATA[first + bones.x * 2u + 1u];
+	for (int i = 1; i < 4; i++)
+	{
+		vec4 boneReal = SKINNING_DATA[first + bones[i] * 2u];
+		float weight = dot(real0, boneReal) < 0.0 ? -weights[i] : weights[i];
+		real += weight * boneReal;
+		dual += weight * SKINNING_DATA[first + bones[i] * 2u + 1u];
+	}
+	float invLength = 1.0 / length(real);
+	real *= invLength;
+	dual *= invLength;
+
+	vec3 t = 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+	float x = real.x, y = real.y, z = real.z, w = real.w;
+	return mat4(
+		1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y + w * z), 2.0 * (x * z - w * y), 0.0,
+		2.0 * (x * y - w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z + w * x), 0.0,
+		2.0 * (x * z + w * y), 2.0 * (y * z - w * x), 1.0 - 2.0 * (x * x + y * y), 0.0,
+		t, 1.0);
+#else
+	return
+		weights.x * LoadBoneMatrix(first, bones.x) +
+		weights.y * LoadBoneMatrix(first, bones.y) +
+		weights.z * LoadBoneMatrix(first, bones.z) +
+		weights.w * LoadBoneMatrix(first, bones.w);
+#endif
+}
+
+#endif
@@ -2,19 +2,23 @@ layout(location = 4) out vec2 fTexCoords;
 
 #include <assets/shaders/shared.h>
 
-layout(binding = 0) uniform SharedGpuData
+struct SpriteInstance
 {
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
+	vec2 topLeft;
+	vec2 size;
+	vec4 uvRect;
+};
+
+layout (std430, binding = 1) buffer spriteSSBO
+{
+	SpriteInstance Sprites[];
 };
 
 void main()
 {
-	fTexCoords = VA_UV;
-	gl_Position = PIXEL_SPACE_TO_GL_SPACE(VA_Position);
-}
\ No newline at end of file
+	SpriteInstance sprite = Sprites[gl_InstanceID];
+	// quad uvs grow upwards, pixel space grows downwards
+	vec2 pixelPos = sprite.topLeft + vec2(VA_UV.x, 1.0 - VA_UV.y) * sprite.size;
+	fTexCoords = mix(sprite.uvRect.xy, sprite.uvRect.zw, VA_UV);
+	gl_Position = PIXEL_SPACE_TO_GL_SPACE(pixelPos);
+}
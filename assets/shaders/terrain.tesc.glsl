@@ -8,16 +8,7 @@ out TCS_OUT {
 	vec2 uv;
 } tcs_out[];
 
-layout(binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
-};
+#include <assets/shaders/shared.h>
 
 uniform float maxResDistance = 70.0;
 uniform float minResDistance = 100.0;
@@ -1,13 +1,4 @@
-layout(binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
-};
+#include <assets/shaders/shared.h>
 
 uniform sampler2D heightmapTexture;
 uniform float maxHeight;
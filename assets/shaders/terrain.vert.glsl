@@ -3,16 +3,7 @@ out VS_OUT {
 	vec2 uv;
 } vs_out;
 
-layout(binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
-};
+#include <assets/shaders/shared.h>
 
 void main()
 {
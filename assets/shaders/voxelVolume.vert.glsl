@@ -1,15 +1,6 @@
 layout(location = 4) out vec2 fTexCoords;
 
-layout(binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
-};
+#include <assets/shaders/shared.h>
 
 uniform float voxelSize;
 uniform uint bufferSelect;
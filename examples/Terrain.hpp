@@ -35,16 +35,15 @@ namespace sf
 			this->material.tessSpacing = "equal_spacing";
 			this->material.tessWinding = "ccw";
 			this->material.tessPatchVertexCount = 4;
-			this->material.uniforms["heightmapTexture"].dataType = DataType::bitmap;
-			this->material.uniforms["heightmapTexture"].data.p = &this->heightmap;
-			// this->material.uniforms["heightmapRes"].dataType = DataType::u32;
-			// this->material.uniforms["heightmapRes"].data.u32 = this->heightmapResolution;
-			this->material.uniforms["maxHeight"].dataType = DataType::f32;
-			this->material.uniforms["maxHeight"].data.f32 = this->maxHeight;
+			this->material.SetUniform("heightmapTexture", DataType::bitmap, &this->heightmap);
+			// this->material.SetUniform("heightmapRes", this->heightmapResolution);
+			this->material.SetUniform("maxHeight", this->maxHeight);
 			this->material.drawMode = MaterialDrawMode::Lines;
 
 			this->mesh.vertexBufferLayout = &this->vertexBufferLayout;
 			MeshProcessor::GenerateGrid(this->mesh, patchCount + 1, patchCount + 1, this->heightmapResolution, this->heightmapResolution, heightmapPixelSize * ((float)(this->heightmapResolution - 1) / (float)patchCount), true);
+			// tessellation displaces the flat grid up to maxHeight
+			this->mesh.SetBounds(this->mesh.boundsMin, this->mesh.boundsMax + glm::vec3(0.0f, this->maxHeight, 0.0f));
 
 			this->entity = scene.CreateEntity();
 			Transform& e_t = this->entity.AddComponent<Transform>();
@@ -195,5 +195,6 @@ namespace errt
 		mesh.pieces = mesh.indexBuffer + indices.size();
 		mesh.pieces[0] = 0;
 		mesh.pieceCount = 1;
+		mesh.ComputeBounds();
 	}
 }
\ No newline at end of file
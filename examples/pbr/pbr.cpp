@@ -127,12 +127,12 @@ namespace sf
 			damagedHelmetRoughness.CopyChannel(tempMetalRoughness, 1, 0);
 
 			damagedHelmetMaterial.CreateFromFile("examples/pbr/DamagedHelmet.mat");
-			damagedHelmetMaterial.uniforms["albedoTexture"] = { DataType::bitmap, &damagedHelmetAlbedo };
-			damagedHelmetMaterial.uniforms["normalTexture"] = { DataType::bitmap, &damagedHelmetNormalmap };
-			damagedHelmetMaterial.uniforms["metalnessTexture"] = { DataType::bitmap, &damagedHelmetMetal };
-			damagedHelmetMaterial.uniforms["roughnessTexture"] = { DataType::bitmap, &damagedHelmetRoughness };
-			damagedHelmetMaterial.uniforms["aoTexture"] = { DataType::bitmap, &damagedHelmetAO };
-			damagedHelmetMaterial.uniforms["emissiveTexture"] = { DataType::bitmap, &damagedHelmetEmissive };
+			damagedHelmetMaterial.SetUniform("albedoTexture", DataType::bitmap, &damagedHelmetAlbedo);
+			damagedHelmetMaterial.SetUniform("normalTexture", DataType::bitmap, &damagedHelmetNormalmap);
+			damagedHelmetMaterial.SetUniform("metalnessTexture", DataType::bitmap, &damagedHelmetMetal);
+			damagedHelmetMaterial.SetUniform("roughnessTexture", DataType::bitmap, &damagedHelmetRoughness);
+			damagedHelmetMaterial.SetUniform("aoTexture", DataType::bitmap, &damagedHelmetAO);
+			damagedHelmetMaterial.SetUniform("emissiveTexture", DataType::bitmap, &damagedHelmetEmissive);
 
 			meshes[0] = MeshData(&meshVertexLayout);
 			GltfImporter::GenerateMeshData(gltfid, meshes[0]);
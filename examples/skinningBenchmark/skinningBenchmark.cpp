@@ -0,0 +1,116 @@
+#include <imgui.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include <Game.h>
+#include <Random.h>
+#include <MeshData.h>
+#include <SkeletonData.h>
+#include <MeshProcessor.h>
+
+#define BENCHMARK_VERTEX_COUNT 1000000
+#define BENCHMARK_ITERATIONS 20
+
+namespace sf
+{
+	namespace Game
+	{
+		struct BenchmarkResult
+		{
+			uint32_t boneCount;
+			double verticesPerSecond;
+		};
+
+		const uint32_t boneCounts[] = { 1, 16, 64, 256 };
+		std::vector<BenchmarkResult> results;
+		bool skinNormals = true;
+
+		using MeshVertexBufferLayout = StaticBufferLayout<
+			BufferComponent::Position,
+			BufferComponent::Normal,
+			BufferComponent::BoneWeights,
+			BufferComponent::BoneIndices>;
+		MeshData mesh(&MeshVertexBufferLayout::Get());
+		std::vector<glm::vec3> skinnedPositions;
+		std::vector<glm::vec3> skinnedNormals;
+
+		void RunBenchmark()
+		{
+			results.clear();
+			for (uint32_t boneCount : boneCounts)
+			{
+				SkeletonData skeleton;
+				skeleton.m_skinningMatrices.resize(boneCount);
+				for (glm::mat4& matrix : skeleton.m_skinningMatrices)
+				{
+					matrix = glm::mat4_cast(Random::Rotation());
+					matrix[3] = glm::vec4(Random::PointInSphere(), 1.0f);
+				}
+				auto weights = MeshVertexBufferLayout::View<glm::vec4, BufferComponent::BoneWeights>(mesh.vertexBuffer, mesh.vertexCount);
+				auto bones = MeshVertexBufferLayout::View<glm::vec4, BufferComponent::BoneIndices>(mesh.vertexBuffer, mesh.vertexCount);
+				for (uint32_t i = 0; i < mesh.vertexCount; i++)
+				{
+					weights[i] = glm::vec4(Random::Float(), Random::Float(), Random::Float(), Random::Float()) + 0.001f;
+					weights[i] /= weights[i].x + weights[i].y + weights[i].z + weights[i].w;
+					bones[i] = glm::vec4(Random::Int(boneCount), Random::Int(boneCount), Random::Int(boneCount), Random::Int(boneCount));
+				}
+
+				// first run warms up caches and the thread pool
+				MeshProcessor::ComputeSkinnedVertices(mesh, skeleton, skinnedPositions.data(), skinNormals ? skinnedNormals.data() : nullptr);
+				auto start = std::chrono::high_resolution_clock::now();
+				for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+					MeshProcessor::ComputeSkinnedVertices(mesh, skeleton, skinnedPositions.data(), skinNormals ? skinnedNormals.data() : nullptr);
+				double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+				BenchmarkResult& result = results.emplace_back();
+				result.boneCount = boneCount;
+				result.verticesPerSecond = (double)mesh.vertexCount * BENCHMARK_ITERATIONS / seconds;
+				std::cout << "[SkinningBenchmark] " << boneCount << " bones: " << result.verticesPerSecond / 1000000.0 << " million vertices per second\n";
+			}
+		}
+	}
+
+	Game::InitData Game::GetInitData()
+	{
+		InitData id;
+		id.windowTitle = "Skinning benchmark";
+		id.clearColor = { 0.1f, 0.1f, 0.1f };
+		return id;
+	}
+
+	void Game::Initialize(int argc, char** argv)
+	{
+		mesh.vertexCount = BENCHMARK_VERTEX_COUNT;
+		mesh.vertexBuffer = malloc(mesh.vertexCount * MeshVertexBufferLayout::Size);
+		for (glm::vec3& position : MeshVertexBufferLayout::View<glm::vec3, BufferComponent::Position>(mesh.vertexBuffer, mesh.vertexCount))
+			position = Random::PointInSphere();
+		for (glm::vec3& normal : MeshVertexBufferLayout::View<glm::vec3, BufferComponent::Normal>(mesh.vertexBuffer, mesh.vertexCount))
+			normal = Random::UnitVec3();
+		skinnedPositions.resize(mesh.vertexCount);
+		skinnedNormals.resize(mesh.vertexCount);
+
+		RunBenchmark();
+	}
+
+	void Game::Terminate()
+	{
+		free(mesh.vertexBuffer);
+	}
+
+	void Game::OnUpdate(float deltaTime, float time)
+	{
+	}
+
+	void Game::ImGuiCall()
+	{
+		ImGui::Begin("Skinning benchmark");
+		ImGui::Text("%u vertices, %u iterations", BENCHMARK_VERTEX_COUNT, BENCHMARK_ITERATIONS);
+		for (const BenchmarkResult& result : results)
+			ImGui::Text("%u bones: %.2f million vertices per second", result.boneCount, result.verticesPerSecond / 1000000.0);
+		ImGui::Checkbox("Skin normals", &skinNormals);
+		if (ImGui::Button("Run again"))
+			RunBenchmark();
+		ImGui::End();
+	}
+}
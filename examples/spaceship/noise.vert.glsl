@@ -1,15 +1,9 @@
 layout(location = 0) out vec2 fScreenPos;
 
-layout(binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	mat4 screenSpaceMatrix;
-	vec3 cameraPosition;
-};
+#include <assets/shaders/shared.h>
 
 void main()
 {
-	gl_Position = cameraMatrix * modelMatrix * vec4(VA_Position, 1.0);
+	gl_Position = cameraMatrix * MODEL_MATRIX * vec4(VA_Position, 1.0);
 	fScreenPos = gl_Position.xy;
 }
\ No newline at end of file
@@ -4,16 +4,7 @@
 layout(location = 0) out vec2 particleUV;
 layout(location = 1) out float particleOpacity;
 
-layout(binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
-};
+#include <assets/shaders/shared.h>
 
 uniform float PARTICLE_CYCLE_TIME;
 uniform float PARTICLE_LIFETIME;
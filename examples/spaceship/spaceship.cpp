@@ -10,6 +10,7 @@
 #include <Renderer/Renderer.h>
 
 #include <MeshData.h>
+#include <MeshFile.h>
 #include <Components/Mesh.h>
 #include <Components/Camera.h>
 #include <Components/Transform.h>
@@ -48,6 +49,7 @@ namespace sf
 		Entity* things;
 
 		MeshData* generatedMeshes;
+		MeshFile* cachedMeshFiles;
 		BufferLayout generatedMeshesVertexLayout = BufferLayout({
 			BufferComponent::Position,
 			BufferComponent::Normal,
@@ -154,6 +156,7 @@ namespace sf
 
 		
 		generatedMeshes = new MeshData[UNIQUE_COUNT];
+		cachedMeshFiles = new MeshFile[UNIQUE_COUNT];
 		FileUtils::CreateFolder("assets/examples");
 		FileUtils::CreateFolder("assets/examples/spaceship");
 		char cachedMeshesPath[] = "assets/examples/spaceship/generatedXX.mesh\0";
@@ -165,8 +168,9 @@ namespace sf
 			cachedMeshesPath[numberIndex + 1] = '0' + (i % 10);
 			/* Assign layout to avoid creating a new one per model when loading */
 			generatedMeshes[i].vertexBufferLayout = &generatedMeshesVertexLayout;
-			if (generatedMeshes[i].LoadFromFile(cachedMeshesPath))
+			if (cachedMeshFiles[i].Open(cachedMeshesPath) && cachedMeshFiles[i].MapMeshData(generatedMeshes[i]))
 				continue;
+			cachedMeshFiles[i].Close();
 			errt::seed = i;
 			errt::GenerateModel(generatedMeshes[i]);
 			generatedMeshes[i].ChangeVertexBufferLayout(&generatedMeshesVertexLayout);
@@ -200,6 +204,7 @@ namespace sf
 
 		delete[] things;
 		delete[] generatedMeshes;
+		delete[] cachedMeshFiles;
 	}
 
 	void Game::OnUpdate(float deltaTime, float time)
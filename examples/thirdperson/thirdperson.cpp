@@ -51,6 +51,13 @@ namespace sf
 			BufferComponent::BoneIndices,
 			BufferComponent::BoneWeights
 		});
+		// what the characters are uploaded with, 20 bytes per vertex instead of 56
+		BufferLayout compactCharacterVertexLayout = BufferLayout({
+			{ BufferComponent::Position, DataType::vec3f32 },
+			{ BufferComponent::Normal, DataType::vec2i16 },
+			{ BufferComponent::BoneIndices, DataType::vec4u8 },
+			{ BufferComponent::BoneWeights, DataType::vec4u8 }
+		});
 		SkeletonData* shanyungSkeleton;
 		MeshData* shanyungMesh;
 		uint32_t shanyungBlendSpace;
@@ -145,6 +152,11 @@ namespace sf
 			GltfImporter::GenerateSkeleton(gltfid, *shanyungSkeleton);
 			GltfImporter::GenerateMeshData(gltfid, *shanyungMesh);
 			MeshProcessor::RemoveUnusedBones(*shanyungMesh, *shanyungSkeleton);
+			MeshProcessor::OptimizeVertexCache(*shanyungMesh);
+			MeshProcessor::OptimizeOverdraw(*shanyungMesh);
+			MeshProcessor::OptimizeVertexFetch(*shanyungMesh);
+			shanyungMesh->ChangeVertexBufferLayout(&compactCharacterVertexLayout);
+			MeshProcessor::GenerateLods(*shanyungMesh);
 			shanyung.AddComponent<SkinnedMesh>(shanyungMesh, &characterMaterial, shanyungSkeleton);
 
 			shanyungWeights.resize(10);
@@ -167,7 +179,12 @@ namespace sf
 			GltfImporter::GenerateSkeleton(gltfid, *foxSkeleton);
 			GltfImporter::GenerateMeshData(gltfid, *foxMesh);
 			MeshProcessor::RemoveUnusedBones(*foxMesh, *foxSkeleton);
+			MeshProcessor::OptimizeVertexCache(*foxMesh);
+			MeshProcessor::OptimizeOverdraw(*foxMesh);
+			MeshProcessor::OptimizeVertexFetch(*foxMesh);
 			MeshProcessor::ComputeNormals(*foxMesh);
+			foxMesh->ChangeVertexBufferLayout(&compactCharacterVertexLayout);
+			MeshProcessor::GenerateLods(*foxMesh);
 			fox.AddComponent<SkinnedMesh>(foxMesh, &characterMaterial, foxSkeleton);
 
 			foxWeights.resize(4);
@@ -192,8 +209,10 @@ namespace sf
 		scene.DestroyEntity(fox);
 		terrain.Destroy(scene);
 
+		MeshProcessor::FreeLods(*shanyungMesh);
 		delete shanyungMesh;
 		delete shanyungSkeleton;
+		MeshProcessor::FreeLods(*foxMesh);
 		delete foxMesh;
 		delete foxSkeleton;
 	}
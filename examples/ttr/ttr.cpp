@@ -126,8 +126,8 @@ namespace sf
 			whiteMaterial.fragShaderFilePath = "assets/shaders/solidColor.frag";
 			blackMaterial.vertShaderFilePath = "assets/shaders/default.vert";
 			blackMaterial.fragShaderFilePath = "assets/shaders/solidColor.frag";
-			whiteMaterial.uniforms["color"] = { DataType::vec3f32, &color };
-			blackMaterial.uniforms["color"] = { DataType::vec3f32, &colorb };
+			whiteMaterial.SetUniform("color", DataType::vec3f32, &color);
+			blackMaterial.SetUniform("color", DataType::vec3f32, &colorb);
 		}
 
 		errts = new Entity[ERRT_COUNT];
@@ -18,16 +18,7 @@ vec3 interpolateVerts(vec3 posA, vec3 posB, float a, float b)
 	return posA + t * (posB - posA);
 }
 
-layout(binding = 0) uniform SharedGpuData
-{
-	mat4 modelMatrix;
-	mat4 cameraMatrix;
-	float cameraPositionX;
-	float cameraPositionY;
-	float cameraPositionZ;
-	float windowSizeX;
-	float windowSizeY;
-};
+#include <assets/shaders/shared.h>
 
 uint sampleSvo(uvec3 localCoords)
 {
@@ -59,8 +59,8 @@ namespace sf
 			galleryObjects[prevModel].SetEnabled(false);
 			galleryObjects[selectedModel].SetEnabled(true);
 
-			voxelVolumeMaterial.uniforms["bufferSelect"].data.u32 = selectedModel;
-			voxelVolumeMaterial.uniforms["voxelSize"].data.f32 = selectedModel == 0 ? monkevvd.voxelSize : monkevvd2.voxelSize;
+			voxelVolumeMaterial.SetUniform("bufferSelect", (uint32_t)selectedModel);
+			voxelVolumeMaterial.SetUniform("voxelSize", selectedModel == 0 ? monkevvd.voxelSize : monkevvd2.voxelSize);
 		}
 	}
 
@@ -89,10 +89,8 @@ namespace sf
 		voxelVolumeMaterial.buffers.resize(2);
 		voxelVolumeMaterial.buffers[0] = { "VOXELS_SMALL", monkevvd.voxelBuffer.data(), &voxelLayout, (uint32_t) monkevvd.voxelBuffer.size(), DataType::f32 };
 		voxelVolumeMaterial.buffers[1] = { "VOXELS_BIG", monkevvd2.voxelBuffer.data(), &voxelLayout, (uint32_t) monkevvd2.voxelBuffer.size(), DataType::f32 };
-		voxelVolumeMaterial.uniforms["voxelSize"].dataType = DataType::f32;
-		voxelVolumeMaterial.uniforms["voxelSize"].data.f32 = monkevvd.voxelSize;
-		voxelVolumeMaterial.uniforms["bufferSelect"].dataType = DataType::u32;
-		voxelVolumeMaterial.uniforms["bufferSelect"].data.u32 = selectedModel;
+		voxelVolumeMaterial.SetUniform("voxelSize", monkevvd.voxelSize);
+		voxelVolumeMaterial.SetUniform("bufferSelect", (uint32_t)selectedModel);
 
 		/* remove faces on most positive side */
 		marchingCubesThreadsNeeded = monkevvd2.voxelCountPerAxis.x - 2 + (monkevvd2.voxelCountPerAxis.y - 2) * monkevvd2.voxelCountPerAxis.x + (monkevvd2.voxelCountPerAxis.z - 2) * monkevvd2.voxelCountPerAxis.x * monkevvd2.voxelCountPerAxis.y;
@@ -102,16 +100,11 @@ namespace sf
 		marchingCubesMaterial.meshWorkGroupCount = marchingCubesThreadsNeeded / 16 + 1;
 		marchingCubesMaterial.buffers.resize(1);
 		marchingCubesMaterial.buffers[0] = { "SVO_BUFFER", monkesvo.data.data(), nullptr, (uint32_t) (monkesvo.data.size() * sizeof(monkesvo.data[0])), DataType::u32 };
-		marchingCubesMaterial.uniforms["threadsNeeded"].dataType = DataType::u32;
-		marchingCubesMaterial.uniforms["threadsNeeded"].data.u32 = marchingCubesThreadsNeeded;
-		marchingCubesMaterial.uniforms["svoDepth"].dataType = DataType::u32;
-		marchingCubesMaterial.uniforms["svoDepth"].data.u32 = monkesvo.depth;
-		marchingCubesMaterial.uniforms["voxelCountPerAxis"].dataType = DataType::vec3u32;
-		marchingCubesMaterial.uniforms["voxelCountPerAxis"].data.p = &monkevvd2.voxelCountPerAxis;
-		marchingCubesMaterial.uniforms["voxelSize"].dataType = DataType::f32;
-		marchingCubesMaterial.uniforms["voxelSize"].data.f32 = monkevvd2.voxelSize;
-		marchingCubesMaterial.uniforms["offset"].dataType = DataType::vec3f32;
-		marchingCubesMaterial.uniforms["offset"].data.p = &monkevvd.offset;
+		marchingCubesMaterial.SetUniform("threadsNeeded", marchingCubesThreadsNeeded);
+		marchingCubesMaterial.SetUniform("svoDepth", monkesvo.depth);
+		marchingCubesMaterial.SetUniform("voxelCountPerAxis", DataType::vec3u32, &monkevvd2.voxelCountPerAxis);
+		marchingCubesMaterial.SetUniform("voxelSize", monkevvd2.voxelSize);
+		marchingCubesMaterial.SetUniform("offset", DataType::vec3f32, &monkevvd.offset);
 
 		{
 			galleryObjects.push_back(scene.CreateEntity());
@@ -24,6 +24,7 @@ project "sf"
 	language "C++"
 	cppdialect "C++17"
 	staticruntime "on"
+	vectorextensions "AVX"
 
 	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
 	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
@@ -97,9 +98,13 @@ project "sf"
 		{
 			"SF_PLATFORM_LINUX"
 		}
+		links
+		{
+			"EGL" -- headless context
+		}
 
 	filter "configurations:Debug"
-		defines "SF_DEBUG"
+		defines { "SF_DEBUG", "SF_PROFILER" } -- profiling markers are compiled out of release builds
 		runtime "Debug"
 		symbols "on"
 
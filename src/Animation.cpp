@@ -3,6 +3,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <BlendMatrixInterpolation.h>
+#include <Profiler.h>
 
 void sf::Animation::ComputeNodeWeights(sf::Animation::Node& node)
 {
@@ -111,6 +112,7 @@ void sf::Animation::ComputeNodeDuration(sf::Animation::Node& node)
 
 void sf::Animation::ComputeNodePose(sf::Animation::Node& node)
 {
+	SF_PROFILE_SCOPE("Animation::ComputeNodePose");
 	static std::vector<Transform> intermeditateBones;
 	switch (node.single.type)
 	{
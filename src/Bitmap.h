@@ -3,6 +3,7 @@
 #include <string>
 #include <glm/glm.hpp>
 #include <DataTypes.h>
+#include <GpuHandle.h>
 
 namespace sf
 {
@@ -14,6 +15,8 @@ namespace sf
 		uint32_t height = 0;
 		void* buffer = nullptr;
 
+		mutable GpuHandle gpuHandle; // assigned by the renderer
+
 		Bitmap() = default;
 		void CreateSolid(DataType dataType, uint8_t channelCount, uint32_t width, uint32_t height, const void* pixelValue = nullptr);
 		void CreateFromFile(const std::string& filePath, bool flipVertically = true, bool limitRangeTo16bitFloat = false);
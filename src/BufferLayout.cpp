@@ -1,4 +1,5 @@
 #include "BufferLayout.h"
+#include "VertexFormat.h"
 
 #include <assert.h>
 
@@ -10,6 +11,7 @@ sf::DataType sf::BufferLayout::GetComponentDataType(BufferComponent component)
 	case BufferComponent::Normal:
 	case BufferComponent::Tangent:
 	case BufferComponent::Color:
+	case BufferComponent::Velocity:
 		return DataType::vec3f32;
 	case BufferComponent::UV:
 		return DataType::vec2f32;
@@ -39,6 +41,37 @@ sf::BufferLayout::BufferLayout(const std::vector<BufferComponent>& components)
 		this->componentInfos[i].dataType = componentDataType;
 		this->componentInfos[i].byteOffset = this->sizeInBytes;
 		this->sizeInBytes += GetDataTypeSize(componentDataType);
+		assert(GetDataTypeSize(componentDataType) == GetComponentSize(component));
 		i++;
 	}
+}
+
+sf::BufferLayout::BufferLayout(const std::vector<std::pair<BufferComponent, DataType>>& components)
+{
+	this->componentInfos.resize(components.size());
+	this->sizeInBytes = 0;
+	uint32_t i = 0;
+	for (const std::pair<BufferComponent, DataType>& pair : components)
+	{
+		assert(VertexFormat::IsSupported(pair.first, pair.second));
+		this->componentMap[pair.first] = i;
+		this->componentInfos[i].component = pair.first;
+		this->componentInfos[i].dataType = pair.second;
+		this->componentInfos[i].byteOffset = this->sizeInBytes;
+		this->sizeInBytes += GetDataTypeSize(pair.second);
+		i++;
+	}
+}
+
+bool sf::BufferLayout::operator==(const BufferLayout& other) const
+{
+	if (this->componentInfos.size() != other.componentInfos.size())
+		return false;
+	for (uint32_t i = 0; i < this->componentInfos.size(); i++)
+	{
+		if (this->componentInfos[i].component != other.componentInfos[i].component ||
+			this->componentInfos[i].dataType != other.componentInfos[i].dataType)
+			return false;
+	}
+	return true;
 }
\ No newline at end of file
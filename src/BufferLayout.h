@@ -1,10 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <utility>
 #include <string>
+#include <cassert>
 #include <unordered_map>
 
 #include <DataTypes.h>
+#include <VertexView.h>
 
 namespace sf
 {
@@ -20,7 +23,8 @@ namespace sf
 		BoneIndices,
 		Rotation,
 		Scale,
-		SpawnTime
+		SpawnTime,
+		Velocity
 	};
 
 	struct BufferComponentInfo
@@ -39,22 +43,58 @@ namespace sf
 
 	public:
 		BufferLayout(const std::vector<BufferComponent>& components);
+		/* Components stored with other data types than the default ones, see VertexFormat.h for the supported ones */
+		BufferLayout(const std::vector<std::pair<BufferComponent, DataType>>& components);
 		BufferLayout() = default;
 		~BufferLayout() = default;
 
+		/* The default data type of the component */
 		static DataType GetComponentDataType(BufferComponent component);
+		/* Byte size of the component's default data type, usable in constant expressions */
+		static constexpr uint32_t GetComponentSize(BufferComponent component)
+		{
+			switch (component)
+			{
+			case BufferComponent::Position:
+			case BufferComponent::Normal:
+			case BufferComponent::Tangent:
+			case BufferComponent::Color:
+			case BufferComponent::Velocity:
+				return 12;
+			case BufferComponent::UV:
+				return 8;
+			case BufferComponent::BoneWeights:
+			case BufferComponent::BoneIndices:
+			case BufferComponent::Rotation:
+				return 16;
+			default:
+				return 4;
+			}
+		}
 
 		inline uint32_t GetSize() const
 		{
 			return this->sizeInBytes;
 		}
 
+		/* Looks the component up on every call, loops should make a View once instead */
 		template <typename T>
 		inline T* Access(void* buffer, BufferComponent component, uint32_t index) const
 		{
 			return (T*)(((uint8_t*)buffer) + (this->sizeInBytes * index) + this->componentInfos[this->componentMap.at(component)].byteOffset);
 		}
 
+		/* The view is invalid if the layout does not have the component */
+		template <typename T>
+		inline VertexView<T> View(void* buffer, BufferComponent component, uint32_t vertexCount) const
+		{
+			const BufferComponentInfo* info = GetComponentInfo(component);
+			if (info == nullptr)
+				return VertexView<T>();
+			assert(sizeof(T) <= GetDataTypeSize(info->dataType)); // compact components need VertexFormat::Decode
+			return VertexView<T>(((uint8_t*)buffer) + info->byteOffset, this->sizeInBytes, vertexCount);
+		}
+
 		inline const BufferComponentInfo* GetComponentInfo(BufferComponent component) const
 		{
 			if (this->componentMap.find(component) == this->componentMap.end())
@@ -66,5 +106,66 @@ namespace sf
 		{
 			return this->componentInfos;
 		}
+
+		/* Same components with the same data types in the same order */
+		bool operator==(const BufferLayout& other) const;
+		inline bool operator!=(const BufferLayout& other) const { return !(*this == other); }
+	};
+
+	/*
+	 * Layout fixed at compile time, offsets and the vertex size are constant expressions so views made
+	 * from it index with a constant stride. Get returns the equivalent BufferLayout for meshes and the renderer.
+	 */
+	template <BufferComponent... Components>
+	struct StaticBufferLayout
+	{
+		static constexpr uint32_t ComponentCount = sizeof...(Components);
+		static constexpr uint32_t Size = (BufferLayout::GetComponentSize(Components) + ... + 0);
+
+		template <BufferComponent Component>
+		static constexpr bool Contains()
+		{
+			return ((Components == Component) || ...);
+		}
+
+		template <BufferComponent Component>
+		static constexpr uint32_t Offset()
+		{
+			static_assert(Contains<Component>(), "Component is not part of the layout");
+			constexpr BufferComponent components[] = { Components... };
+			uint32_t offset = 0;
+			for (uint32_t i = 0; components[i] != Component; i++)
+				offset += BufferLayout::GetComponentSize(components[i]);
+			return offset;
+		}
+
+		static const BufferLayout& Get()
+		{
+			static const BufferLayout layout({ Components... });
+			assert(layout.GetSize() == Size);
+			return layout;
+		}
+
+		/* True if a runtime layout has the same components in the same order, all with their default data types */
+		static bool Matches(const BufferLayout* layout)
+		{
+			constexpr BufferComponent components[] = { Components... };
+			const std::vector<BufferComponentInfo>& infos = layout->GetComponentInfos();
+			if (infos.size() != ComponentCount)
+				return false;
+			for (uint32_t i = 0; i < ComponentCount; i++)
+			{
+				if (infos[i].component != components[i] || infos[i].dataType != BufferLayout::GetComponentDataType(components[i]))
+					return false;
+			}
+			return true;
+		}
+
+		template <typename T, BufferComponent Component>
+		static inline VertexView<T, Size> View(void* buffer, uint32_t vertexCount)
+		{
+			static_assert(sizeof(T) <= BufferLayout::GetComponentSize(Component), "Type is bigger than the component");
+			return VertexView<T, Size>(((uint8_t*)buffer) + Offset<Component>(), Size, vertexCount);
+		}
 	};
 }
\ No newline at end of file
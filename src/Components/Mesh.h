@@ -10,6 +10,7 @@ namespace sf {
 	{
 		const MeshData* meshData = nullptr;
 		std::vector<const Material*> materials;
+		uint32_t lod = 0; // picked by the renderer every time it is drawn, 0 is meshData itself
 
 		inline Mesh(const MeshData* meshData)
 		{
@@ -15,9 +15,10 @@ namespace sf
 			this->meshData = meshData;
 
 			boundingSphereRadius = 0.0f;
+			VertexView<glm::vec3> positions = meshData->GetVertexView<glm::vec3>(BufferComponent::Position);
 			for (uint32_t j = 0; j < meshData->indexCount; j++)
 			{
-				glm::vec3* vertexPos = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 0]);
+				glm::vec3* vertexPos = &positions[meshData->indexBuffer[j + 0]];
 				float length2 = glm::dot(*vertexPos, *vertexPos);
 				boundingSphereRadius = length2 > boundingSphereRadius ? length2 : boundingSphereRadius;
 			}
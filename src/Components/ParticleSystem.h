@@ -2,6 +2,7 @@
 
 #include <Material.h>
 #include <MeshData.h>
+#include <ParticlePool.h>
 #include <Components/Transform.h>
 #include <glm/glm.hpp>
 
@@ -16,7 +17,17 @@ namespace sf
 		float timeBetweenEmissions = 0.1f;
 		uint32_t particlesPerEmission = 1U;
 		bool emit = true;
+		/*
+		 * Motion is evaluated in the vertex shader with PARTICLE_POSITION from assets/shaders/particle.h,
+		 * a nonzero initial velocity needs a Velocity component in the particle buffer layout
+		 */
+		glm::vec3 initialVelocity = glm::vec3(0.0f); // in emitter space
+		glm::vec3 acceleration = glm::vec3(0.0f); // read by the shader as PARTICLE_ACCELERATION
 
 		Transform(*initialTransform)() = nullptr;
+		/* Preferred over initialTransform, fills one transform per emitted particle in a single call */
+		void(*initialTransforms)(Transform* outTransforms, uint32_t count) = nullptr;
+
+		ParticlePool pool; // runtime state, managed by the renderer
 	};
 }
\ No newline at end of file
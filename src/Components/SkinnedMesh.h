@@ -12,6 +12,7 @@ namespace sf {
 		const MeshData* meshData = nullptr;
 		const SkeletonData* skeletonData = nullptr;
 		std::vector<const Material*> materials;
+		uint32_t lod = 0; // picked by the renderer every time it is drawn, 0 is meshData itself
 
 		inline SkinnedMesh(const MeshData* meshData, const SkeletonData* skeletonData)
 		{
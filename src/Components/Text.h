@@ -6,6 +6,12 @@
 
 namespace sf {
 
+	enum class TextRenderMode
+	{
+		Vector, // exact glyph outlines evaluated per pixel
+		Msdf // textured quads sampling a multi-channel distance field atlas, cheaper for lots of text
+	};
+
 	struct Text
 	{
 		const char* fontPath;
@@ -14,6 +20,7 @@ namespace sf {
 		float size = 1.0f;
 		int alignmentH = ALIGNMENT_LEFT;
 		int alignmentV = ALIGNMENT_TOP;
+		TextRenderMode renderMode = TextRenderMode::Vector;
 		Text() = default;
 		inline Text(const char* fontPath, const char* string, const glm::vec4& color, float size)
 		{
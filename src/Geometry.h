@@ -796,11 +796,12 @@ namespace sf::Geometry
 
 		uint32_t j;
 		const MeshData* meshData = meshCollider.meshData;
+		VertexView<glm::vec3> positions = meshData->GetVertexView<glm::vec3>(BufferComponent::Position);
 		for (j = 0; j < meshData->indexCount; j += 3)
 		{
-			const glm::vec3* a = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 0]);
-			const glm::vec3* b = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 1]);
-			const glm::vec3* c = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 2]);
+			const glm::vec3* a = &positions[meshData->indexBuffer[j + 0]];
+			const glm::vec3* b = &positions[meshData->indexBuffer[j + 1]];
+			const glm::vec3* c = &positions[meshData->indexBuffer[j + 2]];
 			if (IntersectSphereTriangle(sphere, *a, *b, *c))
 				break;
 		}
@@ -816,11 +817,12 @@ namespace sf::Geometry
 
 		uint32_t j;
 		const MeshData* meshData = meshCollider.meshData;
+		VertexView<glm::vec3> positions = meshData->GetVertexView<glm::vec3>(BufferComponent::Position);
 		for (j = 0; j < meshData->indexCount; j += 3)
 		{
-			const glm::vec3* a = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 0]);
-			const glm::vec3* b = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 1]);
-			const glm::vec3* c = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 2]);
+			const glm::vec3* a = &positions[meshData->indexBuffer[j + 0]];
+			const glm::vec3* b = &positions[meshData->indexBuffer[j + 1]];
+			const glm::vec3* c = &positions[meshData->indexBuffer[j + 2]];
 			if (IntersectCapsuleTriangle(capsule, *a, *b, *c))
 				break;
 		}
@@ -836,11 +838,12 @@ namespace sf::Geometry
 
 		uint32_t j;
 		const MeshData* meshData = meshCollider.meshData;
+		VertexView<glm::vec3> positions = meshData->GetVertexView<glm::vec3>(BufferComponent::Position);
 		for (j = 0; j < meshData->indexCount; j += 3)
 		{
-			const glm::vec3* a = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 0]);
-			const glm::vec3* b = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 1]);
-			const glm::vec3* c = meshData->AccessVertexComponent<glm::vec3>(BufferComponent::Position, meshData->indexBuffer[j + 2]);
+			const glm::vec3* a = &positions[meshData->indexBuffer[j + 0]];
+			const glm::vec3* b = &positions[meshData->indexBuffer[j + 1]];
+			const glm::vec3* c = &positions[meshData->indexBuffer[j + 2]];
 			if (IntersectBoxTriangle(box, *a, *b, *c))
 				break;
 		}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sf {
+
+	/* Slot of a resource in one of the renderer pools, cached by the resource the first time it is drawn */
+	struct GpuHandle
+	{
+		uint32_t index = ~0U;
+		uint32_t generation = 0;
+
+		inline bool IsValid() const { return generation != 0; }
+	};
+}
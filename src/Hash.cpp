@@ -12,4 +12,15 @@ unsigned sf::Hash::SimpleStringHash(const char* s)
 		s++;
 	}
 	return h;
+}
+
+uint64_t sf::Hash::Fnv1a64(const void* data, size_t size, uint64_t hash)
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
 }
\ No newline at end of file
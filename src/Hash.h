@@ -6,6 +6,8 @@
 namespace sf::Hash
 {
 	unsigned SimpleStringHash(const char* s);
+	/* Stable across runs and platforms, can be chained by passing the previous result */
+	uint64_t Fnv1a64(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL);
 
 	struct UVec3Hash {
 		inline uint64_t operator()(const glm::uvec3& v) const noexcept {
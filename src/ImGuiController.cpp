@@ -1,6 +1,9 @@
 #include "ImGuiController.h"
 
 #include <string>
+#include <vector>
+#include <cfloat>
+#include <algorithm>
 
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
@@ -10,14 +13,46 @@
 #include <Game.h>
 #include <Input.h>
 #include <Debug.h>
+#include <Profiler.h>
 #include <Renderer/Renderer.h>
+#include <Renderer/RendererStats.h>
 
 namespace sf::ImGuiController
 {
 	bool statsEnabled = false;
 	bool logsEnabled = false;
 	bool debugDrawEnabled = false;
+	bool profilerEnabled = false;
 	Window* window;
+
+	std::vector<const Profiler::Frame*> profilerFrames;
+	std::vector<float> profilerCpuTimes;
+	std::vector<float> profilerGpuTimes;
+	std::vector<Profiler::Event> profilerEvents;
+
+	void BytesText(const char* label, uint64_t bytes)
+	{
+		if (bytes >= 1024 * 1024)
+			ImGui::Text("%s: %.2f MiB", label, (double)bytes / (1024.0 * 1024.0));
+		else
+			ImGui::Text("%s: %.2f KiB", label, (double)bytes / 1024.0);
+	}
+
+	void ProfilerEventList(const char* label, const std::vector<Profiler::Event>& events, bool mainThreadOnly)
+	{
+		profilerEvents.clear();
+		for (const Profiler::Event& event : events)
+		{
+			if (!mainThreadOnly || event.threadIndex == 0)
+				profilerEvents.push_back(event);
+		}
+		std::sort(profilerEvents.begin(), profilerEvents.end(), [](const Profiler::Event& a, const Profiler::Event& b) { return a.start < b.start; });
+		if (ImGui::CollapsingHeader(label, ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			for (const Profiler::Event& event : profilerEvents)
+				ImGui::Text("%*s%s: %.3f ms", (int)(event.depth * 2), "", event.name, event.duration / 1000.0);
+		}
+	}
 }
 
 void sf::ImGuiController::Initialize(Window& window)
@@ -50,6 +85,8 @@ void sf::ImGuiController::Terminate()
 
 bool sf::ImGuiController::HasControl()
 {
+	if (ImGui::GetCurrentContext() == nullptr) // headless runs don't create it
+		return false;
 	return ImGui::GetIO().WantCaptureMouse;
 }
 
@@ -75,6 +112,7 @@ void sf::ImGuiController::Tick(float deltaTime)
 			{
 				ImGui::MenuItem("Stats", NULL, &statsEnabled);
 				ImGui::MenuItem("Logs", NULL, &logsEnabled);
+				ImGui::MenuItem("Profiler", NULL, &profilerEnabled);
 				if (ImGui::MenuItem("Debug Draw", NULL, &debugDrawEnabled))
 					Renderer::SetDebugDrawEnabled(debugDrawEnabled);
 				if (ImGui::MenuItem("Menu bar", "Esc", window->GetToolBarEnabled()))
@@ -101,6 +139,58 @@ void sf::ImGuiController::Tick(float deltaTime)
 		ImGui::Begin("Stats");
 		ImGui::Text("Frame time: %.3f ms", 1000.0f * deltaTime);
 		ImGui::Text("FPS: %.1f", 1.0f / deltaTime);
+		const RendererStats::Frame& rendererStats = Renderer::GetLastFrameStats();
+		ImGui::Text("GL state calls: %u issued, %u filtered", rendererStats.glState.issuedCalls, rendererStats.glState.filteredCalls);
+		ImGui::Text("Draw calls: %u", rendererStats.drawCalls);
+		ImGui::Text("Instances: %llu", (unsigned long long)rendererStats.instances);
+		ImGui::Text("Triangles: %llu", (unsigned long long)rendererStats.primitives);
+		ImGui::Text("Binds: %u programs, %u vaos, %u textures", rendererStats.glState.programBinds, rendererStats.glState.vertexArrayBinds, rendererStats.glState.textureBinds);
+		if (ImGui::CollapsingHeader("Uploaded"))
+		{
+			for (uint32_t i = 0; i < (uint32_t)RendererStats::UploadSite::Count; i++)
+				BytesText(RendererStats::GetUploadSiteName((RendererStats::UploadSite)i), rendererStats.uploadedBytes[i]);
+		}
+		if (ImGui::CollapsingHeader("GPU memory"))
+		{
+			for (uint32_t i = 0; i < (uint32_t)RendererStats::MemoryCategory::Count; i++)
+				BytesText(RendererStats::GetMemoryCategoryName((RendererStats::MemoryCategory)i), rendererStats.memory[i]);
+		}
+		ImGui::End();
+	}
+	if (profilerEnabled)
+	{
+		ImGui::Begin("Profiler");
+		bool paused = Profiler::IsPaused();
+		if (ImGui::Checkbox("Paused", &paused))
+			Profiler::SetPaused(paused);
+		ImGui::SameLine();
+		if (ImGui::Button("Save chrome trace"))
+			Profiler::WriteChromeTrace("profile.json");
+
+		Profiler::GetFrameHistory(profilerFrames);
+		if (!profilerFrames.empty())
+		{
+			profilerCpuTimes.clear();
+			profilerGpuTimes.clear();
+			const Profiler::Frame* lastGpuFrame = nullptr;
+			for (const Profiler::Frame* frame : profilerFrames)
+			{
+				profilerCpuTimes.push_back((float)frame->cpuTime);
+				profilerGpuTimes.push_back(frame->gpuTime < 0.0 ? 0.0f : (float)frame->gpuTime);
+				if (frame->gpuTime >= 0.0)
+					lastGpuFrame = frame;
+			}
+			char overlay[32];
+			snprintf(overlay, sizeof(overlay), "cpu %.3f ms", profilerCpuTimes.back());
+			ImGui::PlotLines("##cpu", profilerCpuTimes.data(), (int)profilerCpuTimes.size(), 0, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+			snprintf(overlay, sizeof(overlay), "gpu %.3f ms", lastGpuFrame != nullptr ? (float)lastGpuFrame->gpuTime : 0.0f);
+			ImGui::PlotLines("##gpu", profilerGpuTimes.data(), (int)profilerGpuTimes.size(), 0, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+
+			// other threads only show in the chrome trace
+			ProfilerEventList("Cpu", profilerFrames.back()->cpuEvents, true);
+			if (lastGpuFrame != nullptr)
+				ProfilerEventList("Gpu", lastGpuFrame->gpuEvents, false);
+		}
 		ImGui::End();
 	}
 	if (logsEnabled)
@@ -159,29 +159,29 @@ void sf::GltfImporter::GenerateMeshData(int id, MeshData& mesh)
 				}
 
 				// Create Vertices
+				VertexView<glm::vec3> positions = mesh.GetVertexView<glm::vec3>(BufferComponent::Position).Subview(vertexStart, primitiveVertexCount);
+				VertexView<glm::vec3> normals = mesh.GetVertexView<glm::vec3>(BufferComponent::Normal).Subview(vertexStart, primitiveVertexCount);
+				VertexView<glm::vec2> uvs = mesh.GetVertexView<glm::vec2>(BufferComponent::UV).Subview(vertexStart, primitiveVertexCount);
+				VertexView<glm::vec4> boneIndices = mesh.GetVertexView<glm::vec4>(BufferComponent::BoneIndices).Subview(vertexStart, primitiveVertexCount);
+				VertexView<glm::vec4> boneWeights = mesh.GetVertexView<glm::vec4>(BufferComponent::BoneWeights).Subview(vertexStart, primitiveVertexCount);
 				for (uint32_t i = 0; i < primitiveVertexCount; i++)
 				{
-					glm::vec3* posPtr = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, vertexStart + i);
-					*posPtr = { positionBuffer[i * 3 + 0], positionBuffer[i * 3 + 1], positionBuffer[i * 3 + 2] };
+					positions[i] = { positionBuffer[i * 3 + 0], positionBuffer[i * 3 + 1], positionBuffer[i * 3 + 2] };
 					if (normalsBuffer && meshHasNormals)
 					{
-						glm::vec3* normalPtr = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Normal, vertexStart + i);
-						*normalPtr = glm::normalize(glm::vec3(normalsBuffer[i * 3 + 0], normalsBuffer[i * 3 + 1], normalsBuffer[i * 3 + 2]));
+						normals[i] = glm::normalize(glm::vec3(normalsBuffer[i * 3 + 0], normalsBuffer[i * 3 + 1], normalsBuffer[i * 3 + 2]));
 					}
 					if (texCoordsBuffer && meshHasUVs)
 					{
-						glm::vec2* uvsPtr = mesh.AccessVertexComponent<glm::vec2>(BufferComponent::UV, vertexStart + i);
-						*uvsPtr = { texCoordsBuffer[i * 2 + 0], 1.0 - texCoordsBuffer[i * 2 + 1] };
+						uvs[i] = { texCoordsBuffer[i * 2 + 0], 1.0 - texCoordsBuffer[i * 2 + 1] };
 					}
 					if (jointsBuffer && meshHasBoneIndices)
 					{
-						DataType boneIndicesDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::BoneIndices)->dataType;
 						assert(nodeToBonePerModel.find(id) != nodeToBonePerModel.end()); // need mapping from gltf node to bone index to set vertex bone indices
 						if (jointComponentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
 						{
 							const uint8_t* buf = static_cast<const uint8_t*>(jointsBuffer);
-							glm::vec4* boneIndicesPtr = mesh.AccessVertexComponent<glm::vec4>(BufferComponent::BoneIndices, vertexStart + i);
-							*boneIndicesPtr = {
+							boneIndices[i] = {
 								(float)nodeToBonePerModel[id][model.skins[0].joints[buf[i * 4 + 0]]],
 								(float)nodeToBonePerModel[id][model.skins[0].joints[buf[i * 4 + 1]]],
 								(float)nodeToBonePerModel[id][model.skins[0].joints[buf[i * 4 + 2]]],
@@ -190,8 +190,7 @@ void sf::GltfImporter::GenerateMeshData(int id, MeshData& mesh)
 						else // unsigned short
 						{
 							const uint16_t* buf = static_cast<const uint16_t*>(jointsBuffer);
-							glm::vec4* boneIndicesPtr = mesh.AccessVertexComponent<glm::vec4>(BufferComponent::BoneIndices, vertexStart + i);
-							*boneIndicesPtr = {
+							boneIndices[i] = {
 								(float)nodeToBonePerModel[id][model.skins[0].joints[buf[i * 4 + 0]]],
 								(float)nodeToBonePerModel[id][model.skins[0].joints[buf[i * 4 + 1]]],
 								(float)nodeToBonePerModel[id][model.skins[0].joints[buf[i * 4 + 2]]],
@@ -200,8 +199,7 @@ void sf::GltfImporter::GenerateMeshData(int id, MeshData& mesh)
 					}
 					if (boneWeightsBuffer && meshHasBoneWeights)
 					{
-						glm::vec4* boneWeightsPtr = mesh.AccessVertexComponent<glm::vec4>(BufferComponent::BoneWeights, vertexStart + i);
-						*boneWeightsPtr = { boneWeightsBuffer[i * 4 + 0], boneWeightsBuffer[i * 4 + 1], boneWeightsBuffer[i * 4 + 2], boneWeightsBuffer[i * 4 + 3] };
+						boneWeights[i] = { boneWeightsBuffer[i * 4 + 0], boneWeightsBuffer[i * 4 + 1], boneWeightsBuffer[i * 4 + 2], boneWeightsBuffer[i * 4 + 3] };
 					}
 				}
 			}
@@ -270,6 +268,7 @@ void sf::GltfImporter::GenerateMeshData(int id, MeshData& mesh)
 	mesh.pieceCount = pieces.size();
 	memcpy(mesh.indexBuffer, indices.data(), indices.size() * sizeof(uint32_t));
 	memcpy(mesh.pieces, pieces.data(), pieces.size() * sizeof(uint32_t));
+	mesh.ComputeBounds();
 	printf("[GltfImporter] Generated mesh data with %u vertices, %u indices, and %u pieces for ID %u\n", mesh.vertexCount, mesh.indexCount, mesh.pieceCount, id);
 }
 
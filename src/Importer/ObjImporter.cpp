@@ -226,28 +226,25 @@ void sf::ObjImporter::GenerateMeshData(int id, MeshData& mesh)
 	}
 
 	mesh.vertexBuffer = malloc(mesh.vertexBufferLayout->GetSize() * finalVertices.size());
+	mesh.vertexCount = finalVertices.size();
+	VertexView<glm::vec3> positions = mesh.GetVertexView<glm::vec3>(BufferComponent::Position);
+	VertexView<glm::vec3> normals = mesh.GetVertexView<glm::vec3>(BufferComponent::Normal);
+	VertexView<glm::vec2> coords = mesh.GetVertexView<glm::vec2>(BufferComponent::UV);
 	for (int i = 0; i < finalVertices.size(); i++)
 	{
-		glm::vec3* posPtr = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, i);
-		*posPtr = meshes[id]->positions[finalVertices[i].posID];
+		positions[i] = meshes[id]->positions[finalVertices[i].posID];
 		if (meshes[id]->normals.size() > 0 && meshHasNormals)
-		{
-			glm::vec3* normalPtr = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Normal, i);
-			*normalPtr = meshes[id]->normals[finalVertices[i].normalID];
-		}
+			normals[i] = meshes[id]->normals[finalVertices[i].normalID];
 		if (meshes[id]->texCoords.size() > 0 && meshHasUVs)
-		{
-			glm::vec2* coordsPtr = mesh.AccessVertexComponent<glm::vec2>(BufferComponent::UV, i);
-			*coordsPtr = meshes[id]->texCoords[finalVertices[i].coordsID];
-		}
+			coords[i] = meshes[id]->texCoords[finalVertices[i].coordsID];
 	}
-	mesh.vertexCount = finalVertices.size();
 	mesh.indexBuffer = new uint32_t[indices.size() + pieces.size()];
 	mesh.indexCount = indices.size();
 	mesh.pieces = mesh.indexBuffer + indices.size();
 	mesh.pieceCount = pieces.size();
 	memcpy(mesh.indexBuffer, indices.data(), indices.size() * sizeof(uint32_t));
 	memcpy(mesh.pieces, pieces.data(), pieces.size() * sizeof(uint32_t));
+	mesh.ComputeBounds();
 }
 
 void sf::ObjImporter::FreeMeshData(MeshData& mesh)
@@ -101,6 +101,7 @@ void sf::Material::CreateFromFile(const std::string& filePath)
 				q = p + 2;
 				while (p < fileContents.length() && fileContents[p] != '\n') p++;
 				std::string rendererUniformValueString = fileContents.substr(q, p - q);
+				uniformRevision++;
 				if (rendererUniformValueString.compare("_IRRADIANCE_MAP_") == 0)
 					rendererUniforms[uniformName] = { uniformDataType, RendererUniformData::IrradianceMap };
 				else if (rendererUniformValueString.compare("_PREFILTER_MAP_") == 0)
@@ -110,15 +111,15 @@ void sf::Material::CreateFromFile(const std::string& filePath)
 			}
 			else
 			{
-				uniforms[uniformName].dataType = uniformDataType;
+				Uniform& uniform = AccessUniform(uniformName, uniformDataType);
 				switch (uniformDataType)
 				{
 				case DataType::b:
-					uniforms[uniformName].data.u32 = fileContents[p + 2] == 't';
+					uniform.data.u32 = fileContents[p + 2] == 't';
 					break;
 				case DataType::f32:
 					for (q = p = p + 2; fileContents[p] != '\n'; p++);
-					uniforms[uniformName].data.f32 = std::stof(fileContents.substr(q, p - q));
+					uniform.data.f32 = std::stof(fileContents.substr(q, p - q));
 					break;
 				case DataType::bitmap:
 					for (q = p = p + 3; fileContents[p] != '\"'; p++);
@@ -133,14 +134,14 @@ void sf::Material::CreateFromFile(const std::string& filePath)
 						newBitmap->CreateSolid(tempBitmap.dataType, 1, tempBitmap.width, tempBitmap.height);
 						allocatedBitmaps.insert(newBitmap);
 						newBitmap->CopyChannel(tempBitmap, channelToUse, 0);
-						uniforms[uniformName].data.p = newBitmap;
+						uniform.data.p = newBitmap;
 					}
 					else
 					{
 						Bitmap* newBitmap = new Bitmap();
 						newBitmap->CreateFromFile(imageFilePath);
 						allocatedBitmaps.insert(newBitmap);
-						uniforms[uniformName].data.p = newBitmap;
+						uniform.data.p = newBitmap;
 					}
 					break;
 				}
@@ -158,6 +159,48 @@ void sf::Material::CreateFromFile(const std::string& filePath)
 	}
 }
 
+sf::Uniform& sf::Material::AccessUniform(const std::string& name, DataType dataType)
+{
+	auto iterator = uniforms.find(name);
+	if (iterator != uniforms.end() && iterator->second.dataType == dataType)
+		return iterator->second;
+	uniformRevision++;
+	Uniform& uniform = uniforms[name];
+	uniform.dataType = dataType;
+	uniform.data.p = nullptr;
+	return uniform;
+}
+
+void sf::Material::SetUniform(const std::string& name, DataType dataType, void* pointer)
+{
+	Uniform& uniform = AccessUniform(name, dataType);
+	// a different bitmap needs its own texture
+	if ((dataType == DataType::bitmap || dataType == DataType::cubemap) && uniform.data.p != pointer)
+		uniformRevision++;
+	uniform.data.p = pointer;
+}
+
+void sf::Material::SetUniform(const std::string& name, float value)
+{
+	AccessUniform(name, DataType::f32).data.f32 = value;
+}
+
+void sf::Material::SetUniform(const std::string& name, int32_t value)
+{
+	AccessUniform(name, DataType::i32).data.i32 = value;
+}
+
+void sf::Material::SetUniform(const std::string& name, uint32_t value)
+{
+	AccessUniform(name, DataType::u32).data.u32 = value;
+}
+
+void sf::Material::RemoveUniform(const std::string& name)
+{
+	if (uniforms.erase(name) > 0)
+		uniformRevision++;
+}
+
 sf::Material::~Material()
 {
 	for (void* p : allocatedBitmaps)
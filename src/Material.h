@@ -6,6 +6,7 @@
 #include <cstdint>
 
 #include <BufferLayout.h>
+#include <GpuHandle.h>
 
 namespace sf
 {
@@ -54,24 +55,42 @@ namespace sf
 		std::string vertShaderFilePath, fragShaderFilePath, tescShaderFilePath, teseShaderFilePath;
 		std::string taskShaderFilePath, meshShaderFilePath;
 
-		std::unordered_map<std::string, Uniform> uniforms;
-		std::unordered_map<std::string, RendererUniform> rendererUniforms;
 		std::vector<MaterialBuffer> buffers;
 		bool isDoubleSided = false;
+		bool isTransparent = false;
 		MaterialDrawMode drawMode = MaterialDrawMode::Fill;
 		MaterialBlendMode blendMode = MaterialBlendMode::Alpha;
 		uint32_t tessPatchVertexCount;
 		std::string tessSpacing;
 		std::string tessWinding;
 		uint32_t meshWorkGroupCount;
+
+		mutable GpuHandle gpuHandle; // assigned by the renderer
 	private:
+		std::unordered_map<std::string, Uniform> uniforms;
+		std::unordered_map<std::string, RendererUniform> rendererUniforms;
+		uint32_t uniformRevision = 0;
 		std::unordered_set<void*> allocatedBitmaps;
+
+		Uniform& AccessUniform(const std::string& name, DataType dataType);
 	public:
 		Material() = default;
 		void CreateFromFile(const std::string& filePath);
+
+		/* Adding, removing or retyping a uniform bumps the revision, changing its value doesn't */
+		void SetUniform(const std::string& name, DataType dataType, void* pointer);
+		void SetUniform(const std::string& name, float value);
+		void SetUniform(const std::string& name, int32_t value);
+		void SetUniform(const std::string& name, uint32_t value);
+		void RemoveUniform(const std::string& name);
+		inline const std::unordered_map<std::string, Uniform>& GetUniforms() const { return uniforms; }
+		inline const std::unordered_map<std::string, RendererUniform>& GetRendererUniforms() const { return rendererUniforms; }
+		/* Bound materials rebuild their binding tables when this changes */
+		inline uint32_t GetUniformRevision() const { return uniformRevision; }
 		inline bool UsesTessellation() const { return tescShaderFilePath.length() > 0; }
 		inline bool UsesMeshShader() const { return meshShaderFilePath.length() > 0; }
 		inline bool UsesTaskShader() const { return taskShaderFilePath.length() > 0; }
+		inline bool IsTransparent() const { return isTransparent || blendMode != MaterialBlendMode::Alpha; }
 		~Material();
 	};
 }
\ No newline at end of file
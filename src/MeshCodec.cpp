@@ -0,0 +1,444 @@
+#include "MeshCodec.h"
+
+#include <cfloat>
+#include <cstring>
+#include <cassert>
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MESH_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <VertexFormat.h>
+#include <Profiler.h>
+
+#define CODEC_BLOCK_VERTEX_COUNT 256
+#define CODEC_GROUP_SIZE 16
+#define CODEC_PARALLEL_THRESHOLD 16384
+
+namespace sf::MeshCodec
+{
+	enum class Quantization : uint32_t
+	{
+		Raw,
+		Bounds16,
+		Octahedral,
+		Integer16
+	};
+
+	struct ComponentHeader
+	{
+		Quantization quantization;
+		uint32_t recordSize; // bytes the component takes in a quantized vertex
+		float min[4];
+		float scale[4]; // a bounds quantized value is min + q * scale
+	};
+
+	// followed by the component headers, blockCount + 1 block offsets and the blocks
+	struct StreamHeader
+	{
+		uint32_t componentCount;
+		uint32_t recordSize;
+		uint32_t blockCount;
+	};
+
+	// bits per delta for each group header code
+	const uint32_t groupBits[4] = { 0, 2, 4, 8 };
+
+	inline uint32_t GetFloatCount(DataType dataType)
+	{
+		switch (dataType)
+		{
+		case DataType::f32: return 1;
+		case DataType::vec2f32: return 2;
+		case DataType::vec3f32: return 3;
+		case DataType::vec4f32: return 4;
+		default: return 0;
+		}
+	}
+
+	inline uint8_t ZigzagByte(uint8_t delta)
+	{
+		return (uint8_t)((delta << 1) ^ (uint8_t)((int8_t)delta >> 7));
+	}
+
+	inline uint8_t UnzigzagByte(uint8_t value)
+	{
+		return (uint8_t)((value >> 1) ^ (uint8_t)(0 - (value & 1)));
+	}
+
+	ComponentHeader ChooseQuantization(const BufferComponentInfo& info, const uint8_t* vertices, uint32_t vertexSize, uint32_t vertexCount)
+	{
+		ComponentHeader header = {};
+		uint32_t floatCount = GetFloatCount(info.dataType);
+		if (floatCount == 0)
+		{
+			header.quantization = Quantization::Raw;
+			header.recordSize = GetDataTypeSize(info.dataType);
+		}
+		else if ((info.component == BufferComponent::Normal || info.component == BufferComponent::Tangent) && floatCount == 3)
+		{
+			header.quantization = Quantization::Octahedral;
+			header.recordSize = 4;
+		}
+		else if (info.component == BufferComponent::BoneIndices)
+		{
+			header.quantization = Quantization::Integer16;
+			header.recordSize = floatCount * 2;
+		}
+		else
+		{
+			header.quantization = Quantization::Bounds16;
+			header.recordSize = floatCount * 2;
+			float max[4];
+			for (uint32_t j = 0; j < floatCount; j++)
+			{
+				header.min[j] = FLT_MAX;
+				max[j] = -FLT_MAX;
+			}
+			for (uint32_t i = 0; i < vertexCount; i++)
+			{
+				const float* values = (const float*)(vertices + (size_t)vertexSize * i + info.byteOffset);
+				for (uint32_t j = 0; j < floatCount; j++)
+				{
+					header.min[j] = glm::min(header.min[j], values[j]);
+					max[j] = glm::max(max[j], values[j]);
+				}
+			}
+			for (uint32_t j = 0; j < floatCount; j++)
+				header.scale[j] = vertexCount > 0 ? (max[j] - header.min[j]) / 65535.0f : 0.0f;
+		}
+		return header;
+	}
+
+	void QuantizeComponent(const ComponentHeader& header, const BufferComponentInfo& info, const uint8_t* source, uint8_t* target)
+	{
+		uint16_t* shorts = (uint16_t*)target;
+		const float* values = (const float*)source;
+		switch (header.quantization)
+		{
+		case Quantization::Raw:
+			memcpy(target, source, header.recordSize);
+			break;
+		case Quantization::Bounds16:
+			for (uint32_t j = 0; j < header.recordSize / 2; j++)
+				shorts[j] = header.scale[j] > 0.0f ? (uint16_t)glm::clamp((values[j] - header.min[j]) / header.scale[j] + 0.5f, 0.0f, 65535.0f) : 0;
+			break;
+		case Quantization::Octahedral:
+			VertexFormat::Encode(info.component, DataType::vec2i16, glm::vec4(values[0], values[1], values[2], 0.0f), target);
+			break;
+		case Quantization::Integer16:
+			for (uint32_t j = 0; j < header.recordSize / 2; j++)
+				shorts[j] = (uint16_t)glm::clamp(values[j] + 0.5f, 0.0f, 65535.0f);
+			break;
+		}
+	}
+
+	void DequantizeComponent(const ComponentHeader& header, const BufferComponentInfo& info, const uint8_t* source, uint8_t* target)
+	{
+		const uint16_t* shorts = (const uint16_t*)source;
+		float* values = (float*)target;
+		switch (header.quantization)
+		{
+		case Quantization::Raw:
+			memcpy(target, source, header.recordSize);
+			break;
+		case Quantization::Bounds16:
+			for (uint32_t j = 0; j < header.recordSize / 2; j++)
+				values[j] = header.min[j] + (float)shorts[j] * header.scale[j];
+			break;
+		case Quantization::Octahedral:
+		{
+			glm::vec4 normal = VertexFormat::Decode(info.component, DataType::vec2i16, source);
+			values[0] = normal.x;
+			values[1] = normal.y;
+			values[2] = normal.z;
+			break;
+		}
+		case Quantization::Integer16:
+			for (uint32_t j = 0; j < header.recordSize / 2; j++)
+				values[j] = (float)shorts[j];
+			break;
+		}
+	}
+
+	void EncodeBlock(const uint8_t* records, uint32_t recordSize, uint32_t vertexCount, std::vector<uint8_t>& out)
+	{
+		uint32_t groupCount = (vertexCount + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+		uint8_t deltas[CODEC_BLOCK_VERTEX_COUNT];
+		for (uint32_t k = 0; k < recordSize; k++)
+		{
+			// vertices past the end repeat the last one so their deltas are zero
+			uint8_t previous = 0;
+			for (uint32_t i = 0; i < groupCount * CODEC_GROUP_SIZE; i++)
+			{
+				uint8_t value = records[(size_t)recordSize * (i < vertexCount ? i : vertexCount - 1) + k];
+				deltas[i] = ZigzagByte((uint8_t)(value - previous));
+				previous = value;
+			}
+
+			size_t headerOffset = out.size();
+			out.resize(out.size() + 4, 0);
+			uint32_t header = 0;
+			for (uint32_t g = 0; g < groupCount; g++)
+			{
+				const uint8_t* group = deltas + g * CODEC_GROUP_SIZE;
+				uint8_t maxDelta = 0;
+				for (uint32_t i = 0; i < CODEC_GROUP_SIZE; i++)
+					maxDelta = group[i] > maxDelta ? group[i] : maxDelta;
+				uint32_t code = maxDelta == 0 ? 0 : maxDelta < 4 ? 1 : maxDelta < 16 ? 2 : 3;
+				header |= code << (g * 2);
+
+				uint32_t bits = groupBits[code];
+				for (uint32_t byte = 0; byte < bits * CODEC_GROUP_SIZE / 8; byte++)
+				{
+					uint8_t packed = 0;
+					for (uint32_t j = 0; j < 8 / bits; j++)
+						packed |= group[byte * (8 / bits) + j] << (j * bits);
+					out.push_back(packed);
+				}
+			}
+			memcpy(out.data() + headerOffset, &header, 4);
+		}
+	}
+
+	// unpacks one group of 16 zigzag deltas, adds them up starting from previous and returns the last value
+	inline uint8_t DecodeGroup(const uint8_t* data, uint32_t bits, uint8_t previous, uint8_t* target)
+	{
+#ifdef MESH_CODEC_SSE2
+		__m128i values;
+		switch (bits)
+		{
+		case 0:
+			values = _mm_setzero_si128();
+			break;
+		case 2:
+		{
+			int32_t packed;
+			memcpy(&packed, data, 4);
+			__m128i x = _mm_cvtsi32_si128(packed);
+			__m128i mask = _mm_set1_epi8(3);
+			__m128i v0 = _mm_and_si128(x, mask);
+			__m128i v1 = _mm_and_si128(_mm_srli_epi16(x, 2), mask);
+			__m128i v2 = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+			__m128i v3 = _mm_and_si128(_mm_srli_epi16(x, 6), mask);
+			values = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v0, v1), _mm_unpacklo_epi8(v2, v3));
+			break;
+		}
+		case 4:
+		{
+			__m128i x = _mm_loadl_epi64((const __m128i*)data);
+			__m128i mask = _mm_set1_epi8(15);
+			values = _mm_unpacklo_epi8(_mm_and_si128(x, mask), _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+			break;
+		}
+		default:
+			values = _mm_loadu_si128((const __m128i*)data);
+			break;
+		}
+		// unzigzag then prefix sum across the 16 lanes
+		__m128i one = _mm_set1_epi8(1);
+		__m128i halved = _mm_and_si128(_mm_srli_epi16(values, 1), _mm_set1_epi8(0x7F));
+		values = _mm_xor_si128(halved, _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(values, one)));
+		values = _mm_add_epi8(values, _mm_slli_si128(values, 1));
+		values = _mm_add_epi8(values, _mm_slli_si128(values, 2));
+		values = _mm_add_epi8(values, _mm_slli_si128(values, 4));
+		values = _mm_add_epi8(values, _mm_slli_si128(values, 8));
+		values = _mm_add_epi8(values, _mm_set1_epi8((char)previous));
+		_mm_storeu_si128((__m128i*)target, values);
+		return target[CODEC_GROUP_SIZE - 1];
+#else
+		for (uint32_t i = 0; i < CODEC_GROUP_SIZE; i++)
+		{
+			uint8_t value = bits == 0 ? 0 : (data[i * bits / 8] >> ((i * bits) % 8)) & ((1 << bits) - 1);
+			previous += UnzigzagByte(value);
+			target[i] = previous;
+		}
+		return previous;
+#endif
+	}
+
+	bool DecodeBlock(const uint8_t* data, const uint8_t* end, uint32_t recordSize, uint32_t vertexCount, uint8_t* records)
+	{
+		uint32_t groupCount = (vertexCount + CODEC_GROUP_SIZE - 1) / CODEC_GROUP_SIZE;
+		alignas(16) uint8_t plane[CODEC_BLOCK_VERTEX_COUNT];
+		for (uint32_t k = 0; k < recordSize; k++)
+		{
+			if (data + 4 > end)
+				return false;
+			uint32_t header;
+			memcpy(&header, data, 4);
+			data += 4;
+			uint8_t previous = 0;
+			for (uint32_t g = 0; g < groupCount; g++)
+			{
+				uint32_t bits = groupBits[(header >> (g * 2)) & 3];
+				if (data + bits * CODEC_GROUP_SIZE / 8 > end)
+					return false;
+				previous = DecodeGroup(data, bits, previous, plane + g * CODEC_GROUP_SIZE);
+				data += bits * CODEC_GROUP_SIZE / 8;
+			}
+			for (uint32_t i = 0; i < vertexCount; i++)
+				records[(size_t)recordSize * i + k] = plane[i];
+		}
+		return data == end;
+	}
+}
+
+void sf::MeshCodec::EncodeVertices(const BufferLayout& layout, const void* vertices, uint32_t vertexCount, std::vector<uint8_t>& out)
+{
+	SF_PROFILE_SCOPE("MeshCodec::EncodeVertices");
+	const std::vector<BufferComponentInfo>& components = layout.GetComponentInfos();
+	uint32_t vertexSize = layout.GetSize();
+
+	StreamHeader streamHeader = { (uint32_t)components.size(), 0, (vertexCount + CODEC_BLOCK_VERTEX_COUNT - 1) / CODEC_BLOCK_VERTEX_COUNT };
+	std::vector<ComponentHeader> componentHeaders;
+	for (const BufferComponentInfo& info : components)
+	{
+		componentHeaders.push_back(ChooseQuantization(info, (const uint8_t*)vertices, vertexSize, vertexCount));
+		streamHeader.recordSize += componentHeaders.back().recordSize;
+	}
+
+	std::vector<uint8_t> records((size_t)streamHeader.recordSize * vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		uint8_t* record = records.data() + (size_t)streamHeader.recordSize * i;
+		for (uint32_t j = 0; j < components.size(); j++)
+		{
+			QuantizeComponent(componentHeaders[j], components[j], (const uint8_t*)vertices + (size_t)vertexSize * i + components[j].byteOffset, record);
+			record += componentHeaders[j].recordSize;
+		}
+	}
+
+	std::vector<uint8_t> blocks;
+	std::vector<uint32_t> blockOffsets;
+	for (uint32_t block = 0; block < streamHeader.blockCount; block++)
+	{
+		uint32_t first = block * CODEC_BLOCK_VERTEX_COUNT;
+		uint32_t count = first + CODEC_BLOCK_VERTEX_COUNT < vertexCount ? CODEC_BLOCK_VERTEX_COUNT : vertexCount - first;
+		blockOffsets.push_back((uint32_t)blocks.size());
+		EncodeBlock(records.data() + (size_t)streamHeader.recordSize * first, streamHeader.recordSize, count, blocks);
+	}
+	blockOffsets.push_back((uint32_t)blocks.size());
+
+	out.clear();
+	out.insert(out.end(), (const uint8_t*)&streamHeader, (const uint8_t*)&streamHeader + sizeof(StreamHeader));
+	out.insert(out.end(), (const uint8_t*)componentHeaders.data(), (const uint8_t*)(componentHeaders.data() + componentHeaders.size()));
+	out.insert(out.end(), (const uint8_t*)blockOffsets.data(), (const uint8_t*)(blockOffsets.data() + blockOffsets.size()));
+	out.insert(out.end(), blocks.begin(), blocks.end());
+}
+
+bool sf::MeshCodec::DecodeVertices(const uint8_t* data, uint64_t size, const BufferLayout& layout, uint32_t vertexCount, void* targetVertices)
+{
+	SF_PROFILE_SCOPE("MeshCodec::DecodeVertices");
+	const std::vector<BufferComponentInfo>& components = layout.GetComponentInfos();
+	uint32_t vertexSize = layout.GetSize();
+
+	StreamHeader streamHeader;
+	if (size < sizeof(StreamHeader))
+		return false;
+	memcpy(&streamHeader, data, sizeof(StreamHeader));
+	uint64_t headersSize = sizeof(StreamHeader) + (uint64_t)streamHeader.componentCount * sizeof(ComponentHeader) + ((uint64_t)streamHeader.blockCount + 1) * sizeof(uint32_t);
+	if (streamHeader.componentCount != components.size() || streamHeader.blockCount != (vertexCount + CODEC_BLOCK_VERTEX_COUNT - 1) / CODEC_BLOCK_VERTEX_COUNT || headersSize > size)
+		return false;
+
+	std::vector<ComponentHeader> componentHeaders(streamHeader.componentCount);
+	memcpy(componentHeaders.data(), data + sizeof(StreamHeader), componentHeaders.size() * sizeof(ComponentHeader));
+	uint32_t recordSize = 0;
+	for (uint32_t j = 0; j < components.size(); j++)
+	{
+		uint32_t floatCount = GetFloatCount(components[j].dataType);
+		uint32_t expectedSize = GetDataTypeSize(components[j].dataType);
+		if (componentHeaders[j].quantization == Quantization::Octahedral)
+			expectedSize = floatCount == 3 ? 4 : 0;
+		else if (componentHeaders[j].quantization != Quantization::Raw)
+			expectedSize = floatCount * 2;
+		if (componentHeaders[j].recordSize != expectedSize || expectedSize == 0)
+			return false;
+		recordSize += expectedSize;
+	}
+	if (recordSize != streamHeader.recordSize)
+		return false;
+	std::vector<uint32_t> blockOffsets(streamHeader.blockCount + 1);
+	memcpy(blockOffsets.data(), data + sizeof(StreamHeader) + componentHeaders.size() * sizeof(ComponentHeader), blockOffsets.size() * sizeof(uint32_t));
+	const uint8_t* blocks = data + headersSize;
+	uint64_t blocksSize = size - headersSize;
+	if (blockOffsets.back() != blocksSize)
+		return false;
+
+	bool valid = true;
+	int blockCount = (int)streamHeader.blockCount;
+	#pragma omp parallel for reduction(&&:valid) if(vertexCount >= CODEC_PARALLEL_THRESHOLD)
+	for (int block = 0; block < blockCount; block++)
+	{
+		uint32_t first = block * CODEC_BLOCK_VERTEX_COUNT;
+		uint32_t count = first + CODEC_BLOCK_VERTEX_COUNT < vertexCount ? CODEC_BLOCK_VERTEX_COUNT : vertexCount - first;
+		if (blockOffsets[block] > blockOffsets[block + 1] || blockOffsets[block + 1] > blocksSize)
+		{
+			valid = false;
+			continue;
+		}
+
+		std::vector<uint8_t> records((size_t)streamHeader.recordSize * count);
+		if (!DecodeBlock(blocks + blockOffsets[block], blocks + blockOffsets[block + 1], streamHeader.recordSize, count, records.data()))
+		{
+			valid = false;
+			continue;
+		}
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const uint8_t* record = records.data() + (size_t)streamHeader.recordSize * i;
+			uint8_t* vertex = (uint8_t*)targetVertices + (size_t)vertexSize * (first + i);
+			for (uint32_t j = 0; j < components.size(); j++)
+			{
+				DequantizeComponent(componentHeaders[j], components[j], record, vertex + components[j].byteOffset);
+				record += componentHeaders[j].recordSize;
+			}
+		}
+	}
+	return valid;
+}
+
+void sf::MeshCodec::EncodeIndices(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCountPerPrimitive, std::vector<uint8_t>& out)
+{
+	assert(vertexCountPerPrimitive > 0);
+	out.clear();
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		uint32_t corner = i % vertexCountPerPrimitive;
+		uint32_t base = corner != 0 ? indices[i - corner] : i >= vertexCountPerPrimitive ? indices[i - vertexCountPerPrimitive] : 0;
+		int32_t delta = (int32_t)(indices[i] - base);
+		uint32_t value = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+		while (value >= 0x80)
+		{
+			out.push_back((uint8_t)(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back((uint8_t)value);
+	}
+}
+
+bool sf::MeshCodec::DecodeIndices(const uint8_t* data, uint64_t size, uint32_t indexCount, uint32_t vertexCountPerPrimitive, uint32_t* targetIndices)
+{
+	SF_PROFILE_SCOPE("MeshCodec::DecodeIndices");
+	assert(vertexCountPerPrimitive > 0);
+	const uint8_t* end = data + size;
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		uint32_t value = 0;
+		for (uint32_t shift = 0;; shift += 7)
+		{
+			if (data == end || shift > 28)
+				return false;
+			uint8_t byte = *(data++);
+			value |= (uint32_t)(byte & 0x7F) << shift;
+			if (byte < 0x80)
+				break;
+		}
+		uint32_t corner = i % vertexCountPerPrimitive;
+		uint32_t base = corner != 0 ? targetIndices[i - corner] : i >= vertexCountPerPrimitive ? targetIndices[i - vertexCountPerPrimitive] : 0;
+		targetIndices[i] = base + ((value >> 1) ^ (0 - (value & 1)));
+	}
+	return data == end;
+}
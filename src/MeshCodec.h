@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <BufferLayout.h>
+
+/*
+ * Compression for stored vertex and index buffers, lossy for float components.
+ * Vertices are quantized first: positions and other float components to 16 bits inside their bounds, vec3 normals and
+ * tangents to octahedral snorm16 and float bone indices to exact 16 bit integers, compact components stay as they are.
+ * The quantized bytes of each block of vertices are then delta coded against the previous vertex one byte plane at a
+ * time and packed in groups of 16 with 0, 2, 4 or 8 bits per delta. Blocks decode independently across threads and
+ * the groups are unpacked with sse2 when available.
+ * Indices are zigzag deltas against the first index of their primitive, or of the previous one for the first index,
+ * written as variable length integers.
+ */
+namespace sf::MeshCodec
+{
+	void EncodeVertices(const BufferLayout& layout, const void* vertices, uint32_t vertexCount, std::vector<uint8_t>& out);
+	/* Writes vertexCount vertices with the layout they were encoded with, false if the data is corrupt */
+	bool DecodeVertices(const uint8_t* data, uint64_t size, const BufferLayout& layout, uint32_t vertexCount, void* targetVertices);
+
+	void EncodeIndices(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCountPerPrimitive, std::vector<uint8_t>& out);
+	bool DecodeIndices(const uint8_t* data, uint64_t size, uint32_t indexCount, uint32_t vertexCountPerPrimitive, uint32_t* targetIndices);
+}
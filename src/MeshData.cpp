@@ -1,7 +1,9 @@
 #include <MeshData.h>
+#include <VertexFormat.h>
+#include <MeshFile.h>
 #include <cstring>
 #include <cassert>
-#include <fstream>
+#include <cfloat>
 
 void sf::MeshData::ChangeVertexBufferLayout(const sf::BufferLayout* newLayout)
 {
@@ -13,88 +15,166 @@ void sf::MeshData::ChangeVertexBufferLayout(const sf::BufferLayout* newLayout)
 
 	const std::vector<BufferComponentInfo>& oldComponents = this->vertexBufferLayout->GetComponentInfos();
 	void* newVertexBuffer = malloc(newLayout->GetSize() * this->vertexCount);
-	for (int i = 0; i < this->vertexCount; i++)
+	uint32_t oldVertexSize = this->vertexBufferLayout->GetSize();
+	uint32_t newVertexSize = newLayout->GetSize();
+	for (int j = 0; j < oldComponents.size(); j++)
 	{
-		for (int j = 0; j < oldComponents.size(); j++)
-		{
-			const BufferComponentInfo* dataComponentInNewLayout = newLayout->GetComponentInfo(oldComponents[j].component);
-			if (dataComponentInNewLayout == nullptr) // new layout does not have this component
-				continue;
-			if (oldComponents[j].dataType != dataComponentInNewLayout->dataType)
-				continue; // cannot use the data in this component
+		const BufferComponentInfo* dataComponentInNewLayout = newLayout->GetComponentInfo(oldComponents[j].component);
+		if (dataComponentInNewLayout == nullptr) // new layout does not have this component
+			continue;
 
-			uint32_t dataTypeSize = GetDataTypeSize(oldComponents[j].dataType);
-			void* targetPointer = newLayout->Access<void>(newVertexBuffer, oldComponents[j].component, i);
-			void* sourcePointer = this->vertexBufferLayout->Access<void>(this->vertexBuffer, oldComponents[j].component, i);
-			memcpy(targetPointer, sourcePointer, dataTypeSize);
+		uint8_t* targetPointer = (uint8_t*)newVertexBuffer + dataComponentInNewLayout->byteOffset;
+		const uint8_t* sourcePointer = (const uint8_t*)this->vertexBuffer + oldComponents[j].byteOffset;
+		if (oldComponents[j].dataType != dataComponentInNewLayout->dataType)
+		{
+			// different data types go through floats, this is where meshes get packed into compact formats
+			for (uint32_t i = 0; i < this->vertexCount; i++)
+			{
+				glm::vec4 value = VertexFormat::Decode(oldComponents[j].component, oldComponents[j].dataType, sourcePointer + (size_t)oldVertexSize * i);
+				VertexFormat::Encode(oldComponents[j].component, dataComponentInNewLayout->dataType, value, targetPointer + (size_t)newVertexSize * i);
+			}
+			continue;
 		}
+
+		uint32_t dataTypeSize = GetDataTypeSize(oldComponents[j].dataType);
+		for (uint32_t i = 0; i < this->vertexCount; i++)
+			memcpy(targetPointer + (size_t)newVertexSize * i, sourcePointer + (size_t)oldVertexSize * i, dataTypeSize);
 	}
 	free(this->vertexBuffer);
 	this->vertexBufferLayout = newLayout;
 	this->vertexBuffer = newVertexBuffer;
 }
 
-void sf::MeshData::SaveToFile(const char* targetFile)
+void sf::MeshData::ComputeBounds()
 {
-	std::ofstream file;
-	file.open(targetFile, std::ios::trunc | std::ios::binary);
+	boneBoundingSpheres.clear();
+	if (vertexCount == 0)
+	{
+		boundsMin = boundsMax = boundingSphereCenter = glm::vec3(0.0f);
+		boundingSphereRadius = 0.0f;
+		return;
+	}
 
-	// Vertex layout
-	uint32_t componentCount = vertexBufferLayout->GetComponentInfos().size();
-	file.write((char*) &componentCount, sizeof(componentCount));
-	for (BufferComponentInfo comp : vertexBufferLayout->GetComponentInfos())
-		file.write((char*) &comp.component, sizeof(comp.component));
+	VertexView<glm::vec3> positions = GetVertexView<glm::vec3>(BufferComponent::Position);
+	boundsMin = boundsMax = positions[0];
+	for (const glm::vec3& position : positions)
+	{
+		boundsMin = glm::min(boundsMin, position);
+		boundsMax = glm::max(boundsMax, position);
+	}
 
-	// Indices
-	file.write((char*) &indexCount, sizeof(indexCount));
-	file.write((char*) indexBuffer, indexCount * sizeof(uint32_t));
+	// sphere around the box center but only as big as the farthest vertex
+	boundingSphereCenter = (boundsMin + boundsMax) * 0.5f;
+	float radiusSquared = 0.0f;
+	for (const glm::vec3& position : positions)
+	{
+		glm::vec3 toVertex = position - boundingSphereCenter;
+		radiusSquared = glm::max(radiusSquared, glm::dot(toVertex, toVertex));
+	}
+	boundingSphereRadius = glm::sqrt(radiusSquared);
 
-	// Pieces
-	file.write((char*) &pieceCount, sizeof(pieceCount));
-	file.write((char*) pieces, pieceCount * sizeof(uint32_t));
+	const BufferComponentInfo* boneIndicesInfo = vertexBufferLayout->GetComponentInfo(BufferComponent::BoneIndices);
+	const BufferComponentInfo* boneWeightsInfo = vertexBufferLayout->GetComponentInfo(BufferComponent::BoneWeights);
+	if (boneIndicesInfo == nullptr || boneWeightsInfo == nullptr)
+		return;
 
-	// Vertices
-	file.write((char*) &vertexCount, sizeof(vertexCount));
-	uint32_t vertexBufferSizeInBytes = vertexBufferLayout->GetSize() * vertexCount;
-	file.write((char*) vertexBuffer, vertexBufferSizeInBytes);
+	// compact bone data is unpacked to floats first
+	std::vector<glm::vec4> unpackedBoneIndices, unpackedBoneWeights;
+	VertexView<glm::vec4> vertexBoneIndices, vertexBoneWeights;
+	if (boneIndicesInfo->dataType == DataType::vec4f32)
+		vertexBoneIndices = GetVertexView<glm::vec4>(BufferComponent::BoneIndices);
+	else
+	{
+		unpackedBoneIndices.resize(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			unpackedBoneIndices[i] = VertexFormat::Decode(BufferComponent::BoneIndices, boneIndicesInfo->dataType, AccessVertexComponent<void>(BufferComponent::BoneIndices, i));
+		vertexBoneIndices = VertexView<glm::vec4>(unpackedBoneIndices.data(), sizeof(glm::vec4), vertexCount);
+	}
+	if (boneWeightsInfo->dataType == DataType::vec4f32)
+		vertexBoneWeights = GetVertexView<glm::vec4>(BufferComponent::BoneWeights);
+	else
+	{
+		unpackedBoneWeights.resize(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			unpackedBoneWeights[i] = VertexFormat::Decode(BufferComponent::BoneWeights, boneWeightsInfo->dataType, AccessVertexComponent<void>(BufferComponent::BoneWeights, i));
+		vertexBoneWeights = VertexView<glm::vec4>(unpackedBoneWeights.data(), sizeof(glm::vec4), vertexCount);
+	}
 
-	file.close();
+	std::vector<glm::vec3> boneMin, boneMax;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const glm::vec3& position = positions[i];
+		const glm::vec4& boneIndices = vertexBoneIndices[i];
+		const glm::vec4& boneWeights = vertexBoneWeights[i];
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			if (boneWeights[j] <= 0.0f)
+				continue;
+			uint32_t bone = (uint32_t)boneIndices[j];
+			if (bone >= boneBoundingSpheres.size())
+			{
+				boneBoundingSpheres.resize(bone + 1, glm::vec4(0.0f, 0.0f, 0.0f, -1.0f));
+				boneMin.resize(bone + 1, glm::vec3(FLT_MAX));
+				boneMax.resize(bone + 1, glm::vec3(-FLT_MAX));
+			}
+			boneMin[bone] = glm::min(boneMin[bone], position);
+			boneMax[bone] = glm::max(boneMax[bone], position);
+		}
+	}
+	for (uint32_t bone = 0; bone < boneBoundingSpheres.size(); bone++)
+	{
+		if (boneMin[bone].x <= boneMax[bone].x)
+			boneBoundingSpheres[bone] = glm::vec4((boneMin[bone] + boneMax[bone]) * 0.5f, 0.0f);
+	}
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const glm::vec3& position = positions[i];
+		const glm::vec4& boneIndices = vertexBoneIndices[i];
+		const glm::vec4& boneWeights = vertexBoneWeights[i];
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			if (boneWeights[j] <= 0.0f)
+				continue;
+			glm::vec4& sphere = boneBoundingSpheres[(uint32_t)boneIndices[j]];
+			sphere.w = glm::max(sphere.w, glm::length(position - glm::vec3(sphere)));
+		}
+	}
+}
+
+void sf::MeshData::SetBounds(const glm::vec3& min, const glm::vec3& max)
+{
+	boundsMin = min;
+	boundsMax = max;
+	boundingSphereCenter = (min + max) * 0.5f;
+	boundingSphereRadius = glm::length(max - min) * 0.5f;
+}
+
+void sf::MeshData::SaveToFile(const char* targetFile, bool compress)
+{
+	MeshFile::Write(targetFile, *this, compress);
 }
 
 bool sf::MeshData::LoadFromFile(const char* targetFile)
 {
 	assert(pieces == nullptr && vertexBuffer == nullptr && indexBuffer == nullptr);
-	std::ifstream file;
-	file.open(targetFile, std::ios::binary);
-	if (!file)
+	MeshFile file;
+	if (!file.Open(targetFile))
 		return false;
 
-	// Vertex layout
-	uint32_t componentCount;
-	file.read((char*)&componentCount, sizeof(componentCount));
-	std::vector<BufferComponent> components;
-	components.resize(componentCount);
-	file.read((char*) components.data(), componentCount * sizeof(BufferComponent));
-	if (vertexBufferLayout == nullptr)
-		vertexBufferLayout = new BufferLayout(components);
-
-	// Indices
-	file.read((char*) &indexCount, sizeof(indexCount));
-	indexBuffer = new uint32_t[indexCount];
-	file.read((char*) indexBuffer, indexCount * sizeof(uint32_t));
-
-	// Pieces
-	file.read((char*) &pieceCount, sizeof(pieceCount));
-	pieces = new uint32_t[pieceCount];
-	file.read((char*) pieces, pieceCount * sizeof(uint32_t));
-
-	// Vertices
-	file.read((char*) &vertexCount, sizeof(vertexCount));
-	uint32_t vertexBufferSizeInBytes = vertexBufferLayout->GetSize() * vertexCount;
-	vertexBuffer = new char[vertexBufferSizeInBytes];
-	file.read((char*) vertexBuffer, vertexBufferSizeInBytes);
-
-	file.close();
+	const BufferLayout* targetLayout = vertexBufferLayout;
+	if (!file.ReadMeshData(*this))
+	{
+		vertexBufferLayout = targetLayout;
+		return false;
+	}
 
+	if (targetLayout == nullptr)
+		vertexBufferLayout = new BufferLayout(file.GetLayout());
+	else if (*targetLayout != file.GetLayout())
+		ChangeVertexBufferLayout(targetLayout);
+	else
+		vertexBufferLayout = targetLayout;
+	if (!HasBounds())
+		ComputeBounds();
 	return true;
 }
\ No newline at end of file
@@ -2,7 +2,9 @@
 
 #include <vector>
 #include <string>
+#include <glm/glm.hpp>
 #include <BufferLayout.h>
+#include <GpuHandle.h>
 
 namespace sf {
 
@@ -18,6 +20,21 @@ namespace sf {
 		uint32_t pieceCount = 0;
 		uint8_t vertexCountPerPrimitive = 3;
 
+		// mesh space bounds, radius stays negative until computed
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+		glm::vec3 boundingSphereCenter = glm::vec3(0.0f);
+		float boundingSphereRadius = -1.0f;
+		// bind pose sphere around the vertices each bone influences, xyz center and w radius (negative if unused)
+		std::vector<glm::vec4> boneBoundingSpheres;
+
+		// simplified versions from MeshProcessor::GenerateLods, coarsest last, each one owns its buffers
+		std::vector<MeshData*> lods;
+		// how far simplifying moved the surface from the original mesh, in mesh space
+		float simplificationError = 0.0f;
+
+		mutable GpuHandle gpuHandle; // assigned by the renderer
+
 		MeshData() = default;
 		inline MeshData(const BufferLayout* newLayout)
 		{
@@ -26,6 +43,10 @@ namespace sf {
 
 		void ChangeVertexBufferLayout(const BufferLayout* newLayout);
 		bool Initialized() { return vertexBuffer != nullptr; }
+		inline bool HasBounds() const { return boundingSphereRadius >= 0.0f; }
+
+		void ComputeBounds();
+		void SetBounds(const glm::vec3& min, const glm::vec3& max);
 
 		template<typename T>
 		inline T* AccessVertexComponent(BufferComponent component, uint32_t index) const
@@ -33,7 +54,18 @@ namespace sf {
 			return vertexBufferLayout->Access<T>(vertexBuffer, component, index);
 		}
 
-		void SaveToFile(const char* targetFile);
+		/* Invalid if the layout does not have the component */
+		template<typename T>
+		inline VertexView<T> GetVertexView(BufferComponent component) const
+		{
+			return vertexBufferLayout->View<T>(vertexBuffer, component, vertexCount);
+		}
+
+		/*
+		 * See MeshFile, loading copies or decompresses the file into buffers owned by the mesh and converts it to the
+		 * mesh layout if it has one. Compression is lossy for float components, see MeshCodec.
+		 */
+		void SaveToFile(const char* targetFile, bool compress = false);
 		bool LoadFromFile(const char* targetFile);
 	};
 }
\ No newline at end of file
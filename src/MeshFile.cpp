@@ -0,0 +1,311 @@
+#include "MeshFile.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cassert>
+
+#include <MeshCodec.h>
+#include <Profiler.h>
+
+#ifdef SF_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define MESH_FILE_MAGIC "SFMF"
+#define MESH_FILE_ALIGNMENT 16
+
+namespace sf
+{
+	inline uint64_t AlignMeshFileOffset(uint64_t offset)
+	{
+		return (offset + MESH_FILE_ALIGNMENT - 1) & ~(uint64_t)(MESH_FILE_ALIGNMENT - 1);
+	}
+}
+
+const sf::MeshFile::SectionEntry* sf::MeshFile::FindSection(SectionType type) const
+{
+	for (uint32_t i = 0; i < m_header->sectionCount; i++)
+	{
+		if (m_sections[i].type == type)
+			return &m_sections[i];
+	}
+	return nullptr;
+}
+
+bool sf::MeshFile::Open(const char* filePath)
+{
+	assert(!IsOpen());
+
+#ifdef SF_PLATFORM_WINDOWS
+	m_fileHandle = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		m_fileHandle = nullptr;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(m_fileHandle, &fileSize);
+	m_mappingSize = (uint64_t)fileSize.QuadPart;
+	m_mappingHandle = m_mappingSize < sizeof(Header) ? nullptr : CreateFileMappingA(m_fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (m_mappingHandle != nullptr)
+		m_mapping = (uint8_t*)MapViewOfFile(m_mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+	if (m_mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+#else
+	int fileDescriptor = open(filePath, O_RDONLY);
+	if (fileDescriptor < 0)
+		return false;
+	struct stat fileStat;
+	if (fstat(fileDescriptor, &fileStat) != 0 || (uint64_t)fileStat.st_size < sizeof(Header))
+	{
+		close(fileDescriptor);
+		return false;
+	}
+	m_mappingSize = (uint64_t)fileStat.st_size;
+	// private and writable so meshes pointing into it can still be modified, pages are copied on write
+	void* mapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+	close(fileDescriptor); // the mapping keeps the file alive
+	if (mapping == MAP_FAILED)
+		return false;
+	m_mapping = (uint8_t*)mapping;
+#endif
+
+	m_header = (const Header*)m_mapping;
+	if (memcmp(m_header->magic, MESH_FILE_MAGIC, 4) != 0 || m_header->version != Version ||
+		sizeof(Header) + (uint64_t)m_header->sectionCount * sizeof(SectionEntry) > m_mappingSize)
+	{
+		std::cout << "[MeshFile] Not a version " << Version << " mesh file: " << filePath << std::endl;
+		Close();
+		return false;
+	}
+	m_sections = (const SectionEntry*)(m_mapping + sizeof(Header));
+	for (uint32_t i = 0; i < m_header->sectionCount; i++)
+	{
+		// written so corrupt offsets and sizes can't wrap around
+		if (m_sections[i].offset > m_mappingSize || m_sections[i].size > m_mappingSize - m_sections[i].offset)
+		{
+			std::cout << "[MeshFile] Truncated mesh file: " << filePath << std::endl;
+			Close();
+			return false;
+		}
+	}
+
+	uint64_t layoutSize;
+	const LayoutEntry* layoutEntries = (const LayoutEntry*)GetSection(SectionType::Layout, &layoutSize);
+	std::vector<std::pair<BufferComponent, DataType>> components;
+	for (uint32_t i = 0; layoutEntries != nullptr && i < layoutSize / sizeof(LayoutEntry); i++)
+		components.push_back({ layoutEntries[i].component, layoutEntries[i].dataType });
+	m_layout = BufferLayout(components);
+	assert(m_layout.GetSize() == m_header->vertexSize);
+	return true;
+}
+
+void sf::MeshFile::Close()
+{
+#ifdef SF_PLATFORM_WINDOWS
+	if (m_mapping != nullptr)
+		UnmapViewOfFile(m_mapping);
+	if (m_mappingHandle != nullptr)
+		CloseHandle(m_mappingHandle);
+	if (m_fileHandle != nullptr)
+		CloseHandle(m_fileHandle);
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+#else
+	if (m_mapping != nullptr)
+		munmap(m_mapping, m_mappingSize);
+#endif
+	m_mapping = nullptr;
+	m_mappingSize = 0;
+	m_header = nullptr;
+	m_sections = nullptr;
+}
+
+const void* sf::MeshFile::GetSection(SectionType type, uint64_t* outSize) const
+{
+	assert(IsOpen());
+	const SectionEntry* section = FindSection(type);
+	if (outSize != nullptr)
+		*outSize = section == nullptr ? 0 : section->size;
+	return section == nullptr ? nullptr : m_mapping + section->offset;
+}
+
+void sf::MeshFile::Prefetch(SectionType type) const
+{
+	assert(IsOpen());
+	const SectionEntry* section = FindSection(type);
+	if (section == nullptr || section->size == 0)
+		return;
+#ifndef SF_PLATFORM_WINDOWS
+	// madvise wants a page aligned start
+	uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+	uint64_t start = section->offset & ~(pageSize - 1);
+	madvise(m_mapping + start, section->offset + section->size - start, MADV_WILLNEED);
+#endif
+}
+
+void sf::MeshFile::ReadHeader(MeshData& mesh) const
+{
+	mesh.vertexCount = m_header->vertexCount;
+	mesh.indexCount = m_header->indexCount;
+	mesh.pieceCount = m_header->pieceCount;
+	mesh.vertexCountPerPrimitive = (uint8_t)m_header->vertexCountPerPrimitive;
+
+	mesh.boundsMin = m_header->boundsMin;
+	mesh.boundsMax = m_header->boundsMax;
+	mesh.boundingSphereCenter = m_header->boundingSphereCenter;
+	mesh.boundingSphereRadius = m_header->boundingSphereRadius;
+	uint64_t boneBoundsSize;
+	const glm::vec4* boneBounds = (const glm::vec4*)GetSection(SectionType::BoneBounds, &boneBoundsSize);
+	mesh.boneBoundingSpheres.assign(boneBounds, boneBounds + boneBoundsSize / sizeof(glm::vec4));
+}
+
+bool sf::MeshFile::MapMeshData(MeshData& mesh) const
+{
+	assert(IsOpen());
+	if (IsCompressed())
+		return false;
+	if (mesh.vertexBufferLayout == nullptr)
+		mesh.vertexBufferLayout = &m_layout;
+	else if (*mesh.vertexBufferLayout != m_layout)
+		return false;
+
+	ReadHeader(mesh);
+	mesh.vertexBuffer = (void*)GetSection(SectionType::Vertices);
+	mesh.indexBuffer = (uint32_t*)GetSection(SectionType::Indices);
+	mesh.pieces = (uint32_t*)GetSection(SectionType::Pieces);
+	return true;
+}
+
+bool sf::MeshFile::ReadMeshData(MeshData& mesh) const
+{
+	SF_PROFILE_SCOPE("MeshFile::ReadMeshData");
+	assert(IsOpen());
+	assert(mesh.vertexBuffer == nullptr && mesh.indexBuffer == nullptr && mesh.pieces == nullptr);
+
+	ReadHeader(mesh);
+	uint64_t vertexBufferSize = (uint64_t)mesh.vertexCount * m_layout.GetSize();
+	void* vertexBuffer = malloc(vertexBufferSize);
+	uint32_t* indexBuffer = new uint32_t[mesh.indexCount];
+	bool succeeded;
+	if (IsCompressed())
+	{
+		uint64_t compressedVerticesSize, compressedIndicesSize;
+		const uint8_t* compressedVertices = (const uint8_t*)GetSection(SectionType::CompressedVertices, &compressedVerticesSize);
+		const uint8_t* compressedIndices = (const uint8_t*)GetSection(SectionType::CompressedIndices, &compressedIndicesSize);
+		succeeded = compressedIndices != nullptr &&
+			MeshCodec::DecodeVertices(compressedVertices, compressedVerticesSize, m_layout, mesh.vertexCount, vertexBuffer) &&
+			MeshCodec::DecodeIndices(compressedIndices, compressedIndicesSize, mesh.indexCount, mesh.vertexCountPerPrimitive, indexBuffer);
+	}
+	else
+	{
+		uint64_t verticesSize, indicesSize;
+		const void* vertices = GetSection(SectionType::Vertices, &verticesSize);
+		const void* indices = GetSection(SectionType::Indices, &indicesSize);
+		succeeded = verticesSize == vertexBufferSize && indicesSize == (uint64_t)mesh.indexCount * sizeof(uint32_t);
+		if (succeeded)
+		{
+			memcpy(vertexBuffer, vertices, verticesSize);
+			memcpy(indexBuffer, indices, indicesSize);
+		}
+	}
+	uint64_t piecesSize;
+	const uint32_t* pieces = (const uint32_t*)GetSection(SectionType::Pieces, &piecesSize);
+	succeeded = succeeded && piecesSize == (uint64_t)mesh.pieceCount * sizeof(uint32_t);
+	if (!succeeded)
+	{
+		std::cout << "[MeshFile] Corrupt mesh data" << std::endl;
+		free(vertexBuffer);
+		delete[] indexBuffer;
+		return false;
+	}
+
+	mesh.pieces = new uint32_t[mesh.pieceCount];
+	memcpy(mesh.pieces, pieces, piecesSize);
+	mesh.vertexBuffer = vertexBuffer;
+	mesh.indexBuffer = indexBuffer;
+	mesh.vertexBufferLayout = &m_layout;
+	return true;
+}
+
+bool sf::MeshFile::Write(const char* filePath, const MeshData& meshToWrite, bool compress, const std::vector<Section>& extraSections)
+{
+	// bounds go in the file so mapping it never has to touch the vertices, the copy shares the mesh buffers
+	MeshData mesh = meshToWrite;
+	if (!mesh.HasBounds())
+		mesh.ComputeBounds();
+
+	std::vector<LayoutEntry> layoutEntries;
+	for (const BufferComponentInfo& info : mesh.vertexBufferLayout->GetComponentInfos())
+		layoutEntries.push_back({ info.component, info.dataType, info.byteOffset, 0 });
+
+	std::vector<Section> sections = {
+		{ SectionType::Layout, layoutEntries.data(), layoutEntries.size() * sizeof(LayoutEntry) },
+		{ SectionType::Pieces, mesh.pieces, (uint64_t)mesh.pieceCount * sizeof(uint32_t) },
+		{ SectionType::BoneBounds, mesh.boneBoundingSpheres.data(), mesh.boneBoundingSpheres.size() * sizeof(glm::vec4) }
+	};
+	std::vector<uint8_t> compressedVertices, compressedIndices;
+	if (compress)
+	{
+		MeshCodec::EncodeVertices(*mesh.vertexBufferLayout, mesh.vertexBuffer, mesh.vertexCount, compressedVertices);
+		MeshCodec::EncodeIndices(mesh.indexBuffer, mesh.indexCount, mesh.vertexCountPerPrimitive, compressedIndices);
+		sections.push_back({ SectionType::CompressedVertices, compressedVertices.data(), compressedVertices.size() });
+		sections.push_back({ SectionType::CompressedIndices, compressedIndices.data(), compressedIndices.size() });
+	}
+	else
+	{
+		sections.push_back({ SectionType::Vertices, mesh.vertexBuffer, (uint64_t)mesh.vertexCount * mesh.vertexBufferLayout->GetSize() });
+		sections.push_back({ SectionType::Indices, mesh.indexBuffer, (uint64_t)mesh.indexCount * sizeof(uint32_t) });
+	}
+	sections.insert(sections.end(), extraSections.begin(), extraSections.end());
+
+	Header header;
+	memcpy(header.magic, MESH_FILE_MAGIC, 4);
+	header.version = Version;
+	header.sectionCount = (uint32_t)sections.size();
+	header.vertexCount = mesh.vertexCount;
+	header.indexCount = mesh.indexCount;
+	header.pieceCount = mesh.pieceCount;
+	header.vertexSize = mesh.vertexBufferLayout->GetSize();
+	header.vertexCountPerPrimitive = mesh.vertexCountPerPrimitive;
+	header.boundsMin = mesh.boundsMin;
+	header.boundsMax = mesh.boundsMax;
+	header.boundingSphereCenter = mesh.boundingSphereCenter;
+	header.boundingSphereRadius = mesh.boundingSphereRadius;
+
+	std::vector<SectionEntry> entries(sections.size());
+	uint64_t offset = AlignMeshFileOffset(sizeof(Header) + entries.size() * sizeof(SectionEntry));
+	for (uint32_t i = 0; i < sections.size(); i++)
+	{
+		entries[i] = { sections[i].type, 0, offset, sections[i].size };
+		offset = AlignMeshFileOffset(offset + sections[i].size);
+	}
+
+	std::ofstream file(filePath, std::ios::trunc | std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "[MeshFile] Failed to open file: " << filePath << std::endl;
+		return false;
+	}
+	const char padding[MESH_FILE_ALIGNMENT] = {};
+	file.write((const char*)&header, sizeof(Header));
+	file.write((const char*)entries.data(), entries.size() * sizeof(SectionEntry));
+	uint64_t written = sizeof(Header) + entries.size() * sizeof(SectionEntry);
+	for (uint32_t i = 0; i < sections.size(); i++)
+	{
+		file.write(padding, entries[i].offset - written);
+		if (sections[i].size > 0)
+			file.write((const char*)sections[i].data, sections[i].size);
+		written = entries[i].offset + sections[i].size;
+	}
+	return file.good();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include <MeshData.h>
+#include <BufferLayout.h>
+
+namespace sf
+{
+	/*
+	 * Versioned binary mesh container. A fixed header with the counts and bounds is followed by a section table,
+	 * every section starts 16 byte aligned. The file is memory mapped copy on write, so MapMeshData can point a mesh
+	 * straight into the mapping and only the pages that get used are ever read from disk.
+	 */
+	class MeshFile
+	{
+	public:
+		static constexpr uint32_t Version = 1;
+
+		enum class SectionType : uint32_t
+		{
+			Layout,
+			Vertices,
+			Indices,
+			Pieces,
+			BoneBounds,
+			Lods,
+			Meshlets,
+			CompressedVertices,
+			CompressedIndices
+		};
+
+		/* Extra data to store along with a mesh */
+		struct Section
+		{
+			SectionType type;
+			const void* data;
+			uint64_t size;
+		};
+
+	private:
+		struct Header
+		{
+			char magic[4];
+			uint32_t version;
+			uint32_t sectionCount;
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t pieceCount;
+			uint32_t vertexSize;
+			uint32_t vertexCountPerPrimitive;
+			glm::vec3 boundsMin;
+			glm::vec3 boundsMax;
+			glm::vec3 boundingSphereCenter;
+			float boundingSphereRadius;
+		};
+
+		struct SectionEntry
+		{
+			SectionType type;
+			uint32_t reserved;
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		struct LayoutEntry
+		{
+			BufferComponent component;
+			DataType dataType;
+			uint32_t byteOffset;
+			uint32_t reserved;
+		};
+
+		uint8_t* m_mapping = nullptr;
+		uint64_t m_mappingSize = 0;
+#ifdef SF_PLATFORM_WINDOWS
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#endif
+		const Header* m_header = nullptr;
+		const SectionEntry* m_sections = nullptr;
+		BufferLayout m_layout;
+
+		const SectionEntry* FindSection(SectionType type) const;
+		void ReadHeader(MeshData& mesh) const;
+
+	public:
+		MeshFile() = default;
+		MeshFile(const MeshFile&) = delete;
+		MeshFile& operator=(const MeshFile&) = delete;
+		inline ~MeshFile() { Close(); }
+
+		/* Fails on files from other versions, they have to be written again */
+		bool Open(const char* filePath);
+		void Close();
+		inline bool IsOpen() const { return m_mapping != nullptr; }
+
+		inline const BufferLayout& GetLayout() const { return m_layout; }
+		/* Compressed files store their vertices and indices with MeshCodec and can only be read, not mapped */
+		inline bool IsCompressed() const { return FindSection(SectionType::CompressedVertices) != nullptr; }
+		/* Null if the file does not have the section, its pages are only read once the data is used */
+		const void* GetSection(SectionType type, uint64_t* outSize = nullptr) const;
+		/* Hints the os to start reading a section that will be used soon */
+		void Prefetch(SectionType type) const;
+
+		/*
+		 * Points the mesh at the mapped vertices, indices and pieces without copying them, the file has to stay
+		 * open while the mesh is used and the mesh must not free its buffers. Writes to the mesh stay private to
+		 * the process. A mesh without a layout gets the file's one, a different layout than the file's fails,
+		 * MeshData::LoadFromFile converts instead. Fails on compressed files.
+		 */
+		bool MapMeshData(MeshData& mesh) const;
+		/*
+		 * Copies or decompresses the file into new buffers owned by the mesh, vertices keep the file's layout and the
+		 * mesh points at it. Only reads the mapping so several threads can read meshes from the same file.
+		 */
+		bool ReadMeshData(MeshData& mesh) const;
+
+		static bool Write(const char* filePath, const MeshData& mesh, bool compress = false, const std::vector<Section>& extraSections = {});
+	};
+}
@@ -5,101 +5,517 @@
 #include <cstring>
 #include <unordered_set>
 #include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <cfloat>
+#include <cmath>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
 
 #include <Random.h>
 #include <Geometry.h>
+#include <Profiler.h>
+#include <VertexFormat.h>
+
+#define SKINNING_PARALLEL_THRESHOLD 16384
+#define SKINNING_CHUNK_SIZE 4096
+#define OVERDRAW_GRID_SIZE 256
+#define FETCH_CACHE_LINE_SIZE 64
+#define FETCH_CACHE_LINE_COUNT 256
+#define SIMPLIFY_ATTRIBUTE_WEIGHT 0.05f
+#define SIMPLIFY_FLIP_COSINE 0.25f
+#define LOD_MIN_REDUCTION 0.9f
 
 namespace sf {
 
 	template<typename PDT, typename NDT> // position data type and normal data type
 	void ComputeNormalsT(MeshData& mesh, bool normalize = false)
 	{
+		VertexView<PDT> positions = mesh.GetVertexView<PDT>(BufferComponent::Position);
+		VertexView<NDT> normals = mesh.GetVertexView<NDT>(BufferComponent::Normal);
+
 		// set all normals to zero
-		for (uint32_t i = 0; i < mesh.vertexCount; i++)
-		{
-			NDT* targetPointer = mesh.AccessVertexComponent<NDT>(BufferComponent::Normal, i);
-			targetPointer->x = targetPointer->y = targetPointer->z = 0.0;
-		}
+		for (NDT& normal : normals)
+			normal.x = normal.y = normal.z = 0.0;
 
 		// compute normals from face vertex positions
 		for (int i = 0; i < mesh.indexCount; i += 3)
 		{
 			NDT faceNormal;
-			PDT* a = mesh.AccessVertexComponent<PDT>(BufferComponent::Position, mesh.indexBuffer[i + 0]);
-			PDT* b = mesh.AccessVertexComponent<PDT>(BufferComponent::Position, mesh.indexBuffer[i + 1]);
-			PDT* c = mesh.AccessVertexComponent<PDT>(BufferComponent::Position, mesh.indexBuffer[i + 2]);
-			NDT ab = (*b) - (*a);
-			NDT ac = (*c) - (*a);
+			const PDT& a = positions[mesh.indexBuffer[i + 0]];
+			const PDT& b = positions[mesh.indexBuffer[i + 1]];
+			const PDT& c = positions[mesh.indexBuffer[i + 2]];
+			NDT ab = b - a;
+			NDT ac = c - a;
 			faceNormal = glm::normalize(glm::cross(ab, ac));
-			NDT* normalA = mesh.AccessVertexComponent<NDT>(BufferComponent::Normal, mesh.indexBuffer[i + 0]);
-			NDT* normalB = mesh.AccessVertexComponent<NDT>(BufferComponent::Normal, mesh.indexBuffer[i + 1]);
-			NDT* normalC = mesh.AccessVertexComponent<NDT>(BufferComponent::Normal, mesh.indexBuffer[i + 2]);
-			*normalA += faceNormal;
-			*normalB += faceNormal;
-			*normalC += faceNormal;
+			normals[mesh.indexBuffer[i + 0]] += faceNormal;
+			normals[mesh.indexBuffer[i + 1]] += faceNormal;
+			normals[mesh.indexBuffer[i + 2]] += faceNormal;
 		}
 
 		if (normalize)
 		{
-			for (uint32_t i = 0; i < mesh.vertexCount; i++)
-			{
-				NDT* targetPointer = mesh.AccessVertexComponent<NDT>(BufferComponent::Normal, i);
-				*targetPointer = glm::normalize(*targetPointer);
-			}
+			for (NDT& normal : normals)
+				normal = glm::normalize(normal);
 		}
 	}
 
 	template<typename PDT, typename TDT, typename UDT>
 	void ComputeTangentSpaceT(MeshData& mesh)
 	{
+		VertexView<PDT> positions = mesh.GetVertexView<PDT>(BufferComponent::Position);
+		VertexView<UDT> uvs = mesh.GetVertexView<UDT>(BufferComponent::UV);
+		VertexView<TDT> tangents = mesh.GetVertexView<TDT>(BufferComponent::Tangent);
+
 		// set all tangents to zero
-		for (uint32_t i = 0; i < mesh.vertexCount; i++)
-		{
-			TDT* targetPointer;
-			targetPointer = mesh.AccessVertexComponent<TDT>(BufferComponent::Tangent, i);
-			targetPointer->x = targetPointer->y = targetPointer->z = 0.0;
-		}
+		for (TDT& tangent : tangents)
+			tangent.x = tangent.y = tangent.z = 0.0;
 
 		for (int i = 0; i < mesh.indexCount; i += 3)
 		{
-			PDT* ap = mesh.AccessVertexComponent<PDT>(BufferComponent::Position, mesh.indexBuffer[i + 0]);
-			PDT* bp = mesh.AccessVertexComponent<PDT>(BufferComponent::Position, mesh.indexBuffer[i + 1]);
-			PDT* cp = mesh.AccessVertexComponent<PDT>(BufferComponent::Position, mesh.indexBuffer[i + 2]);
-			UDT* au = mesh.AccessVertexComponent<UDT>(BufferComponent::UV, mesh.indexBuffer[i + 0]);
-			UDT* bu = mesh.AccessVertexComponent<UDT>(BufferComponent::UV, mesh.indexBuffer[i + 1]);
-			UDT* cu = mesh.AccessVertexComponent<UDT>(BufferComponent::UV, mesh.indexBuffer[i + 2]);
-			TDT* at = mesh.AccessVertexComponent<TDT>(BufferComponent::Tangent, mesh.indexBuffer[i + 0]);
-			TDT* bt = mesh.AccessVertexComponent<TDT>(BufferComponent::Tangent, mesh.indexBuffer[i + 1]);
-			TDT* ct = mesh.AccessVertexComponent<TDT>(BufferComponent::Tangent, mesh.indexBuffer[i + 2]);
-
-			glm::dvec3 edge1 = *bp - *ap;
-			glm::dvec3 edge2 = *cp - *ap;
-			glm::dvec2 deltaUV1 = *bu - *au;
-			glm::dvec2 deltaUV2 = *cu - *au;
+			uint32_t a = mesh.indexBuffer[i + 0];
+			uint32_t b = mesh.indexBuffer[i + 1];
+			uint32_t c = mesh.indexBuffer[i + 2];
+
+			glm::dvec3 edge1 = positions[b] - positions[a];
+			glm::dvec3 edge2 = positions[c] - positions[a];
+			glm::dvec2 deltaUV1 = uvs[b] - uvs[a];
+			glm::dvec2 deltaUV2 = uvs[c] - uvs[a];
 
 			double f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
 
-			glm::dvec3 t, b;
+			glm::dvec3 t, bitangent;
 
 			t.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
 			t.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
 			t.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
 			t = glm::normalize(t);
 
-			b.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
-			b.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
-			b.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
-			b = glm::normalize(b);
+			bitangent.x = f * (-deltaUV2.x * edge1.x + deltaUV1.x * edge2.x);
+			bitangent.y = f * (-deltaUV2.x * edge1.y + deltaUV1.x * edge2.y);
+			bitangent.z = f * (-deltaUV2.x * edge1.z + deltaUV1.x * edge2.z);
+			bitangent = glm::normalize(bitangent);
+
+			tangents[a] += t;
+			tangents[b] += t;
+			tangents[c] += t;
+		}
+	}
+
+	struct SkinningSource
+	{
+		const uint8_t* vertices;
+		uint32_t vertexSize;
+		uint32_t positionOffset;
+		uint32_t normalOffset;
+		uint32_t boneWeightsOffset;
+		uint32_t boneIndicesOffset;
+		DataType boneWeightsType;
+		DataType boneIndicesType;
+		const glm::mat4* skinningMatrices;
+		uint32_t boneCount;
+	};
+
+	// bone data can be stored with the compact types from VertexFormat.h
+	inline void LoadVertexBones(const SkinningSource& source, const uint8_t* vertex, float* weights, uint32_t* bones)
+	{
+		const uint8_t* weightData = vertex + source.boneWeightsOffset;
+		if (source.boneWeightsType == DataType::vec4f32)
+			memcpy(weights, weightData, 4 * sizeof(float));
+		else
+		{
+			glm::vec4 decodedWeights = VertexFormat::Decode(BufferComponent::BoneWeights, source.boneWeightsType, weightData);
+			memcpy(weights, &decodedWeights, 4 * sizeof(float));
+		}
+
+		const uint8_t* indexData = vertex + source.boneIndicesOffset;
+		switch (source.boneIndicesType)
+		{
+		case DataType::vec4u8:
+			for (int j = 0; j < 4; j++)
+				bones[j] = indexData[j];
+			break;
+		case DataType::vec4u16:
+			for (int j = 0; j < 4; j++)
+				bones[j] = ((const uint16_t*)indexData)[j];
+			break;
+		default:
+			for (int j = 0; j < 4; j++)
+				bones[j] = (uint32_t)((const float*)indexData)[j];
+			break;
+		}
+		assert(bones[0] < source.boneCount && bones[1] < source.boneCount && bones[2] < source.boneCount && bones[3] < source.boneCount);
+	}
+
+	void ComputeSkinnedVerticesScalar(const SkinningSource& source, uint32_t first, uint32_t end, glm::vec3* targetPositions, glm::vec3* targetNormals)
+	{
+		for (uint32_t i = first; i < end; i++)
+		{
+			const uint8_t* vertex = source.vertices + (size_t)source.vertexSize * i;
+			float weights[4];
+			uint32_t bones[4];
+			LoadVertexBones(source, vertex, weights, bones);
+			glm::mat4 skinningMatrix =
+				weights[0] * source.skinningMatrices[bones[0]] +
+				weights[1] * source.skinningMatrices[bones[1]] +
+				weights[2] * source.skinningMatrices[bones[2]] +
+				weights[3] * source.skinningMatrices[bones[3]];
+			targetPositions[i] = glm::vec3(skinningMatrix * glm::vec4(*(const glm::vec3*)(vertex + source.positionOffset), 1.0f));
+			if (targetNormals != nullptr)
+				targetNormals[i] = glm::normalize(glm::vec3(skinningMatrix * glm::vec4(*(const glm::vec3*)(vertex + source.normalOffset), 0.0f)));
+		}
+	}
+
+#ifdef __AVX__
+	inline __m256 MultiplyAdd(__m256 a, __m256 b, __m256 c)
+	{
+#ifdef __FMA__
+		return _mm256_fmadd_ps(a, b, c);
+#else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+	}
+
+	// a mat4 is two registers, columns 0 and 1 then columns 2 and 3, so blending four bones is eight multiply adds
+	// and transforming a vector is two more plus adding the register halves. Going 8 vertices wide instead needs
+	// a gather for every matrix element and measured about twice as slow
+	void ComputeSkinnedVerticesAvx(const SkinningSource& source, uint32_t first, uint32_t end, glm::vec3* targetPositions, glm::vec3* targetNormals)
+	{
+		alignas(16) float result[4];
+		for (uint32_t i = first; i < end; i++)
+		{
+			const uint8_t* vertex = source.vertices + (size_t)source.vertexSize * i;
+			float weights[4];
+			uint32_t bones[4];
+			LoadVertexBones(source, vertex, weights, bones);
+
+			const float* boneMatrix = &source.skinningMatrices[bones[0]][0][0];
+			__m256 weight = _mm256_set1_ps(weights[0]);
+			__m256 columns01 = _mm256_mul_ps(weight, _mm256_loadu_ps(boneMatrix));
+			__m256 columns23 = _mm256_mul_ps(weight, _mm256_loadu_ps(boneMatrix + 8));
+			for (int j = 1; j < 4; j++)
+			{
+				boneMatrix = &source.skinningMatrices[bones[j]][0][0];
+				weight = _mm256_set1_ps(weights[j]);
+				columns01 = MultiplyAdd(weight, _mm256_loadu_ps(boneMatrix), columns01);
+				columns23 = MultiplyAdd(weight, _mm256_loadu_ps(boneMatrix + 8), columns23);
+			}
+
+			const float* position = (const float*)(vertex + source.positionOffset);
+			__m256 xy = _mm256_set_m128(_mm_set1_ps(position[1]), _mm_set1_ps(position[0]));
+			__m256 zw = _mm256_set_m128(_mm_set1_ps(1.0f), _mm_set1_ps(position[2]));
+			__m256 sum = MultiplyAdd(columns01, xy, _mm256_mul_ps(columns23, zw));
+			_mm_store_ps(result, _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+			targetPositions[i] = { result[0], result[1], result[2] };
+
+			if (targetNormals == nullptr)
+				continue;
+			const float* normal = (const float*)(vertex + source.normalOffset);
+			xy = _mm256_set_m128(_mm_set1_ps(normal[1]), _mm_set1_ps(normal[0]));
+			zw = _mm256_set_m128(_mm_setzero_ps(), _mm_set1_ps(normal[2]));
+			sum = MultiplyAdd(columns01, xy, _mm256_mul_ps(columns23, zw));
+			__m128 skinnedNormal = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+			skinnedNormal = _mm_div_ps(skinnedNormal, _mm_sqrt_ps(_mm_dp_ps(skinnedNormal, skinnedNormal, 0x7F)));
+			_mm_store_ps(result, skinnedNormal);
+			targetNormals[i] = { result[0], result[1], result[2] };
+		}
+	}
+#endif
+
+	// a vertex stays in the cache until cacheSize other vertices were loaded after it, like a fifo post transform cache
+	struct FifoVertexCache
+	{
+		std::vector<uint32_t> loadTimes;
+		uint32_t time;
+		uint32_t size;
+
+		inline FifoVertexCache(uint32_t vertexCount, uint32_t cacheSize) : loadTimes(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+		inline uint32_t Age(uint32_t vertex) const { return time - loadTimes[vertex]; }
+		inline bool Contains(uint32_t vertex) const { return Age(vertex) <= size; }
+		inline void Clear() { time += size; }
+		// returns whether the vertex had to be loaded
+		inline bool Access(uint32_t vertex)
+		{
+			if (Contains(vertex))
+				return false;
+			loadTimes[vertex] = time++;
+			return true;
+		}
+	};
+
+	inline void ForEachPiece(const MeshData& mesh, const std::function<void(uint32_t, uint32_t)>& function)
+	{
+		if (mesh.pieceCount == 0)
+		{
+			function(0, mesh.indexCount);
+			return;
+		}
+		for (uint32_t i = 0; i < mesh.pieceCount; i++)
+			function(mesh.pieces[i], i + 1 < mesh.pieceCount ? mesh.pieces[i + 1] : mesh.indexCount);
+	}
+
+	// Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+	void Tipsify(const uint32_t* indices, uint32_t triangleCount, uint32_t vertexCount, uint32_t cacheSize, uint32_t* targetIndices)
+	{
+		std::vector<uint32_t> liveTriangles(vertexCount, 0);
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+			liveTriangles[indices[i]]++;
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i];
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		std::vector<uint32_t> adjacencyEnds(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+			adjacency[adjacencyEnds[indices[i]]++] = i / 3;
+
+		FifoVertexCache cache(vertexCount, cacheSize);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> deadEnds;
+		std::vector<uint32_t> candidates;
+		uint32_t nextTriangle = 0;
+		uint32_t outputCount = 0;
+		uint32_t fanningVertex = triangleCount > 0 ? indices[0] : UINT32_MAX;
+		while (fanningVertex != UINT32_MAX)
+		{
+			candidates.clear();
+			for (uint32_t i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++)
+			{
+				uint32_t triangle = adjacency[i];
+				if (emitted[triangle])
+					continue;
+				emitted[triangle] = true;
+				for (uint32_t j = 0; j < 3; j++)
+				{
+					uint32_t vertex = indices[triangle * 3 + j];
+					targetIndices[outputCount++] = vertex;
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+					cache.Access(vertex);
+				}
+			}
+
+			// fan next around the oldest vertex that stays cached while its remaining triangles are emitted
+			fanningVertex = UINT32_MAX;
+			int64_t bestPriority = -1;
+			for (uint32_t vertex : candidates)
+			{
+				if (liveTriangles[vertex] == 0)
+					continue;
+				int64_t priority = cache.Age(vertex) + 2 * liveTriangles[vertex] <= cacheSize ? cache.Age(vertex) : 0;
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					fanningVertex = vertex;
+				}
+			}
+
+			// dead end, go back to a recently used vertex or else to the next triangle in input order
+			while (fanningVertex == UINT32_MAX && !deadEnds.empty())
+			{
+				if (liveTriangles[deadEnds.back()] > 0)
+					fanningVertex = deadEnds.back();
+				deadEnds.pop_back();
+			}
+			for (; fanningVertex == UINT32_MAX && nextTriangle < triangleCount; nextTriangle++)
+			{
+				if (!emitted[nextTriangle])
+					fanningVertex = indices[nextTriangle * 3];
+			}
+		}
+	}
+
+	void SortClustersByOcclusion(const uint32_t* indices, uint32_t triangleCount, const VertexView<glm::vec3>& positions, float threshold, uint32_t cacheSize, uint32_t* targetIndices)
+	{
+		// hard boundaries are where the cache was flushed, triangles missing all their vertices
+		FifoVertexCache cache(positions.Size(), cacheSize);
+		std::vector<uint32_t> hardClusterStarts;
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			uint32_t misses = cache.Access(indices[i * 3 + 0]) + cache.Access(indices[i * 3 + 1]) + cache.Access(indices[i * 3 + 2]);
+			if (misses == 3)
+				hardClusterStarts.push_back(i);
+		}
+		hardClusterStarts.push_back(triangleCount);
+
+		// hard clusters split again wherever their acmr so far is close enough to the whole cluster's
+		std::vector<uint32_t> clusterStarts;
+		for (uint32_t i = 0; i + 1 < hardClusterStarts.size(); i++)
+		{
+			uint32_t first = hardClusterStarts[i];
+			uint32_t end = hardClusterStarts[i + 1];
+			cache.Clear();
+			uint32_t misses = 0;
+			for (uint32_t j = first * 3; j < end * 3; j++)
+				misses += cache.Access(indices[j]);
+			float maxAcmr = (float)misses / (float)(end - first) * threshold;
+
+			cache.Clear();
+			clusterStarts.push_back(first);
+			misses = 0;
+			for (uint32_t j = first; j + 1 < end; j++)
+			{
+				misses += cache.Access(indices[j * 3 + 0]) + cache.Access(indices[j * 3 + 1]) + cache.Access(indices[j * 3 + 2]);
+				if ((float)misses / (float)(j + 1 - clusterStarts.back()) <= maxAcmr)
+				{
+					clusterStarts.push_back(j + 1);
+					misses = 0;
+					cache.Clear();
+				}
+			}
+		}
+		clusterStarts.push_back(triangleCount);
+
+		// clusters facing away from the center of the piece are likely to occlude the rest so they go first
+		uint32_t clusterCount = (uint32_t)clusterStarts.size() - 1;
+		std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3(0.0f));
+		std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+		glm::vec3 pieceCenter = glm::vec3(0.0f);
+		float pieceArea = 0.0f;
+		for (uint32_t i = 0; i < clusterCount; i++)
+		{
+			float clusterArea = 0.0f;
+			for (uint32_t j = clusterStarts[i]; j < clusterStarts[i + 1]; j++)
+			{
+				const glm::vec3& a = positions[indices[j * 3 + 0]];
+				const glm::vec3& b = positions[indices[j * 3 + 1]];
+				const glm::vec3& c = positions[indices[j * 3 + 2]];
+				glm::vec3 normal = glm::cross(b - a, c - a);
+				float area = glm::length(normal);
+				clusterCenters[i] += (a + b + c) * (area / 3.0f);
+				clusterNormals[i] += normal;
+				clusterArea += area;
+			}
+			pieceCenter += clusterCenters[i];
+			pieceArea += clusterArea;
+			clusterCenters[i] = clusterArea > 0.0f ? clusterCenters[i] / clusterArea : positions[indices[clusterStarts[i] * 3]];
+		}
+		pieceCenter = pieceArea > 0.0f ? pieceCenter / pieceArea : glm::vec3(0.0f);
+
+		std::vector<float> sortKeys(clusterCount);
+		std::vector<uint32_t> clusterOrder(clusterCount);
+		for (uint32_t i = 0; i < clusterCount; i++)
+		{
+			float normalLength = glm::length(clusterNormals[i]);
+			sortKeys[i] = normalLength > 0.0f ? glm::dot(clusterCenters[i] - pieceCenter, clusterNormals[i] / normalLength) : -FLT_MAX;
+			clusterOrder[i] = i;
+		}
+		std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		uint32_t outputCount = 0;
+		for (uint32_t cluster : clusterOrder)
+		{
+			memcpy(targetIndices + outputCount, indices + clusterStarts[cluster] * 3, (clusterStarts[cluster + 1] - clusterStarts[cluster]) * 3 * sizeof(uint32_t));
+			outputCount += (clusterStarts[cluster + 1] - clusterStarts[cluster]) * 3;
+		}
+	}
+
+	// draws the triangles in order with back face culling and a depth test, looking along -axis or +axis
+	void RasterizeOverdraw(const MeshData& mesh, const VertexView<glm::vec3>& positions, uint32_t axis, bool flip, uint64_t& coveredPixels, uint64_t& shadedFragments)
+	{
+		uint32_t axisU = (axis + 1) % 3;
+		uint32_t axisV = (axis + 2) % 3;
+		glm::vec3 extent = glm::max(mesh.boundsMax - mesh.boundsMin, glm::vec3(FLT_MIN));
+		std::vector<glm::vec3> projected(positions.Size());
+		for (uint32_t i = 0; i < positions.Size(); i++)
+		{
+			glm::vec3 normalized = (positions[i] - mesh.boundsMin) / extent;
+			float u = flip ? 1.0f - normalized[axisU] : normalized[axisU];
+			projected[i] = glm::vec3(u * OVERDRAW_GRID_SIZE, normalized[axisV] * OVERDRAW_GRID_SIZE, flip ? normalized[axis] : -normalized[axis]);
+		}
+
+		std::vector<float> depth(OVERDRAW_GRID_SIZE * OVERDRAW_GRID_SIZE, FLT_MAX);
+		for (uint32_t i = 0; i + 2 < mesh.indexCount; i += 3)
+		{
+			const glm::vec3& a = projected[mesh.indexBuffer[i + 0]];
+			const glm::vec3& b = projected[mesh.indexBuffer[i + 1]];
+			const glm::vec3& c = projected[mesh.indexBuffer[i + 2]];
+			float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+			if (area <= 0.0f)
+				continue;
+			int minX = std::max((int)glm::min(a.x, glm::min(b.x, c.x)), 0);
+			int minY = std::max((int)glm::min(a.y, glm::min(b.y, c.y)), 0);
+			int maxX = std::min((int)glm::max(a.x, glm::max(b.x, c.x)), OVERDRAW_GRID_SIZE - 1);
+			int maxY = std::min((int)glm::max(a.y, glm::max(b.y, c.y)), OVERDRAW_GRID_SIZE - 1);
+			for (int y = minY; y <= maxY; y++)
+			{
+				for (int x = minX; x <= maxX; x++)
+				{
+					float px = x + 0.5f;
+					float py = y + 0.5f;
+					float wa = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+					float wb = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+					float wc = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+					if (wa < 0.0f || wb < 0.0f || wc < 0.0f)
+						continue;
+					float z = (wa * a.z + wb * b.z + wc * c.z) / area;
+					float& pixelDepth = depth[y * OVERDRAW_GRID_SIZE + x];
+					coveredPixels += pixelDepth == FLT_MAX;
+					if (z < pixelDepth)
+					{
+						pixelDepth = z;
+						shadedFragments++;
+					}
+				}
+			}
+		}
+	}
+
+	// squared distances to the planes of the triangles around a vertex weighted by their area, Garland and Heckbert,
+	// "Surface Simplification Using Quadric Error Metrics"
+	struct Quadric
+	{
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		inline void AddPlane(double nx, double ny, double nz, double distance, double planeWeight)
+		{
+			a00 += nx * nx * planeWeight; a01 += nx * ny * planeWeight; a02 += nx * nz * planeWeight;
+			a11 += ny * ny * planeWeight; a12 += ny * nz * planeWeight; a22 += nz * nz * planeWeight;
+			b0 += nx * distance * planeWeight; b1 += ny * distance * planeWeight; b2 += nz * distance * planeWeight;
+			c += distance * distance * planeWeight;
+			weight += planeWeight;
+		}
+
+		inline void Add(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02; a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
 
-			*at += t;
-			*bt += t;
-			*ct += t;
+		// mean squared distance from the point to the planes
+		inline double Evaluate(const glm::vec3& point) const
+		{
+			double x = point.x, y = point.y, z = point.z;
+			double result =
+				a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+				2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return weight > 0.0 ? std::max(result, 0.0) / weight : 0.0;
 		}
+	};
+
+	enum class SimplifyVertexKind : uint8_t
+	{
+		Manifold, // can collapse onto any neighbor
+		Seam, // one of two vertices at the same position, both collapse together along the seam
+		Locked
+	};
+
+	inline uint64_t SimplifyEdgeKey(uint32_t a, uint32_t b)
+	{
+		return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
 	}
 }
 
 void sf::MeshProcessor::ComputeNormals(MeshData& mesh, bool normalize)
 {
+	SF_PROFILE_SCOPE("MeshProcessor::ComputeNormals");
 	DataType positionDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::Position)->dataType;
 	DataType normalDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::Normal)->dataType;
 
@@ -124,6 +540,7 @@ void sf::MeshProcessor::ComputeNormals(MeshData& mesh, bool normalize)
 
 void sf::MeshProcessor::ComputeTangentSpace(MeshData& mesh)
 {
+	SF_PROFILE_SCOPE("MeshProcessor::ComputeTangentSpace");
 	DataType positionDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::Position)->dataType;
 	DataType uvsDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::UV)->dataType;
 	DataType tangentDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::Tangent)->dataType;
@@ -189,11 +606,14 @@ float sf::MeshProcessor::ComputeOcclusion(const std::vector<std::pair<bool, floa
 
 void sf::MeshProcessor::ComputeVertexAmbientOcclusion(MeshData& mesh, const VoxelVolumeData* voxelVolume, const VertexAmbientOcclusionBakerConfig* config)
 {
+	SF_PROFILE_SCOPE("MeshProcessor::ComputeVertexAmbientOcclusion");
 	DataType positionDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::Position)->dataType;
 	DataType aoDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::AO)->dataType;
 
 	assert(positionDataType == DataType::vec3f32);
 	assert(aoDataType == DataType::f32);
+	VertexView<glm::vec3> positions = mesh.GetVertexView<glm::vec3>(BufferComponent::Position);
+	VertexView<float> ao = mesh.GetVertexView<float>(BufferComponent::AO);
 
 	VertexAmbientOcclusionBakerConfig autoConfig;
 	if (config == nullptr)
@@ -206,10 +626,10 @@ void sf::MeshProcessor::ComputeVertexAmbientOcclusion(MeshData& mesh, const Voxe
 		else
 		{
 			glm::vec3 minvpos, maxvpos;
-			minvpos = maxvpos = *mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, 0);
+			minvpos = maxvpos = positions[0];
 			for (int i = 1; i < mesh.vertexCount; i++)
 			{
-				glm::vec3 vertexPos = *mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, i);
+				glm::vec3 vertexPos = positions[i];
 				minvpos.x = std::min(vertexPos.x, minvpos.x);
 				minvpos.y = std::min(vertexPos.y, minvpos.y);
 				minvpos.z = std::min(vertexPos.z, minvpos.z);
@@ -228,8 +648,7 @@ void sf::MeshProcessor::ComputeVertexAmbientOcclusion(MeshData& mesh, const Voxe
 	#pragma omp parallel for
 	for (int q = 0; q < mesh.vertexCount; q++)
 	{
-		glm::vec3 vertexPos = *mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, q);
-		float* aoTarget = mesh.AccessVertexComponent<float>(BufferComponent::AO, q);
+		glm::vec3 vertexPos = positions[q];
 
 		std::vector<std::pair<bool, float>> rayResults(config->rayCount);
 		for (int i = 0; i < config->rayCount; i++)
@@ -255,36 +674,37 @@ void sf::MeshProcessor::ComputeVertexAmbientOcclusion(MeshData& mesh, const Voxe
 						continue; // current vertex belongs to this face
 
 					didHit = Geometry::IntersectRayTriangle(vertexPos + (rayDir * config->rayOriginOffset), rayDir,
-						*mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, mesh.indexBuffer[j + 0]),
-						*mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, mesh.indexBuffer[j + 1]),
-						*mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, mesh.indexBuffer[j + 2]),
+						positions[mesh.indexBuffer[j + 0]],
+						positions[mesh.indexBuffer[j + 1]],
+						positions[mesh.indexBuffer[j + 2]],
 						&distance);
 				}
 				if (distance > config->rayDistance)
 					distance = config->rayDistance;
 			}
 		}
-		*aoTarget = ComputeOcclusion(rayResults, config->rayDistance, config->falloff);
+		ao[q] = ComputeOcclusion(rayResults, config->rayDistance, config->falloff);
 	}
 
 	for (int pass = 0; pass < config->denoisePasses; pass++)
 	{
 		for (int i = 0; i < mesh.indexCount; i += 3)
 		{
-			float average =
-				(*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 0]) +
-					*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 1]) +
-					*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 2])) / 3.0f;
+			float& a = ao[mesh.indexBuffer[i + 0]];
+			float& b = ao[mesh.indexBuffer[i + 1]];
+			float& c = ao[mesh.indexBuffer[i + 2]];
+			float average = (a + b + c) / 3.0f;
 
-			*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 0]) = glm::mix(*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 0]), average, config->denoiseWeight);
-			*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 1]) = glm::mix(*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 1]), average, config->denoiseWeight);
-			*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 2]) = glm::mix(*mesh.AccessVertexComponent<float>(BufferComponent::AO, mesh.indexBuffer[i + 2]), average, config->denoiseWeight);
+			a = glm::mix(a, average, config->denoiseWeight);
+			b = glm::mix(b, average, config->denoiseWeight);
+			c = glm::mix(c, average, config->denoiseWeight);
 		}
 	}
 }
 
 void sf::MeshProcessor::GenerateGrid(MeshData& mesh, uint32_t sizeX, uint32_t sizeY, uint32_t texResX, uint32_t texResY, float cellSize, bool useQuads)
 {
+	SF_PROFILE_SCOPE("MeshProcessor::GenerateGrid");
 	assert(sizeX > 1u && sizeY > 1u);
 	float uvAdjustX = 1.0f / texResX / 2.0f;
 	float uvAdjustY = 1.0f / texResY / 2.0f;
@@ -302,13 +722,15 @@ void sf::MeshProcessor::GenerateGrid(MeshData& mesh, uint32_t sizeX, uint32_t si
 	mesh.pieceCount = 1u;
 	mesh.pieces[0] = 0u;
 
+	VertexView<glm::vec3> positions = mesh.GetVertexView<glm::vec3>(BufferComponent::Position);
+	VertexView<glm::vec2> uvs = mesh.GetVertexView<glm::vec2>(BufferComponent::UV);
 	uint32_t currentIndex = 0u;
 	for (int32_t y = 0; y < sizeY; y++)
 	{
 		for (int32_t x = 0; x < sizeX; x++)
 		{
-			glm::vec3* currentVertexPos = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, y * sizeX + x);
-			glm::vec2* currentVertexUV = mesh.AccessVertexComponent<glm::vec2>(BufferComponent::UV, y * sizeX + x);
+			glm::vec3* currentVertexPos = &positions[y * sizeX + x];
+			glm::vec2* currentVertexUV = &uvs[y * sizeX + x];
 			currentVertexPos->x = (float) x * cellSize;
 			currentVertexPos->z = (float) (-y) * cellSize;
 			currentVertexPos->y = 0.0f;
@@ -329,23 +751,26 @@ void sf::MeshProcessor::GenerateGrid(MeshData& mesh, uint32_t sizeX, uint32_t si
 			}
 		}
 	}
+	mesh.ComputeBounds();
 }
 
 void sf::MeshProcessor::RemoveUnusedBones(MeshData& mesh, SkeletonData& skeleton)
 {
-	// Mesh must have bone indices
+	SF_PROFILE_SCOPE("MeshProcessor::RemoveUnusedBones");
+	// Mesh must have float bone indices, they are rewritten in place
 	assert(mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::BoneIndices) != nullptr);
+	assert(mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::BoneIndices)->dataType == DataType::vec4f32);
 
 	// Find used bones, both in mesh and animations
 	std::unordered_set<uint32_t> bonesUsedByMesh;
 	std::unordered_set<uint32_t> bonesUsedByAnimation;
-	for (uint32_t i = 0; i < mesh.vertexCount; i++)
+	VertexView<glm::vec4> boneIndices = mesh.GetVertexView<glm::vec4>(BufferComponent::BoneIndices);
+	for (const glm::vec4& vertexBoneIndices : boneIndices)
 	{
-		glm::vec4* boneIndicesPointer = mesh.AccessVertexComponent<glm::vec4>(BufferComponent::BoneIndices, i);
-		bonesUsedByMesh.insert((uint32_t)boneIndicesPointer->x);
-		bonesUsedByMesh.insert((uint32_t)boneIndicesPointer->y);
-		bonesUsedByMesh.insert((uint32_t)boneIndicesPointer->z);
-		bonesUsedByMesh.insert((uint32_t)boneIndicesPointer->w);
+		bonesUsedByMesh.insert((uint32_t)vertexBoneIndices.x);
+		bonesUsedByMesh.insert((uint32_t)vertexBoneIndices.y);
+		bonesUsedByMesh.insert((uint32_t)vertexBoneIndices.z);
+		bonesUsedByMesh.insert((uint32_t)vertexBoneIndices.w);
 	}
 	for (const Animation::SkeletalAnimation& sa : skeleton.m_animations)
 	{
@@ -469,12 +894,468 @@ void sf::MeshProcessor::RemoveUnusedBones(MeshData& mesh, SkeletonData& skeleton
 	skeleton.m_ikData = newIkData;
 
 	// Update mesh
+	for (glm::vec4& vertexBoneIndices : boneIndices)
+	{
+		vertexBoneIndices.x = (float) boneRemapping[(uint32_t)vertexBoneIndices.x];
+		vertexBoneIndices.y = (float) boneRemapping[(uint32_t)vertexBoneIndices.y];
+		vertexBoneIndices.z = (float) boneRemapping[(uint32_t)vertexBoneIndices.z];
+		vertexBoneIndices.w = (float) boneRemapping[(uint32_t)vertexBoneIndices.w];
+	}
+	mesh.ComputeBounds();
+}
+
+void sf::MeshProcessor::ComputeSkinnedVertices(const MeshData& mesh, const SkeletonData& skeleton, glm::vec3* targetPositions, glm::vec3* targetNormals)
+{
+	SF_PROFILE_SCOPE("MeshProcessor::ComputeSkinnedVertices");
+	const BufferComponentInfo* positionInfo = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::Position);
+	const BufferComponentInfo* normalInfo = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::Normal);
+	const BufferComponentInfo* boneWeightsInfo = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::BoneWeights);
+	const BufferComponentInfo* boneIndicesInfo = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::BoneIndices);
+
+	assert(positionInfo != nullptr && positionInfo->dataType == DataType::vec3f32);
+	assert(boneWeightsInfo != nullptr && boneIndicesInfo != nullptr);
+	assert(boneWeightsInfo->dataType == DataType::vec4f32 || boneWeightsInfo->dataType == DataType::vec4u8 || boneWeightsInfo->dataType == DataType::vec4u16);
+	assert(boneIndicesInfo->dataType == DataType::vec4f32 || boneIndicesInfo->dataType == DataType::vec4u8 || boneIndicesInfo->dataType == DataType::vec4u16);
+	assert(targetNormals == nullptr || (normalInfo != nullptr && normalInfo->dataType == DataType::vec3f32));
+	assert(skeleton.m_skinningMatrices.size() > 0);
+
+	SkinningSource source;
+	source.vertices = (const uint8_t*)mesh.vertexBuffer;
+	source.vertexSize = mesh.vertexBufferLayout->GetSize();
+	source.positionOffset = positionInfo->byteOffset;
+	source.normalOffset = normalInfo != nullptr ? normalInfo->byteOffset : 0;
+	source.boneWeightsOffset = boneWeightsInfo->byteOffset;
+	source.boneIndicesOffset = boneIndicesInfo->byteOffset;
+	source.boneWeightsType = boneWeightsInfo->dataType;
+	source.boneIndicesType = boneIndicesInfo->dataType;
+	source.skinningMatrices = skeleton.m_skinningMatrices.data();
+	source.boneCount = (uint32_t)skeleton.m_skinningMatrices.size();
+
+	int chunkCount = (int)((mesh.vertexCount + SKINNING_CHUNK_SIZE - 1) / SKINNING_CHUNK_SIZE);
+	#pragma omp parallel for if(mesh.vertexCount >= SKINNING_PARALLEL_THRESHOLD)
+	for (int chunk = 0; chunk < chunkCount; chunk++)
+	{
+		uint32_t chunkFirst = chunk * SKINNING_CHUNK_SIZE;
+		uint32_t chunkEnd = chunkFirst + SKINNING_CHUNK_SIZE < mesh.vertexCount ? chunkFirst + SKINNING_CHUNK_SIZE : mesh.vertexCount;
+#ifdef __AVX__
+		ComputeSkinnedVerticesAvx(source, chunkFirst, chunkEnd, targetPositions, targetNormals);
+#else
+		ComputeSkinnedVerticesScalar(source, chunkFirst, chunkEnd, targetPositions, targetNormals);
+#endif
+	}
+}
+
+void sf::MeshProcessor::OptimizeVertexCache(MeshData& mesh, uint32_t cacheSize)
+{
+	SF_PROFILE_SCOPE("MeshProcessor::OptimizeVertexCache");
+	assert(mesh.vertexCountPerPrimitive == 3);
+	std::vector<uint32_t> sourceIndices(mesh.indexBuffer, mesh.indexBuffer + mesh.indexCount);
+	ForEachPiece(mesh, [&](uint32_t first, uint32_t end) {
+		Tipsify(sourceIndices.data() + first, (end - first) / 3, mesh.vertexCount, cacheSize, mesh.indexBuffer + first);
+	});
+}
+
+void sf::MeshProcessor::OptimizeOverdraw(MeshData& mesh, float threshold, uint32_t cacheSize)
+{
+	SF_PROFILE_SCOPE("MeshProcessor::OptimizeOverdraw");
+	assert(mesh.vertexCountPerPrimitive == 3);
+	VertexView<glm::vec3> positions = mesh.GetVertexView<glm::vec3>(BufferComponent::Position);
+	std::vector<uint32_t> sourceIndices(mesh.indexBuffer, mesh.indexBuffer + mesh.indexCount);
+	ForEachPiece(mesh, [&](uint32_t first, uint32_t end) {
+		SortClustersByOcclusion(sourceIndices.data() + first, (end - first) / 3, positions, threshold, cacheSize, mesh.indexBuffer + first);
+	});
+}
+
+void sf::MeshProcessor::OptimizeVertexFetch(MeshData& mesh)
+{
+	SF_PROFILE_SCOPE("MeshProcessor::OptimizeVertexFetch");
+	std::vector<uint32_t> remapping(mesh.vertexCount, UINT32_MAX);
+	uint32_t newVertexCount = 0;
+	for (uint32_t i = 0; i < mesh.indexCount; i++)
+	{
+		uint32_t& newIndex = remapping[mesh.indexBuffer[i]];
+		if (newIndex == UINT32_MAX)
+			newIndex = newVertexCount++;
+		mesh.indexBuffer[i] = newIndex;
+	}
+	for (uint32_t& newIndex : remapping)
+	{
+		if (newIndex == UINT32_MAX)
+			newIndex = newVertexCount++;
+	}
+
+	uint32_t vertexSize = mesh.vertexBufferLayout->GetSize();
+	std::vector<uint8_t> sourceVertices((uint8_t*)mesh.vertexBuffer, (uint8_t*)mesh.vertexBuffer + (size_t)mesh.vertexCount * vertexSize);
 	for (uint32_t i = 0; i < mesh.vertexCount; i++)
+		memcpy((uint8_t*)mesh.vertexBuffer + (size_t)remapping[i] * vertexSize, sourceVertices.data() + (size_t)i * vertexSize, vertexSize);
+}
+
+sf::MeshDrawStatistics sf::MeshProcessor::AnalyzeDrawing(const MeshData& mesh, uint32_t cacheSize)
+{
+	SF_PROFILE_SCOPE("MeshProcessor::AnalyzeDrawing");
+	assert(mesh.vertexCountPerPrimitive == 3);
+	MeshDrawStatistics statistics;
+	if (mesh.indexCount == 0)
+		return statistics;
+
+	FifoVertexCache cache(mesh.vertexCount, cacheSize);
+	std::vector<bool> referenced(mesh.vertexCount, false);
+	uint32_t misses = 0;
+	uint32_t referencedCount = 0;
+	for (uint32_t i = 0; i < mesh.indexCount; i++)
+	{
+		misses += cache.Access(mesh.indexBuffer[i]);
+		referencedCount += !referenced[mesh.indexBuffer[i]];
+		referenced[mesh.indexBuffer[i]] = true;
+	}
+	statistics.acmr = (float)misses / (float)(mesh.indexCount / 3);
+	statistics.atvr = (float)misses / (float)referencedCount;
+
+	MeshData boundedMesh = mesh;
+	if (!boundedMesh.HasBounds())
+		boundedMesh.ComputeBounds();
+	VertexView<glm::vec3> positions = mesh.GetVertexView<glm::vec3>(BufferComponent::Position);
+	uint64_t coveredPixels = 0;
+	uint64_t shadedFragments = 0;
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		RasterizeOverdraw(boundedMesh, positions, axis, false, coveredPixels, shadedFragments);
+		RasterizeOverdraw(boundedMesh, positions, axis, true, coveredPixels, shadedFragments);
+	}
+	statistics.overdraw = coveredPixels > 0 ? (float)shadedFragments / (float)coveredPixels : 0.0f;
+
+	uint64_t vertexSize = mesh.vertexBufferLayout->GetSize();
+	std::vector<uint64_t> cachedLines(FETCH_CACHE_LINE_COUNT, UINT64_MAX);
+	uint64_t fetchedBytes = 0;
+	for (uint32_t i = 0; i < mesh.indexCount; i++)
+	{
+		uint64_t firstLine = mesh.indexBuffer[i] * vertexSize / FETCH_CACHE_LINE_SIZE;
+		uint64_t lastLine = (mesh.indexBuffer[i] * vertexSize + vertexSize - 1) / FETCH_CACHE_LINE_SIZE;
+		for (uint64_t line = firstLine; line <= lastLine; line++)
+		{
+			if (cachedLines[line % FETCH_CACHE_LINE_COUNT] == line)
+				continue;
+			cachedLines[line % FETCH_CACHE_LINE_COUNT] = line;
+			fetchedBytes += FETCH_CACHE_LINE_SIZE;
+		}
+	}
+	statistics.overfetch = (float)fetchedBytes / (float)(mesh.vertexCount * vertexSize);
+	return statistics;
+}
+
+float sf::MeshProcessor::Simplify(const MeshData& mesh, uint32_t targetIndexCount, float maxError, std::vector<uint32_t>& targetIndices, std::vector<uint32_t>& targetPieces)
+{
+	SF_PROFILE_SCOPE("MeshProcessor::Simplify");
+	assert(mesh.vertexCountPerPrimitive == 3);
+	VertexView<glm::vec3> positions = mesh.GetVertexView<glm::vec3>(BufferComponent::Position);
+	uint32_t vertexCount = mesh.vertexCount;
+
+	targetIndices.assign(mesh.indexBuffer, mesh.indexBuffer + mesh.indexCount);
+	std::vector<uint32_t> trianglePieces(mesh.indexCount / 3, 0);
+	uint32_t pieceIndex = 0;
+	ForEachPiece(mesh, [&](uint32_t first, uint32_t end) {
+		std::fill(trianglePieces.begin() + first / 3, trianglePieces.begin() + end / 3, pieceIndex++);
+	});
+
+	// vertices at the same position are wedges of one corner, they split where normals, uvs or colors are discontinuous
+	std::vector<uint32_t> sortedVertices(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+		sortedVertices[i] = i;
+	std::sort(sortedVertices.begin(), sortedVertices.end(), [&](uint32_t a, uint32_t b) {
+		const glm::vec3& pa = positions[a];
+		const glm::vec3& pb = positions[b];
+		return pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z);
+	});
+	std::vector<uint32_t> corners(vertexCount);
+	std::vector<uint32_t> nextWedges(vertexCount);
+	std::vector<uint32_t> wedgeCounts(vertexCount, 0);
+	for (uint32_t first = 0, end = 0; first < vertexCount; first = end)
+	{
+		while (end < vertexCount && positions[sortedVertices[end]] == positions[sortedVertices[first]])
+			end++;
+		for (uint32_t i = first; i < end; i++)
+		{
+			corners[sortedVertices[i]] = sortedVertices[first];
+			nextWedges[sortedVertices[i]] = sortedVertices[i + 1 < end ? i + 1 : first];
+		}
+		wedgeCounts[sortedVertices[first]] = end - first;
+	}
+
+	// corners on piece borders, open borders and non manifold edges keep their place
+	std::vector<bool> lockedCorners(vertexCount, false);
+	std::vector<uint32_t> cornerPieces(vertexCount, UINT32_MAX);
+	std::unordered_map<uint64_t, uint32_t> directedEdges;
+	std::vector<Quadric> quadrics(vertexCount);
+	for (uint32_t i = 0; i < targetIndices.size(); i += 3)
+	{
+		uint32_t triangleCorners[3] = { corners[targetIndices[i + 0]], corners[targetIndices[i + 1]], corners[targetIndices[i + 2]] };
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			uint32_t corner = triangleCorners[j];
+			uint32_t nextCorner = triangleCorners[(j + 1) % 3];
+			if (cornerPieces[corner] == UINT32_MAX)
+				cornerPieces[corner] = trianglePieces[i / 3];
+			else if (cornerPieces[corner] != trianglePieces[i / 3])
+				lockedCorners[corner] = true;
+			if (corner != nextCorner)
+				directedEdges[((uint64_t)corner << 32) | nextCorner]++;
+		}
+
+		const glm::vec3& a = positions[triangleCorners[0]];
+		glm::vec3 normal = glm::cross(positions[triangleCorners[1]] - a, positions[triangleCorners[2]] - a);
+		float doubleArea = glm::length(normal);
+		if (doubleArea == 0.0f)
+			continue;
+		normal /= doubleArea;
+		for (uint32_t j = 0; j < 3; j++)
+			quadrics[triangleCorners[j]].AddPlane(normal.x, normal.y, normal.z, -glm::dot(normal, a), doubleArea * 0.5);
+	}
+	for (const std::pair<const uint64_t, uint32_t>& edge : directedEdges)
+	{
+		uint32_t a = (uint32_t)(edge.first >> 32);
+		uint32_t b = (uint32_t)edge.first;
+		if (edge.second > 1 || directedEdges.find(((uint64_t)b << 32) | a) == directedEdges.end())
+			lockedCorners[a] = lockedCorners[b] = true;
+	}
+	std::vector<SimplifyVertexKind> kinds(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		uint32_t wedgeCount = wedgeCounts[corners[i]];
+		kinds[i] = lockedCorners[corners[i]] || wedgeCount > 2 ? SimplifyVertexKind::Locked :
+			(wedgeCount == 2 ? SimplifyVertexKind::Seam : SimplifyVertexKind::Manifold);
+	}
+
+	// attribute differences cost as much as moving the surface by a fraction of the mesh size
+	std::vector<std::pair<BufferComponent, DataType>> attributeComponents;
+	for (BufferComponent component : { BufferComponent::Normal, BufferComponent::UV, BufferComponent::Color })
+	{
+		const BufferComponentInfo* info = mesh.vertexBufferLayout->GetComponentInfo(component);
+		if (info != nullptr)
+			attributeComponents.push_back({ component, info->dataType });
+	}
+	uint32_t attributeCount = (uint32_t)attributeComponents.size();
+	std::vector<glm::vec4> attributes((size_t)vertexCount * attributeCount);
+	glm::vec3 boundsMin = vertexCount > 0 ? positions[0] : glm::vec3(0.0f);
+	glm::vec3 boundsMax = boundsMin;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		boundsMin = glm::min(boundsMin, positions[i]);
+		boundsMax = glm::max(boundsMax, positions[i]);
+		for (uint32_t j = 0; j < attributeCount; j++)
+		{
+			const BufferComponentInfo* info = mesh.vertexBufferLayout->GetComponentInfo(attributeComponents[j].first);
+			attributes[(size_t)i * attributeCount + j] = VertexFormat::Decode(attributeComponents[j].first, attributeComponents[j].second,
+				(const uint8_t*)mesh.vertexBuffer + (size_t)i * mesh.vertexBufferLayout->GetSize() + info->byteOffset);
+		}
+	}
+	double attributeScale = SIMPLIFY_ATTRIBUTE_WEIGHT * glm::length(boundsMax - boundsMin) * 0.5;
+	double attributeWeight = attributeScale * attributeScale;
+	auto AttributeError = [&](uint32_t from, uint32_t to) {
+		double error = 0.0;
+		for (uint32_t j = 0; j < attributeCount; j++)
+		{
+			glm::vec4 difference = attributes[(size_t)from * attributeCount + j] - attributes[(size_t)to * attributeCount + j];
+			error += glm::dot(difference, difference);
+		}
+		return error * attributeWeight;
+	};
+
+	std::vector<uint64_t> edges;
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<uint32_t> collapseTargets(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+		collapseTargets[i] = i;
+	std::vector<bool> touchedCorners(vertexCount);
+
+	auto CollapseCost = [&](uint32_t from, uint32_t to) {
+		if (kinds[from] == SimplifyVertexKind::Locked)
+			return DBL_MAX;
+		double attributeError = AttributeError(from, to);
+		if (kinds[from] == SimplifyVertexKind::Seam)
+		{
+			// the other side of the seam has to collapse along the same edge
+			if (kinds[to] != SimplifyVertexKind::Seam || !std::binary_search(edges.begin(), edges.end(), SimplifyEdgeKey(nextWedges[from], nextWedges[to])))
+				return DBL_MAX;
+			attributeError = std::max(attributeError, AttributeError(nextWedges[from], nextWedges[to]));
+		}
+		return quadrics[corners[from]].Evaluate(positions[to]) + attributeError;
+	};
+	// moving the vertex must not turn any of its remaining triangles around
+	auto CollapseFlipsTriangles = [&](uint32_t from, uint32_t to) {
+		for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; i++)
+		{
+			uint32_t triangle = adjacency[i];
+			uint32_t triangleVertices[3];
+			for (uint32_t j = 0; j < 3; j++)
+				triangleVertices[j] = collapseTargets[targetIndices[triangle * 3 + j]];
+			if (triangleVertices[0] == to || triangleVertices[1] == to || triangleVertices[2] == to)
+				continue;
+			glm::vec3 corner[3] = { positions[triangleVertices[0]], positions[triangleVertices[1]], positions[triangleVertices[2]] };
+			glm::vec3 normal = glm::cross(corner[1] - corner[0], corner[2] - corner[0]);
+			for (uint32_t j = 0; j < 3; j++)
+				corner[j] = triangleVertices[j] == from ? positions[to] : corner[j];
+			glm::vec3 newNormal = glm::cross(corner[1] - corner[0], corner[2] - corner[0]);
+			// more than about 75 degrees counts as flipped, smaller turns can add up to a flip over several passes
+			if (glm::dot(normal, newNormal) <= SIMPLIFY_FLIP_COSINE * glm::length(normal) * glm::length(newNormal) && glm::dot(normal, normal) > 0.0f)
+				return true;
+		}
+		return false;
+	};
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+	std::vector<Collapse> collapses;
+	uint32_t targetTriangleCount = targetIndexCount / 3;
+	double maxCost = (double)maxError * (double)maxError;
+	double reachedCost = 0.0;
+	while (targetIndices.size() / 3 > targetTriangleCount)
+	{
+		uint32_t triangleCount = (uint32_t)targetIndices.size() / 3;
+		edges.clear();
+		for (uint32_t i = 0; i < triangleCount * 3; i++)
+			edges.push_back(SimplifyEdgeKey(targetIndices[i], targetIndices[i - i % 3 + (i + 1) % 3]));
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t index : targetIndices)
+			adjacencyOffsets[index + 1]++;
+		for (uint32_t i = 0; i < vertexCount; i++)
+			adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+		adjacency.resize(targetIndices.size());
+		std::vector<uint32_t> adjacencyEnds(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t i = 0; i < targetIndices.size(); i++)
+			adjacency[adjacencyEnds[targetIndices[i]]++] = i / 3;
+
+		collapses.clear();
+		for (uint64_t edge : edges)
+		{
+			uint32_t a = (uint32_t)(edge >> 32);
+			uint32_t b = (uint32_t)edge;
+			double costAB = CollapseCost(a, b);
+			double costBA = CollapseCost(b, a);
+			if (costAB < DBL_MAX || costBA < DBL_MAX)
+				collapses.push_back(costAB <= costBA ? Collapse{ a, b, costAB } : Collapse{ b, a, costBA });
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		// costs are only up to date for the first collapse around each corner, so each pass touches a corner once
+		std::fill(touchedCorners.begin(), touchedCorners.end(), false);
+		uint32_t collapseGoal = std::max((triangleCount - targetTriangleCount) / 2, 1u);
+		uint32_t collapseCount = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (collapse.cost > maxCost)
+				break;
+			if (touchedCorners[corners[collapse.from]] || touchedCorners[corners[collapse.to]])
+				continue;
+			bool seam = kinds[collapse.from] == SimplifyVertexKind::Seam;
+			if (CollapseFlipsTriangles(collapse.from, collapse.to) ||
+				(seam && CollapseFlipsTriangles(nextWedges[collapse.from], nextWedges[collapse.to])))
+				continue;
+
+			collapseTargets[collapse.from] = collapse.to;
+			if (seam)
+				collapseTargets[nextWedges[collapse.from]] = nextWedges[collapse.to];
+			quadrics[corners[collapse.to]].Add(quadrics[corners[collapse.from]]);
+			touchedCorners[corners[collapse.from]] = touchedCorners[corners[collapse.to]] = true;
+			reachedCost = std::max(reachedCost, collapse.cost);
+			if (++collapseCount == collapseGoal)
+				break;
+		}
+		if (collapseCount == 0)
+			break;
+
+		uint32_t writtenTriangleCount = 0;
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			uint32_t a = collapseTargets[targetIndices[i * 3 + 0]];
+			uint32_t b = collapseTargets[targetIndices[i * 3 + 1]];
+			uint32_t c = collapseTargets[targetIndices[i * 3 + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+			targetIndices[writtenTriangleCount * 3 + 0] = a;
+			targetIndices[writtenTriangleCount * 3 + 1] = b;
+			targetIndices[writtenTriangleCount * 3 + 2] = c;
+			trianglePieces[writtenTriangleCount++] = trianglePieces[i];
+		}
+		targetIndices.resize(writtenTriangleCount * 3);
+		trianglePieces.resize(writtenTriangleCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			collapseTargets[i] = i;
+	}
+
+	targetPieces.resize(mesh.pieceCount);
+	for (uint32_t i = 0; i < mesh.pieceCount; i++)
+		targetPieces[i] = (uint32_t)(std::lower_bound(trianglePieces.begin(), trianglePieces.end(), i) - trianglePieces.begin()) * 3;
+	return (float)std::sqrt(reachedCost);
+}
+
+void sf::MeshProcessor::GenerateLods(MeshData& mesh, uint32_t lodCount, float reduction)
+{
+	SF_PROFILE_SCOPE("MeshProcessor::GenerateLods");
+	assert(mesh.lods.empty());
+	if (!mesh.HasBounds())
+		mesh.ComputeBounds();
+	uint32_t vertexSize = mesh.vertexBufferLayout->GetSize();
+	const MeshData* source = &mesh;
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> pieces;
+	for (uint32_t i = 0; i < lodCount; i++)
+	{
+		float error = Simplify(*source, (uint32_t)(source->indexCount * reduction), FLT_MAX, indices, pieces);
+		if (indices.size() == 0 || indices.size() > source->indexCount * LOD_MIN_REDUCTION)
+			break;
+
+		MeshData* lod = new MeshData(mesh.vertexBufferLayout);
+		std::vector<uint32_t> remapping(source->vertexCount, UINT32_MAX);
+		for (uint32_t& index : indices)
+		{
+			if (remapping[index] == UINT32_MAX)
+				remapping[index] = lod->vertexCount++;
+			index = remapping[index];
+		}
+		lod->vertexBuffer = malloc((size_t)lod->vertexCount * vertexSize);
+		for (uint32_t j = 0; j < source->vertexCount; j++)
+		{
+			if (remapping[j] != UINT32_MAX)
+				memcpy((uint8_t*)lod->vertexBuffer + (size_t)remapping[j] * vertexSize, (const uint8_t*)source->vertexBuffer + (size_t)j * vertexSize, vertexSize);
+		}
+		lod->indexCount = (uint32_t)indices.size();
+		lod->indexBuffer = new uint32_t[lod->indexCount];
+		memcpy(lod->indexBuffer, indices.data(), indices.size() * sizeof(uint32_t));
+		lod->pieceCount = (uint32_t)pieces.size();
+		lod->pieces = new uint32_t[lod->pieceCount];
+		memcpy(lod->pieces, pieces.data(), pieces.size() * sizeof(uint32_t));
+
+		// bounds stay the original ones so culling and skinned bounds don't change between lods
+		lod->boundsMin = mesh.boundsMin;
+		lod->boundsMax = mesh.boundsMax;
+		lod->boundingSphereCenter = mesh.boundingSphereCenter;
+		lod->boundingSphereRadius = mesh.boundingSphereRadius;
+		lod->boneBoundingSpheres = mesh.boneBoundingSpheres;
+		lod->simplificationError = source->simplificationError + error;
+		OptimizeVertexCache(*lod);
+		OptimizeVertexFetch(*lod);
+
+		mesh.lods.push_back(lod);
+		source = lod;
+	}
+}
+
+void sf::MeshProcessor::FreeLods(MeshData& mesh)
+{
+	for (MeshData* lod : mesh.lods)
 	{
-		glm::vec4* boneIndicesPointer = mesh.AccessVertexComponent<glm::vec4>(BufferComponent::BoneIndices, i);
-		boneIndicesPointer->x = (float) boneRemapping[(uint32_t)boneIndicesPointer->x];
-		boneIndicesPointer->y = (float) boneRemapping[(uint32_t)boneIndicesPointer->y];
-		boneIndicesPointer->z = (float) boneRemapping[(uint32_t)boneIndicesPointer->z];
-		boneIndicesPointer->w = (float) boneRemapping[(uint32_t)boneIndicesPointer->w];
+		free(lod->vertexBuffer);
+		delete[] lod->indexBuffer;
+		delete[] lod->pieces;
+		delete lod;
 	}
-}
\ No newline at end of file
+	mesh.lods.clear();
+}
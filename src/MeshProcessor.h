@@ -19,6 +19,15 @@ namespace sf {
 			float falloff = 6.0f;
 	};
 
+	/* Rendering cost of a mesh's index order, lower is better for all of them */
+	struct MeshDrawStatistics
+	{
+		float acmr = 0.0f; // vertex shader runs per triangle with a fifo post transform cache, 0.5 at best and 3 at worst
+		float atvr = 0.0f; // vertex shader runs per referenced vertex, 1 at best
+		float overdraw = 0.0f; // fragments shaded per pixel covered, averaged over six axis aligned views, 1 at best
+		float overfetch = 0.0f; // vertex buffer bytes fetched through a small cache per byte in the buffer, 1 at best
+	};
+
 	class MeshProcessor {
 	private:
 		static float ComputeOcclusion(const std::vector<std::pair<bool, float>>& rayResults, float maxDistance, float falloff);
@@ -28,5 +37,32 @@ namespace sf {
 		static void ComputeVertexAmbientOcclusion(MeshData& mesh, const VoxelVolumeData* voxelVolume = nullptr, const VertexAmbientOcclusionBakerConfig* config = nullptr);
 		static void GenerateGrid(MeshData& mesh, uint32_t sizeX, uint32_t sizeY, uint32_t texResX, uint32_t texResY, float cellSize, bool useQuads = false);
 		static void RemoveUnusedBones(MeshData& mesh, SkeletonData& skeleton);
+		/* Writes every vertex skinned with the skeleton's current skinning matrices, normals are only written if targetNormals isn't null.
+		 * Bone data can use the compact types. Vertices are split in ranges across threads, and when the build targets avx each vertex
+		 * blends its bone matrices two columns per register. */
+		static void ComputeSkinnedVertices(const MeshData& mesh, const SkeletonData& skeleton, glm::vec3* targetPositions, glm::vec3* targetNormals = nullptr);
+
+		/* Index and vertex reordering for triangle meshes, every piece is reordered on its own so pieces stay valid.
+		 * The usual order is OptimizeVertexCache, then OptimizeOverdraw, then OptimizeVertexFetch. */
+		/* Reorders triangles for the post transform cache with tipsify */
+		static void OptimizeVertexCache(MeshData& mesh, uint32_t cacheSize = 16);
+		/* Splits the triangles in clusters and sorts them so outward facing ones draw first, threshold is how much worse
+		 * than the current acmr a cluster is allowed to get, call after OptimizeVertexCache */
+		static void OptimizeOverdraw(MeshData& mesh, float threshold = 1.05f, uint32_t cacheSize = 16);
+		/* Reorders vertices in the order the indices first use them and remaps the indices, unused vertices go last */
+		static void OptimizeVertexFetch(MeshData& mesh);
+		static MeshDrawStatistics AnalyzeDrawing(const MeshData& mesh, uint32_t cacheSize = 16);
+
+		/* Collapses edges of a triangle mesh with quadric error metrics until at most targetIndexCount indices are left or
+		 * the next collapse would move the surface further than maxError, returns the error reached in mesh space.
+		 * Collapses move vertices onto existing ones so attributes stay valid, changing normals, uvs or colors adds to their
+		 * cost. Vertices on piece borders, open borders and seams with more than two sides are locked. The indices of
+		 * every piece are written in order and targetPieces gets where each piece starts. */
+		static float Simplify(const MeshData& mesh, uint32_t targetIndexCount, float maxError, std::vector<uint32_t>& targetIndices, std::vector<uint32_t>& targetPieces);
+		/* Fills mesh.lods with up to lodCount levels, each one simplified from the previous to reduction times its triangles
+		 * and with its own vertex buffer holding only the vertices it uses. Stops early once locked vertices keep a level from
+		 * getting simpler. */
+		static void GenerateLods(MeshData& mesh, uint32_t lodCount = 4, float reduction = 0.35f);
+		static void FreeLods(MeshData& mesh);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,500 @@
+#include "MsdfAtlas.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#include <Hash.h>
+#include <FileUtils.h>
+#include <SebTextRenderData.h>
+
+#define MSDF_CACHE_FOLDER "fontcache"
+#define MSDF_CACHE_MAGIC 0x46445346 // "FSDF"
+#define MSDF_CACHE_VERSION 1
+#define MSDF_ATLAS_WIDTH 1024
+#define MSDF_CELL_SPACING 1
+#define MSDF_CORNER_ANGLE_SIN 0.14112f // sin(3 radians), tangents bending more than that make a corner
+
+namespace
+{
+	enum EdgeColor : uint8_t
+	{
+		Red = 1,
+		Green = 2,
+		Blue = 4,
+		Yellow = Red | Green,
+		Magenta = Red | Blue,
+		Cyan = Green | Blue,
+		White = Red | Green | Blue
+	};
+
+	struct Edge
+	{
+		glm::dvec2 p0, p1, p2;
+		uint8_t color;
+
+		inline glm::dvec2 StartDirection() const
+		{
+			glm::dvec2 direction = p1 - p0;
+			return (direction.x == 0.0 && direction.y == 0.0) ? p2 - p0 : direction;
+		}
+		inline glm::dvec2 EndDirection() const
+		{
+			glm::dvec2 direction = p2 - p1;
+			return (direction.x == 0.0 && direction.y == 0.0) ? p2 - p0 : direction;
+		}
+	};
+
+	struct SignedDistance
+	{
+		double distance = -1e240;
+		double dot = 1.0;
+
+		inline bool operator<(const SignedDistance& other) const
+		{
+			return std::fabs(distance) < std::fabs(other.distance) || (std::fabs(distance) == std::fabs(other.distance) && dot < other.dot);
+		}
+	};
+
+	struct CacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t glyphCount;
+		float pixelsPerEm;
+		float pixelRange;
+	};
+
+	inline double Cross(const glm::dvec2& a, const glm::dvec2& b) { return a.x * b.y - a.y * b.x; }
+	inline double NonZeroSign(double value) { return value > 0.0 ? 1.0 : -1.0; }
+
+	int SolveQuadratic(double x[2], double a, double b, double c)
+	{
+		if (std::fabs(a) < 1e-14)
+		{
+			if (std::fabs(b) < 1e-14)
+				return 0;
+			x[0] = -c / b;
+			return 1;
+		}
+		double discriminant = b * b - 4.0 * a * c;
+		if (discriminant > 0.0)
+		{
+			discriminant = std::sqrt(discriminant);
+			x[0] = (-b + discriminant) / (2.0 * a);
+			x[1] = (-b - discriminant) / (2.0 * a);
+			return 2;
+		}
+		if (discriminant == 0.0)
+		{
+			x[0] = -b / (2.0 * a);
+			return 1;
+		}
+		return 0;
+	}
+
+	int SolveCubic(double x[3], double a, double b, double c, double d)
+	{
+		if (std::fabs(a) < 1e-14)
+			return SolveQuadratic(x, b, c, d);
+		// normalized to t^3 + b t^2 + c t + d
+		b /= a; c /= a; d /= a;
+		double b2 = b * b;
+		double q = (b2 - 3.0 * c) / 9.0;
+		double r = (b * (2.0 * b2 - 9.0 * c) + 27.0 * d) / 54.0;
+		double r2 = r * r;
+		double q3 = q * q * q;
+		b /= 3.0;
+		if (r2 < q3)
+		{
+			double t = std::acos(std::max(-1.0, std::min(1.0, r / std::sqrt(q3))));
+			q = -2.0 * std::sqrt(q);
+			x[0] = q * std::cos(t / 3.0) - b;
+			x[1] = q * std::cos((t + 2.0 * 3.14159265358979) / 3.0) - b;
+			x[2] = q * std::cos((t - 2.0 * 3.14159265358979) / 3.0) - b;
+			return 3;
+		}
+		double A = -std::pow(std::fabs(r) + std::sqrt(r2 - q3), 1.0 / 3.0);
+		if (r < 0.0)
+			A = -A;
+		double B = A == 0.0 ? 0.0 : q / A;
+		x[0] = (A + B) - b;
+		x[1] = -0.5 * (A + B) - b;
+		return std::fabs(0.5 * std::sqrt(3.0) * (A - B)) < 1e-14 ? 2 : 1;
+	}
+
+	// closest point on a quadratic bezier, sign tells the side of the curve, param is the curve parameter of that point
+	SignedDistance QuadraticSignedDistance(const Edge& edge, const glm::dvec2& origin, double& param)
+	{
+		glm::dvec2 qa = edge.p0 - origin;
+		glm::dvec2 ab = edge.p1 - edge.p0;
+		glm::dvec2 br = edge.p2 - edge.p1 - ab;
+		double a = glm::dot(br, br);
+		double b = 3.0 * glm::dot(ab, br);
+		double c = 2.0 * glm::dot(ab, ab) + glm::dot(qa, br);
+		double d = glm::dot(qa, ab);
+		double t[3];
+		int solutions = SolveCubic(t, a, b, c, d);
+
+		glm::dvec2 startDirection = edge.StartDirection();
+		double minDistance = NonZeroSign(Cross(startDirection, qa)) * glm::length(qa);
+		param = -glm::dot(qa, startDirection) / glm::dot(startDirection, startDirection);
+
+		glm::dvec2 endDirection = edge.EndDirection();
+		double distance = glm::length(edge.p2 - origin);
+		if (distance < std::fabs(minDistance))
+		{
+			minDistance = NonZeroSign(Cross(endDirection, edge.p2 - origin)) * distance;
+			param = glm::dot(origin - edge.p1, endDirection) / glm::dot(endDirection, endDirection);
+		}
+		for (int i = 0; i < solutions; i++)
+		{
+			if (t[i] <= 0.0 || t[i] >= 1.0)
+				continue;
+			glm::dvec2 qe = qa + 2.0 * t[i] * ab + t[i] * t[i] * br;
+			distance = glm::length(qe);
+			if (distance <= std::fabs(minDistance))
+			{
+				minDistance = NonZeroSign(Cross(ab + t[i] * br, qe)) * distance;
+				param = t[i];
+			}
+		}
+
+		SignedDistance result;
+		result.distance = minDistance;
+		if (param >= 0.0 && param <= 1.0)
+			result.dot = 0.0;
+		else if (param < 0.5)
+			result.dot = std::fabs(glm::dot(glm::normalize(startDirection), glm::normalize(qa)));
+		else
+			result.dot = std::fabs(glm::dot(glm::normalize(endDirection), glm::normalize(edge.p2 - origin)));
+		return result;
+	}
+
+	// past the ends of the closest edge the distance is measured to the extended tangent so channels meet at corners
+	double ToPseudoDistance(const Edge& edge, const glm::dvec2& origin, const SignedDistance& signedDistance, double param)
+	{
+		double distance = signedDistance.distance;
+		if (param < 0.0)
+		{
+			glm::dvec2 direction = glm::normalize(edge.StartDirection());
+			glm::dvec2 aq = origin - edge.p0;
+			if (glm::dot(aq, direction) < 0.0)
+			{
+				double pseudoDistance = Cross(aq, direction);
+				if (std::fabs(pseudoDistance) <= std::fabs(distance))
+					distance = pseudoDistance;
+			}
+		}
+		else if (param > 1.0)
+		{
+			glm::dvec2 direction = glm::normalize(edge.EndDirection());
+			glm::dvec2 bq = origin - edge.p2;
+			if (glm::dot(bq, direction) > 0.0)
+			{
+				double pseudoDistance = Cross(bq, direction);
+				if (std::fabs(pseudoDistance) <= std::fabs(distance))
+					distance = pseudoDistance;
+			}
+		}
+		return distance;
+	}
+
+	// curves coming from sebtext are monotonic in y so each one crosses a horizontal ray at most once
+	int Winding(const std::vector<Edge>& edges, const glm::dvec2& point)
+	{
+		int winding = 0;
+		for (const Edge& edge : edges)
+		{
+			double minY = std::min(edge.p0.y, edge.p2.y);
+			double maxY = std::max(edge.p0.y, edge.p2.y);
+			if (point.y < minY || point.y >= maxY)
+				continue;
+			double t[2];
+			int solutions = SolveQuadratic(t, edge.p0.y - 2.0 * edge.p1.y + edge.p2.y, 2.0 * (edge.p1.y - edge.p0.y), edge.p0.y - point.y);
+			for (int i = 0; i < solutions; i++)
+			{
+				if (t[i] < -1e-9 || t[i] > 1.0 + 1e-9)
+					continue;
+				double x = (1.0 - t[i]) * (1.0 - t[i]) * edge.p0.x + 2.0 * (1.0 - t[i]) * t[i] * edge.p1.x + t[i] * t[i] * edge.p2.x;
+				if (x > point.x)
+					winding += edge.p2.y > edge.p0.y ? 1 : -1;
+				break;
+			}
+		}
+		return winding;
+	}
+
+	bool IsCorner(const glm::dvec2& incoming, const glm::dvec2& outgoing)
+	{
+		glm::dvec2 a = glm::normalize(incoming);
+		glm::dvec2 b = glm::normalize(outgoing);
+		return glm::dot(a, b) <= 0.0 || std::fabs(Cross(a, b)) > MSDF_CORNER_ANGLE_SIN;
+	}
+
+	// cycles the colors between corners so the edges meeting at each corner never share two channels
+	void ColorContour(Edge* edges, uint32_t edgeCount)
+	{
+		std::vector<uint32_t> corners;
+		for (uint32_t i = 0; i < edgeCount; i++)
+		{
+			const Edge& previous = edges[(i + edgeCount - 1) % edgeCount];
+			if (IsCorner(previous.EndDirection(), edges[i].StartDirection()))
+				corners.push_back(i);
+		}
+
+		if (corners.size() == 0)
+		{
+			for (uint32_t i = 0; i < edgeCount; i++)
+				edges[i].color = White;
+			return;
+		}
+
+		if (corners.size() == 1)
+		{
+			// teardrop, split the contour in thirds starting at the corner
+			const uint8_t colors[3] = { Magenta, White, Yellow };
+			for (uint32_t i = 0; i < edgeCount; i++)
+			{
+				uint32_t edgeIndex = (corners[0] + i) % edgeCount;
+				edges[edgeIndex].color = edgeCount < 3 ? White : colors[(i * 3) / edgeCount];
+			}
+			return;
+		}
+
+		const uint8_t colors[3] = { Cyan, Magenta, Yellow };
+		for (uint32_t c = 0; c < corners.size(); c++)
+		{
+			uint32_t colorIndex = c % 3;
+			if (c == corners.size() - 1 && colorIndex == 0)
+				colorIndex = 1; // the last run touches the first one
+			uint32_t end = corners[(c + 1) % corners.size()];
+			uint32_t i = corners[c];
+			do
+			{
+				edges[i].color = colors[colorIndex];
+				i = (i + 1) % edgeCount;
+			} while (i != end);
+		}
+	}
+
+	void GenerateGlyph(const std::vector<Edge>& edges, uint8_t* pixels, uint32_t rowStride, uint32_t cellWidth, uint32_t cellHeight, double pixelsPerEm, double rangeEm)
+	{
+		const uint8_t channelBits[3] = { Red, Green, Blue };
+		for (uint32_t y = 0; y < cellHeight; y++)
+		{
+			for (uint32_t x = 0; x < cellWidth; x++)
+			{
+				// cell is centered on the glyph center, which is the outline origin
+				glm::dvec2 point = glm::dvec2(((double)x + 0.5 - cellWidth * 0.5) / pixelsPerEm, ((double)y + 0.5 - cellHeight * 0.5) / pixelsPerEm);
+
+				SignedDistance channelDistances[3];
+				int channelEdges[3] = { -1, -1, -1 };
+				double channelParams[3] = { 0.0, 0.0, 0.0 };
+				SignedDistance closest;
+				for (uint32_t e = 0; e < edges.size(); e++)
+				{
+					double param;
+					SignedDistance distance = QuadraticSignedDistance(edges[e], point, param);
+					if (distance < closest)
+						closest = distance;
+					for (uint32_t c = 0; c < 3; c++)
+					{
+						if ((edges[e].color & channelBits[c]) && distance < channelDistances[c])
+						{
+							channelDistances[c] = distance;
+							channelEdges[c] = e;
+							channelParams[c] = param;
+						}
+					}
+				}
+
+				double values[3];
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					double distance = channelEdges[c] == -1 ? closest.distance :
+						ToPseudoDistance(edges[channelEdges[c]], point, channelDistances[c], channelParams[c]);
+					values[c] = distance / rangeEm + 0.5;
+				}
+
+				// channels that disagree with the actual fill fall back to a plain distance field for this texel
+				bool inside = Winding(edges, point) != 0;
+				double median = std::max(std::min(values[0], values[1]), std::min(std::max(values[0], values[1]), values[2]));
+				if ((median > 0.5) != inside)
+				{
+					double value = (inside ? 1.0 : -1.0) * std::fabs(closest.distance) / rangeEm + 0.5;
+					values[0] = values[1] = values[2] = value;
+				}
+
+				uint8_t* pixel = pixels + y * rowStride + x * 3;
+				for (uint32_t c = 0; c < 3; c++)
+					pixel[c] = (uint8_t)(std::max(0.0, std::min(1.0, values[c])) * 255.0 + 0.5);
+			}
+		}
+	}
+
+	std::vector<const SebText::GlyphData*> GatherGlyphs(const SebText::FontData& fontData, uint32_t firstCharacter, uint32_t lastCharacter, std::vector<uint32_t>& outUnicodes)
+	{
+		std::vector<const SebText::GlyphData*> out;
+		for (uint32_t unicode = firstCharacter; unicode <= lastCharacter; unicode++)
+		{
+			const SebText::GlyphData* glyphData;
+			fontData.TryGetGlyph(unicode, glyphData);
+			if (glyphData == nullptr || glyphData->ContourEndIndices.size() == 0 || std::find(out.begin(), out.end(), glyphData) != out.end())
+				continue;
+			out.push_back(glyphData);
+			outUnicodes.push_back(unicode);
+		}
+		return out;
+	}
+}
+
+bool sf::MsdfAtlas::LoadFromCache(const SebText::FontData& fontData, const std::string& cachePath)
+{
+	std::ifstream ifs(cachePath, std::ios::binary);
+	if (ifs.fail())
+		return false;
+	CacheHeader header;
+	ifs.read((char*)&header, sizeof(header));
+	if (!ifs || header.magic != MSDF_CACHE_MAGIC || header.version != MSDF_CACHE_VERSION)
+		return false;
+	std::vector<Glyph> cachedGlyphs(header.glyphCount);
+	ifs.read((char*)cachedGlyphs.data(), header.glyphCount * sizeof(Glyph));
+	bitmap.CreateSolid(DataType::u8, 3, header.width, header.height);
+	ifs.read((char*)bitmap.buffer, header.width * header.height * 3);
+	if (!ifs)
+		return false;
+
+	pixelsPerEm = header.pixelsPerEm;
+	pixelRange = header.pixelRange;
+	glyphs.clear();
+	for (const Glyph& glyph : cachedGlyphs)
+	{
+		const SebText::GlyphData* glyphData;
+		fontData.TryGetGlyph(glyph.unicode, glyphData);
+		glyphs[glyphData] = glyph;
+	}
+	return true;
+}
+
+void sf::MsdfAtlas::SaveToCache(const std::string& cachePath) const
+{
+	FileUtils::CreateFolder(MSDF_CACHE_FOLDER);
+	std::ofstream ofs(cachePath, std::ios::binary);
+	if (ofs.fail())
+	{
+		std::cout << "[MsdfAtlas] Could not write atlas cache to " << cachePath << std::endl;
+		return;
+	}
+	CacheHeader header = { MSDF_CACHE_MAGIC, MSDF_CACHE_VERSION, bitmap.width, bitmap.height, (uint32_t)glyphs.size(), pixelsPerEm, pixelRange };
+	ofs.write((const char*)&header, sizeof(header));
+	for (const auto& pair : glyphs)
+		ofs.write((const char*)&pair.second, sizeof(Glyph));
+	ofs.write((const char*)bitmap.buffer, bitmap.width * bitmap.height * 3);
+}
+
+void sf::MsdfAtlas::Create(const SebText::FontData& fontData, const std::string& fontPath, uint32_t firstCharacter, uint32_t lastCharacter, float pixelsPerEm, float pixelRange)
+{
+	uint32_t settings[4] = { firstCharacter, lastCharacter };
+	memcpy(&settings[2], &pixelsPerEm, sizeof(float));
+	memcpy(&settings[3], &pixelRange, sizeof(float));
+	uint64_t key = Hash::Fnv1a64(fontPath.data(), fontPath.length());
+	key = Hash::Fnv1a64(settings, sizeof(settings), key);
+	char fileName[17];
+	snprintf(fileName, sizeof(fileName), "%016llx", (unsigned long long)key);
+	std::string cachePath = FileUtils::CombinePaths(MSDF_CACHE_FOLDER, std::string(fileName) + ".msdf");
+	if (LoadFromCache(fontData, cachePath))
+		return;
+
+	std::cout << "[MsdfAtlas] Generating atlas for " << fontPath << std::endl;
+	this->pixelsPerEm = pixelsPerEm;
+	this->pixelRange = pixelRange;
+
+	std::vector<uint32_t> unicodes;
+	std::vector<const SebText::GlyphData*> glyphDatas = GatherGlyphs(fontData, firstCharacter, lastCharacter, unicodes);
+	// outlines relative to each glyph center, split into curves monotonic in y
+	SebText::TextRenderData trd = SebText::CreateRenderData(glyphDatas, fontData);
+
+	std::vector<std::vector<Edge>> glyphEdges(glyphDatas.size());
+	std::vector<glm::uvec2> cellSizes(glyphDatas.size());
+	std::vector<glm::uvec2> cellPositions(glyphDatas.size());
+	float scale = 1.0f / fontData.UnitsPerEm;
+	for (uint32_t i = 0; i < glyphDatas.size(); i++)
+	{
+		int metaDataOffset = trd.AllGlyphData[i].ContourDataOffset;
+		int pointOffset = trd.GlyphMetaData[metaDataOffset];
+		int contourCount = trd.GlyphMetaData[metaDataOffset + 1];
+		for (int contour = 0; contour < contourCount; contour++)
+		{
+			int pointCount = trd.GlyphMetaData[metaDataOffset + 2 + contour];
+			uint32_t contourStart = (uint32_t)glyphEdges[i].size();
+			for (int p = 0; p + 2 <= pointCount; p += 2)
+			{
+				Edge edge;
+				edge.p0 = glm::dvec2(trd.BezierPoints[pointOffset + p]);
+				edge.p1 = glm::dvec2(trd.BezierPoints[pointOffset + p + 1]);
+				edge.p2 = glm::dvec2(trd.BezierPoints[pointOffset + p + 2]);
+				edge.color = White;
+				if (edge.p0 == edge.p2 && edge.p0 == edge.p1)
+					continue;
+				glyphEdges[i].push_back(edge);
+			}
+			if (glyphEdges[i].size() > contourStart)
+				ColorContour(glyphEdges[i].data() + contourStart, (uint32_t)glyphEdges[i].size() - contourStart);
+			pointOffset += pointCount + 1;
+		}
+
+		cellSizes[i].x = (uint32_t)std::ceil(glyphDatas[i]->Width() * scale * pixelsPerEm + 2.0f * pixelRange);
+		cellSizes[i].y = (uint32_t)std::ceil(glyphDatas[i]->Height() * scale * pixelsPerEm + 2.0f * pixelRange);
+	}
+
+	// shelf packing, rows are as tall as their tallest cell
+	uint32_t cursorX = 0, cursorY = 0, rowHeight = 0;
+	for (uint32_t i = 0; i < glyphDatas.size(); i++)
+	{
+		if (cursorX + cellSizes[i].x > MSDF_ATLAS_WIDTH)
+		{
+			cursorX = 0;
+			cursorY += rowHeight + MSDF_CELL_SPACING;
+			rowHeight = 0;
+		}
+		cellPositions[i] = glm::uvec2(cursorX, cursorY);
+		cursorX += cellSizes[i].x + MSDF_CELL_SPACING;
+		rowHeight = std::max(rowHeight, cellSizes[i].y);
+	}
+	uint32_t atlasHeight = 1;
+	while (atlasHeight < cursorY + rowHeight)
+		atlasHeight *= 2;
+
+	uint8_t zero[3] = { 0, 0, 0 };
+	bitmap.CreateSolid(DataType::u8, 3, MSDF_ATLAS_WIDTH, atlasHeight, zero);
+
+	double rangeEm = pixelRange / pixelsPerEm;
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < (int)glyphDatas.size(); i++)
+	{
+		uint8_t* cellPixels = (uint8_t*)bitmap.buffer + (cellPositions[i].y * MSDF_ATLAS_WIDTH + cellPositions[i].x) * 3;
+		GenerateGlyph(glyphEdges[i], cellPixels, MSDF_ATLAS_WIDTH * 3, cellSizes[i].x, cellSizes[i].y, pixelsPerEm, rangeEm);
+	}
+
+	glyphs.clear();
+	for (uint32_t i = 0; i < glyphDatas.size(); i++)
+	{
+		Glyph glyph;
+		glyph.unicode = unicodes[i];
+		glyph.uvRect = glm::vec4(
+			(float)cellPositions[i].x / (float)MSDF_ATLAS_WIDTH,
+			(float)cellPositions[i].y / (float)atlasHeight,
+			(float)(cellPositions[i].x + cellSizes[i].x) / (float)MSDF_ATLAS_WIDTH,
+			(float)(cellPositions[i].y + cellSizes[i].y) / (float)atlasHeight);
+		glyph.size = glm::vec2(cellSizes[i]) / pixelsPerEm;
+		glyphs[glyphDatas[i]] = glyph;
+	}
+
+	SaveToCache(cachePath);
+}
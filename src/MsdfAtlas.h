@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include <Bitmap.h>
+#include <SebTextFontData.h>
+
+namespace sf {
+
+	/*
+	 * Multi-channel signed distance field atlas generated from the glyph outlines of a font, glyphs are
+	 * generated in parallel and the result is cached in fontcache/ keyed by font, character range and size.
+	 * Channels store distances to differently colored edges so corners stay sharp when magnified.
+	 */
+	struct MsdfAtlas
+	{
+		struct Glyph
+		{
+			uint32_t unicode;
+			glm::vec4 uvRect; // min uv, max uv, v grows upwards like the outlines
+			glm::vec2 size; // quad size in em around the glyph center, includes the distance range padding
+		};
+
+		Bitmap bitmap;
+		float pixelsPerEm = 0.0f;
+		float pixelRange = 0.0f;
+		std::unordered_map<const SebText::GlyphData*, Glyph> glyphs;
+
+		void Create(const SebText::FontData& fontData, const std::string& fontPath, uint32_t firstCharacter = 32, uint32_t lastCharacter = 126, float pixelsPerEm = 48.0f, float pixelRange = 4.0f);
+
+		inline const Glyph* GetGlyph(const SebText::GlyphData* glyphData) const
+		{
+			auto iterator = glyphs.find(glyphData);
+			return iterator == glyphs.end() ? nullptr : &iterator->second;
+		}
+
+	private:
+		bool LoadFromCache(const SebText::FontData& fontData, const std::string& cachePath);
+		void SaveToCache(const std::string& cachePath) const;
+	};
+}
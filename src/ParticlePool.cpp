@@ -0,0 +1,153 @@
+#include "ParticlePool.h"
+
+#include <cassert>
+#include <algorithm>
+
+// below this the threading overhead outweighs the work
+#define PARTICLE_PARALLEL_THRESHOLD 16384
+#define PARTICLE_CHUNK_SIZE 4096
+
+namespace sf::ParticleKernels
+{
+	inline void Emit(ParticlePool& pool, uint32_t first, uint32_t count, const Transform& emitter, const Transform* initialTransforms, const glm::vec3& initialVelocity, float spawnTime)
+	{
+		float* px = pool.positionX.data() + first; float* py = pool.positionY.data() + first; float* pz = pool.positionZ.data() + first;
+		float* vx = pool.velocityX.data() + first; float* vy = pool.velocityY.data() + first; float* vz = pool.velocityZ.data() + first;
+		float* rx = pool.rotationX.data() + first; float* ry = pool.rotationY.data() + first; float* rz = pool.rotationZ.data() + first; float* rw = pool.rotationW.data() + first;
+		float* s = pool.scale.data() + first;
+		float* t = pool.spawnTime.data() + first;
+
+		const glm::quat& q = emitter.rotation;
+		glm::vec3 velocity = q * initialVelocity;
+		if (initialTransforms == nullptr)
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				px[i] = emitter.position.x; py[i] = emitter.position.y; pz[i] = emitter.position.z;
+				vx[i] = velocity.x; vy[i] = velocity.y; vz[i] = velocity.z;
+				rx[i] = q.x; ry[i] = q.y; rz[i] = q.z; rw[i] = q.w;
+				s[i] = emitter.scale;
+				t[i] = spawnTime;
+			}
+			return;
+		}
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const Transform& initial = initialTransforms[i];
+			// v + 2w(q x v) + 2q x (q x v)
+			float cx = q.y * initial.position.z - q.z * initial.position.y;
+			float cy = q.z * initial.position.x - q.x * initial.position.z;
+			float cz = q.x * initial.position.y - q.y * initial.position.x;
+			float ccx = q.y * cz - q.z * cy;
+			float ccy = q.z * cx - q.x * cz;
+			float ccz = q.x * cy - q.y * cx;
+			px[i] = emitter.position.x + initial.position.x + 2.0f * (q.w * cx + ccx);
+			py[i] = emitter.position.y + initial.position.y + 2.0f * (q.w * cy + ccy);
+			pz[i] = emitter.position.z + initial.position.z + 2.0f * (q.w * cz + ccz);
+			vx[i] = velocity.x; vy[i] = velocity.y; vz[i] = velocity.z;
+			const glm::quat& r = initial.rotation;
+			rx[i] = q.w * r.x + q.x * r.w + q.y * r.z - q.z * r.y;
+			ry[i] = q.w * r.y - q.x * r.z + q.y * r.w + q.z * r.x;
+			rz[i] = q.w * r.z + q.x * r.y - q.y * r.x + q.z * r.w;
+			rw[i] = q.w * r.w - q.x * r.x - q.y * r.y - q.z * r.z;
+			s[i] = emitter.scale * initial.scale;
+			t[i] = spawnTime;
+		}
+	}
+}
+
+void sf::ParticlePool::Create(uint32_t capacity)
+{
+	this->capacity = capacity;
+	std::vector<float>* arrays[] = { &positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ, &rotationX, &rotationY, &rotationZ, &scale };
+	for (std::vector<float>* array : arrays)
+		array->assign(capacity, 0.0f);
+	rotationW.assign(capacity, 1.0f);
+	spawnTime.assign(capacity, -1.0f);
+
+	emissionTimer = 0.0f;
+	cycleCurrentTime = 0.0f;
+	currentParticle = 0;
+	particlesToWaitFor = 0;
+	dirtyFirst = 0;
+	dirtyCount = capacity;
+}
+
+void sf::ParticlePool::Emit(uint32_t first, uint32_t count, const Transform& emitter, const Transform* initialTransforms, const glm::vec3& initialVelocity, float spawnTime)
+{
+	assert(first + count <= capacity);
+	if (count < PARTICLE_PARALLEL_THRESHOLD)
+		ParticleKernels::Emit(*this, first, count, emitter, initialTransforms, initialVelocity, spawnTime);
+	else
+	{
+		int chunkCount = (int)((count + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE);
+		#pragma omp parallel for
+		for (int chunk = 0; chunk < chunkCount; chunk++)
+		{
+			uint32_t chunkFirst = chunk * PARTICLE_CHUNK_SIZE;
+			uint32_t chunkSize = count - chunkFirst < PARTICLE_CHUNK_SIZE ? count - chunkFirst : PARTICLE_CHUNK_SIZE;
+			ParticleKernels::Emit(*this, first + chunkFirst, chunkSize, emitter, initialTransforms == nullptr ? nullptr : initialTransforms + chunkFirst, initialVelocity, spawnTime);
+		}
+	}
+	MarkDirty(first, count);
+}
+
+void sf::ParticlePool::Disable(uint32_t first, uint32_t count)
+{
+	assert(first + count <= capacity);
+	std::fill(scale.begin() + first, scale.begin() + first + count, 0.0f);
+	std::fill(spawnTime.begin() + first, spawnTime.begin() + first + count, -1.0f);
+	MarkDirty(first, count);
+}
+
+void sf::ParticlePool::MarkDirty(uint32_t first, uint32_t count)
+{
+	if (dirtyCount == 0)
+	{
+		dirtyFirst = first;
+		dirtyCount = count;
+	}
+	else if ((dirtyFirst + dirtyCount) % capacity == first) // emission continues where the dirty range ends
+		dirtyCount = dirtyCount + count > capacity ? capacity : dirtyCount + count;
+	else
+	{
+		dirtyFirst = 0;
+		dirtyCount = capacity;
+	}
+}
+
+void sf::ParticlePool::Pack(void* buffer, const BufferLayout& layout, uint32_t first, uint32_t count) const
+{
+	assert(first + count <= capacity);
+	const BufferComponentInfo* positionInfo = layout.GetComponentInfo(BufferComponent::Position);
+	const BufferComponentInfo* rotationInfo = layout.GetComponentInfo(BufferComponent::Rotation);
+	const BufferComponentInfo* scaleInfo = layout.GetComponentInfo(BufferComponent::Scale);
+	const BufferComponentInfo* spawnTimeInfo = layout.GetComponentInfo(BufferComponent::SpawnTime);
+	const BufferComponentInfo* velocityInfo = layout.GetComponentInfo(BufferComponent::Velocity);
+	assert(positionInfo != nullptr && rotationInfo != nullptr && scaleInfo != nullptr && spawnTimeInfo != nullptr);
+
+	uint32_t stride = layout.GetSize();
+	int chunkCount = (int)((count + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE);
+	#pragma omp parallel for if(count >= PARTICLE_PARALLEL_THRESHOLD)
+	for (int chunk = 0; chunk < chunkCount; chunk++)
+	{
+		uint32_t chunkFirst = first + chunk * PARTICLE_CHUNK_SIZE;
+		uint32_t chunkEnd = chunkFirst + PARTICLE_CHUNK_SIZE < first + count ? chunkFirst + PARTICLE_CHUNK_SIZE : first + count;
+		uint8_t* particle = (uint8_t*)buffer + (uint64_t)stride * chunkFirst;
+		for (uint32_t i = chunkFirst; i < chunkEnd; i++, particle += stride)
+		{
+			float* position = (float*)(particle + positionInfo->byteOffset);
+			float* rotation = (float*)(particle + rotationInfo->byteOffset);
+			position[0] = positionX[i]; position[1] = positionY[i]; position[2] = positionZ[i];
+			rotation[0] = rotationX[i]; rotation[1] = rotationY[i]; rotation[2] = rotationZ[i]; rotation[3] = rotationW[i];
+			*(float*)(particle + scaleInfo->byteOffset) = scale[i];
+			*(float*)(particle + spawnTimeInfo->byteOffset) = spawnTime[i];
+			if (velocityInfo != nullptr)
+			{
+				float* velocity = (float*)(particle + velocityInfo->byteOffset);
+				velocity[0] = velocityX[i]; velocity[1] = velocityY[i]; velocity[2] = velocityZ[i];
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include <BufferLayout.h>
+#include <Components/Transform.h>
+
+namespace sf {
+
+	/*
+	 * Runtime state of a dynamic particle system stored as one array per scalar so the kernels
+	 * run over contiguous floats, large ranges are split across threads. Particles are a ring,
+	 * emission writes the next particles in order and only the range written since the last
+	 * upload is packed into the gpu layout. Positions and velocities are the ones at emission,
+	 * motion is evaluated in the vertex shader from the time alive, see assets/shaders/particle.h.
+	 */
+	struct ParticlePool
+	{
+		uint32_t capacity = 0;
+		std::vector<float> positionX, positionY, positionZ;
+		std::vector<float> velocityX, velocityY, velocityZ;
+		std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+		std::vector<float> scale;
+		std::vector<float> spawnTime; // -1 for disabled particles
+
+		float emissionTimer = 0.0f;
+		float cycleCurrentTime = 0.0f;
+		uint32_t currentParticle = 0;
+		uint32_t particlesToWaitFor = 0;
+
+		// ring range written since the last upload, can wrap around
+		uint32_t dirtyFirst = 0;
+		uint32_t dirtyCount = 0;
+
+		void Create(uint32_t capacity);
+
+		/* initialTransforms is optional, it holds one transform per emitted particle relative to the emitter */
+		void Emit(uint32_t first, uint32_t count, const Transform& emitter, const Transform* initialTransforms, const glm::vec3& initialVelocity, float spawnTime);
+		void Disable(uint32_t first, uint32_t count);
+
+		void MarkDirty(uint32_t first, uint32_t count);
+		/* Writes particles [first, first + count) into an interleaved buffer with the given layout, velocity is optional */
+		void Pack(void* buffer, const BufferLayout& layout, uint32_t first, uint32_t count) const;
+	};
+}
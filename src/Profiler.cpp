@@ -0,0 +1,282 @@
+#include "Profiler.h"
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifdef SF_USE_OPENGL
+#include <glad/glad.h>
+#endif
+
+#define PROFILER_HISTORY_FRAME_COUNT 240
+#define PROFILER_GPU_FRAME_LATENCY 4 // frames the gpu gets before its queries are read
+#define PROFILER_GPU_TRACK 1000
+#define PROFILER_INVALID_EVENT 0xFFFFFFFFU
+
+namespace sf::Profiler
+{
+	struct OpenCpuEvent
+	{
+		const char* name;
+		double start;
+	};
+
+	struct GpuEvent
+	{
+		const char* name;
+		uint32_t depth;
+		uint32_t beginQuery;
+		uint32_t endQuery;
+	};
+
+	// queries issued in one frame, read PROFILER_GPU_FRAME_LATENCY frames later
+	struct GpuFrame
+	{
+		uint64_t frameIndex = 0;
+		bool pending = false;
+		std::vector<GpuEvent> events;
+		std::vector<uint32_t> queries;
+		uint32_t usedQueryCount = 0;
+		// cpu time and gl timestamp taken together when the frame began, places gpu events on the cpu timeline
+		double cpuReference = 0.0;
+		int64_t gpuReference = 0;
+	};
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::mutex mutex;
+	std::vector<Frame> history(PROFILER_HISTORY_FRAME_COUNT);
+	uint64_t frameIndex = 0; // frame being recorded
+	std::atomic<bool> recording(true);
+	bool paused = false;
+	uint32_t threadCount = 0;
+	thread_local uint32_t threadIndex = PROFILER_INVALID_EVENT;
+	thread_local std::vector<OpenCpuEvent> openCpuEvents;
+
+	bool gpuEnabled = false;
+	GpuFrame gpuFrames[PROFILER_GPU_FRAME_LATENCY];
+	uint32_t gpuDepth = 0;
+
+	inline double Now()
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	inline uint32_t GetThreadIndex()
+	{
+		if (threadIndex == PROFILER_INVALID_EVENT)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			threadIndex = threadCount++;
+		}
+		return threadIndex;
+	}
+
+	void ResolveGpuFrame(GpuFrame& gpuFrame)
+	{
+#ifdef SF_USE_OPENGL
+		if (!gpuFrame.pending)
+			return;
+		gpuFrame.pending = false;
+		if (gpuFrame.frameIndex + PROFILER_HISTORY_FRAME_COUNT <= frameIndex || gpuFrame.events.empty())
+			return;
+
+		Frame& frame = history[gpuFrame.frameIndex % PROFILER_HISTORY_FRAME_COUNT];
+		frame.gpuEvents.clear();
+		uint64_t first = ~0ULL;
+		uint64_t last = 0;
+		for (const GpuEvent& gpuEvent : gpuFrame.events)
+		{
+			GLuint64 begin, end;
+			glGetQueryObjectui64v(gpuEvent.beginQuery, GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(gpuEvent.endQuery, GL_QUERY_RESULT, &end);
+			first = begin < first ? begin : first;
+			last = end > last ? end : last;
+
+			Event& event = frame.gpuEvents.emplace_back();
+			event.name = gpuEvent.name;
+			event.threadIndex = PROFILER_GPU_TRACK;
+			event.depth = gpuEvent.depth;
+			event.start = gpuFrame.cpuReference + (double)((int64_t)begin - gpuFrame.gpuReference) / 1000.0;
+			event.duration = (double)(end - begin) / 1000.0;
+		}
+		frame.gpuTime = (double)(last - first) / 1000000.0;
+#endif
+	}
+}
+
+void sf::Profiler::Initialize()
+{
+	GetThreadIndex();
+#ifdef SF_USE_OPENGL
+	gpuEnabled = true;
+#endif
+}
+
+void sf::Profiler::Terminate()
+{
+#ifdef SF_USE_OPENGL
+	for (GpuFrame& gpuFrame : gpuFrames)
+	{
+		if (!gpuFrame.queries.empty())
+			glDeleteQueries((GLsizei)gpuFrame.queries.size(), gpuFrame.queries.data());
+		gpuFrame = GpuFrame();
+	}
+#endif
+	gpuEnabled = false;
+}
+
+void sf::Profiler::BeginFrame()
+{
+	recording = !paused;
+	if (!recording)
+		return;
+
+	history[frameIndex % PROFILER_HISTORY_FRAME_COUNT].start = Now();
+
+#ifdef SF_USE_OPENGL
+	if (!gpuEnabled)
+		return;
+	GpuFrame& gpuFrame = gpuFrames[frameIndex % PROFILER_GPU_FRAME_LATENCY];
+	ResolveGpuFrame(gpuFrame);
+	gpuFrame.frameIndex = frameIndex;
+	gpuFrame.events.clear();
+	gpuFrame.usedQueryCount = 0;
+	gpuFrame.cpuReference = Now();
+	glGetInteger64v(GL_TIMESTAMP, &gpuFrame.gpuReference);
+	gpuDepth = 0;
+#endif
+}
+
+void sf::Profiler::EndFrame()
+{
+	if (!recording)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	Frame& frame = history[frameIndex % PROFILER_HISTORY_FRAME_COUNT];
+	frame.cpuTime = (Now() - frame.start) / 1000.0;
+	if (gpuEnabled)
+		gpuFrames[frameIndex % PROFILER_GPU_FRAME_LATENCY].pending = true;
+
+	frameIndex++;
+	Frame& next = history[frameIndex % PROFILER_HISTORY_FRAME_COUNT];
+	next.index = frameIndex;
+	next.cpuTime = 0.0;
+	next.gpuTime = -1.0;
+	next.cpuEvents.clear();
+	next.gpuEvents.clear();
+}
+
+void sf::Profiler::SetPaused(bool paused)
+{
+	Profiler::paused = paused;
+}
+
+bool sf::Profiler::IsPaused()
+{
+	return paused;
+}
+
+void sf::Profiler::GetFrameHistory(std::vector<const Frame*>& out)
+{
+	out.clear();
+	uint64_t oldest = frameIndex >= PROFILER_HISTORY_FRAME_COUNT - 1 ? frameIndex - (PROFILER_HISTORY_FRAME_COUNT - 1) : 0;
+	for (uint64_t i = oldest; i < frameIndex; i++)
+		out.push_back(&history[i % PROFILER_HISTORY_FRAME_COUNT]);
+}
+
+bool sf::Profiler::WriteChromeTrace(const std::string& filePath)
+{
+	std::ofstream file(filePath);
+	if (!file.is_open())
+	{
+		std::cout << "[Profiler] Failed to open file: " << filePath << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	file << std::fixed << std::setprecision(3); // microseconds
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Main\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << PROFILER_GPU_TRACK << ",\"args\":{\"name\":\"GPU\"}}";
+
+	auto writeEvent = [&file](const Event& event, const char* category) {
+		file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.threadIndex <<
+			",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}";
+	};
+	uint64_t oldest = frameIndex >= PROFILER_HISTORY_FRAME_COUNT - 1 ? frameIndex - (PROFILER_HISTORY_FRAME_COUNT - 1) : 0;
+	for (uint64_t i = oldest; i < frameIndex; i++)
+	{
+		const Frame& frame = history[i % PROFILER_HISTORY_FRAME_COUNT];
+		for (const Event& event : frame.cpuEvents)
+			writeEvent(event, "cpu");
+		for (const Event& event : frame.gpuEvents)
+			writeEvent(event, "gpu");
+	}
+	file << "\n]}\n";
+
+	std::cout << "[Profiler] Wrote chrome trace: " << filePath << std::endl;
+	return true;
+}
+
+void sf::Profiler::BeginCpuEvent(const char* name)
+{
+	GetThreadIndex();
+	openCpuEvents.push_back({ name, Now() });
+}
+
+void sf::Profiler::EndCpuEvent()
+{
+	OpenCpuEvent openEvent = openCpuEvents.back();
+	openCpuEvents.pop_back();
+	if (!recording)
+		return;
+
+	double end = Now();
+	std::lock_guard<std::mutex> lock(mutex);
+	Event& event = history[frameIndex % PROFILER_HISTORY_FRAME_COUNT].cpuEvents.emplace_back();
+	event.name = openEvent.name;
+	event.threadIndex = threadIndex;
+	event.depth = (uint32_t)openCpuEvents.size();
+	event.start = openEvent.start;
+	event.duration = end - openEvent.start;
+}
+
+uint32_t sf::Profiler::BeginGpuEvent(const char* name)
+{
+#ifdef SF_USE_OPENGL
+	if (!gpuEnabled || !recording)
+		return PROFILER_INVALID_EVENT;
+
+	GpuFrame& gpuFrame = gpuFrames[frameIndex % PROFILER_GPU_FRAME_LATENCY];
+	if (gpuFrame.usedQueryCount + 2 > gpuFrame.queries.size())
+	{
+		uint32_t previousCount = (uint32_t)gpuFrame.queries.size();
+		gpuFrame.queries.resize(previousCount + 32);
+		glGenQueries(32, gpuFrame.queries.data() + previousCount);
+	}
+	uint32_t eventIndex = (uint32_t)gpuFrame.events.size();
+	GpuEvent& event = gpuFrame.events.emplace_back();
+	event.name = name;
+	event.depth = gpuDepth++;
+	event.beginQuery = gpuFrame.queries[gpuFrame.usedQueryCount++];
+	event.endQuery = gpuFrame.queries[gpuFrame.usedQueryCount++];
+	glQueryCounter(event.beginQuery, GL_TIMESTAMP);
+	return eventIndex;
+#else
+	return PROFILER_INVALID_EVENT;
+#endif
+}
+
+void sf::Profiler::EndGpuEvent(uint32_t event)
+{
+#ifdef SF_USE_OPENGL
+	if (event == PROFILER_INVALID_EVENT)
+		return;
+	gpuDepth--;
+	glQueryCounter(gpuFrames[frameIndex % PROFILER_GPU_FRAME_LATENCY].events[event].endQuery, GL_TIMESTAMP);
+#endif
+}
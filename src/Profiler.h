@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/*
+ * Scoped timing markers, SF_PROFILE_SCOPE measures cpu time and SF_PROFILE_GPU_SCOPE also places gl timestamp
+ * queries at the same boundaries. Names must be string literals. Both compile to nothing unless SF_PROFILER is defined.
+ */
+#ifdef SF_PROFILER
+#define SF_PROFILE_CONCAT_INNER(a, b) a##b
+#define SF_PROFILE_CONCAT(a, b) SF_PROFILE_CONCAT_INNER(a, b)
+#define SF_PROFILE_SCOPE(name) sf::Profiler::CpuScope SF_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define SF_PROFILE_GPU_SCOPE(name) sf::Profiler::CpuScope SF_PROFILE_CONCAT(profileScope, __LINE__)(name); sf::Profiler::GpuScope SF_PROFILE_CONCAT(profileGpuScope, __LINE__)(name)
+#else
+#define SF_PROFILE_SCOPE(name)
+#define SF_PROFILE_GPU_SCOPE(name)
+#endif
+
+namespace sf::Profiler
+{
+	struct Event
+	{
+		const char* name;
+		uint32_t threadIndex; // 0 is the thread that began the first frame
+		uint32_t depth;
+		double start; // microseconds since initialization
+		double duration;
+	};
+
+	struct Frame
+	{
+		uint64_t index = 0;
+		double start = 0.0;
+		double cpuTime = 0.0; // milliseconds
+		double gpuTime = -1.0; // milliseconds, negative until the queries are resolved a few frames later
+		std::vector<Event> cpuEvents;
+		std::vector<Event> gpuEvents;
+	};
+
+	/* Gpu scopes are ignored until a gl context exists and this is called */
+	void Initialize();
+	void Terminate();
+
+	void BeginFrame();
+	void EndFrame();
+	void SetPaused(bool paused);
+	bool IsPaused();
+
+	/* Oldest first, the last one is the latest completed frame */
+	void GetFrameHistory(std::vector<const Frame*>& out);
+	/* Writes every frame in the history as chrome trace event json, gpu events go in their own track */
+	bool WriteChromeTrace(const std::string& filePath);
+
+	void BeginCpuEvent(const char* name);
+	void EndCpuEvent();
+	uint32_t BeginGpuEvent(const char* name);
+	void EndGpuEvent(uint32_t event);
+
+	struct CpuScope
+	{
+		inline CpuScope(const char* name) { BeginCpuEvent(name); }
+		inline ~CpuScope() { EndCpuEvent(); }
+	};
+
+	struct GpuScope
+	{
+		uint32_t event;
+		inline GpuScope(const char* name) { event = BeginGpuEvent(name); }
+		inline ~GpuScope() { EndGpuEvent(event); }
+	};
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace sf {
+
+	struct Frustum
+	{
+		// xyz normal pointing inside, w distance, order is left, right, bottom, top, near, far
+		glm::vec4 planes[6];
+
+		void ExtractFromMatrix(const glm::mat4& cameraMatrix);
+
+		inline bool IsSphereVisible(const glm::vec3& center, float radius) const
+		{
+			for (uint32_t i = 0; i < 6; i++)
+			{
+				if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+					return false;
+			}
+			return true;
+		}
+
+		/* Tests count spheres given as separate arrays, 8 at a time with avx or 4 with sse */
+		void CullSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius, uint32_t count, uint8_t* outVisible) const;
+	};
+}
@@ -6,11 +6,17 @@
 #include <iostream>
 
 #include <Renderer/GlShader.h>
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
 
 void sf::GlCubemap::Create(uint32_t size, int channelCount, DataType storageDataType, bool mipmap)
 {
 	if (this->isInitialized)
+	{
+		GlState::ForgetTexture(gl_id);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, gl_id);
 		glDeleteTextures(1, &gl_id);
+	}
 	
 	this->isInitialized = true;
 	this->size = size;
@@ -27,6 +33,7 @@ void sf::GlCubemap::Create(uint32_t size, int channelCount, DataType storageData
 	{
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFormat, size, size, 0, format, type, nullptr);
 	}
+	RendererStats::TrackTexture(gl_id, internalFormat, size, size, 6, mipmap);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -34,12 +41,17 @@ void sf::GlCubemap::Create(uint32_t size, int channelCount, DataType storageData
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	GlState::InvalidateTextureUnit(0);
 }
 
 void sf::GlCubemap::CreateFromFiles(const std::vector<std::string>& files, int channelCount, DataType storageDataType, bool mipmap)
 {
 	if (this->isInitialized)
+	{
+		GlState::ForgetTexture(gl_id);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, gl_id);
 		glDeleteTextures(1, &gl_id);
+	}
 	
 	this->isInitialized = true;
 	this->storageDataType = storageDataType;
@@ -99,8 +111,10 @@ void sf::GlCubemap::CreateFromFiles(const std::vector<std::string>& files, int c
 
 	if (mipmap)
 		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	RendererStats::TrackTexture(gl_id, isHdr ? GL_RGB16F : GL_RGB, this->size, this->size, 6, mipmap);
 
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	GlState::InvalidateTextureUnit(0);
 }
 
 /*
@@ -125,22 +139,26 @@ void sf::GlCubemap::ComputeMipmap()
 {
 	glBindTexture(GL_TEXTURE_CUBE_MAP, gl_id);
 	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	GlState::InvalidateTextureUnit(0);
 }
 
 void sf::GlCubemap::Delete()
 {
 	if (gl_id != 0)
+	{
+		GlState::ForgetTexture(gl_id);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, gl_id);
 		glDeleteTextures(1, &gl_id);
+	}
 	gl_id = 0;
 }
 
 void sf::GlCubemap::Bind(uint32_t slot) const
 {
-	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, gl_id);
+	GlState::BindTexture(slot, gl_id);
 }
 
 void sf::GlCubemap::Unbind() const
 {
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	GlState::BindTexture(0, 0);
 }
@@ -0,0 +1,47 @@
+#include "GlFramebuffer.h"
+
+#include <iostream>
+
+bool sf::GlFramebuffer::Create(uint32_t width, uint32_t height)
+{
+	if (this->isInitialized)
+		Delete();
+
+	this->isInitialized = true;
+	this->width = width;
+	this->height = height;
+
+	glGenRenderbuffers(1, &this->gl_colorRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->gl_colorRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, this->width, this->height);
+	glGenRenderbuffers(1, &this->gl_depthRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->gl_depthRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, this->width, this->height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &this->gl_id);
+	glBindFramebuffer(GL_FRAMEBUFFER, this->gl_id);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->gl_colorRenderbuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->gl_depthRenderbuffer);
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (!complete)
+		std::cout << "[GlFramebuffer] Framebuffer is not complete\n";
+	return complete;
+}
+
+void sf::GlFramebuffer::Delete()
+{
+	if (!this->isInitialized)
+		return;
+	glDeleteFramebuffers(1, &this->gl_id);
+	glDeleteRenderbuffers(1, &this->gl_colorRenderbuffer);
+	glDeleteRenderbuffers(1, &this->gl_depthRenderbuffer);
+	this->isInitialized = false;
+}
+
+void sf::GlFramebuffer::Bind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, this->gl_id);
+}
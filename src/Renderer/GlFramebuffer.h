@@ -0,0 +1,26 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+
+namespace sf {
+
+	/*
+	 * Offscreen render target with an rgba8 color and a depth renderbuffer, the renderer draws into it
+	 * instead of the default framebuffer when there is no window to present to.
+	 */
+	class GlFramebuffer
+	{
+	public:
+		bool isInitialized = false;
+		uint32_t gl_id;
+		uint32_t gl_colorRenderbuffer;
+		uint32_t gl_depthRenderbuffer;
+		uint32_t width, height;
+
+		bool Create(uint32_t width, uint32_t height);
+		void Delete();
+
+		void Bind() const;
+	};
+}
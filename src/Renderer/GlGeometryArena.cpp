@@ -0,0 +1,256 @@
+#include "GlGeometryArena.h"
+
+#include <iostream>
+#include <cassert>
+#include <glad/glad.h>
+
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
+#include <VertexFormat.h>
+
+#define COMPACTION_MIN_FREE_VERTICES 4096
+#define COMPACTION_MIN_FREE_INDICES 16384
+
+bool sf::GlGeometryArena::AllocateRange(std::vector<FreeRange>& freeRanges, uint32_t& freeCount, uint32_t& end, uint32_t capacity, uint32_t count, uint32_t& outOffset)
+{
+	// first fit in the holes, then at the end
+	for (uint32_t i = 0; i < freeRanges.size(); i++)
+	{
+		if (freeRanges[i].count < count)
+			continue;
+		outOffset = freeRanges[i].offset;
+		freeRanges[i].offset += count;
+		freeRanges[i].count -= count;
+		if (freeRanges[i].count == 0)
+			freeRanges.erase(freeRanges.begin() + i);
+		freeCount -= count;
+		return true;
+	}
+	if (end + count > capacity)
+		return false;
+	outOffset = end;
+	end += count;
+	return true;
+}
+
+void sf::GlGeometryArena::FreeRangeAndCoalesce(std::vector<FreeRange>& freeRanges, uint32_t& freeCount, uint32_t& end, uint32_t offset, uint32_t count)
+{
+	if (count == 0)
+		return;
+
+	if (offset + count == end)
+	{
+		end = offset;
+		// a hole right before the new end is not a hole anymore
+		if (freeRanges.size() > 0 && freeRanges.back().offset + freeRanges.back().count == end)
+		{
+			end = freeRanges.back().offset;
+			freeCount -= freeRanges.back().count;
+			freeRanges.pop_back();
+		}
+		return;
+	}
+
+	uint32_t insertIndex = 0;
+	for (; insertIndex < freeRanges.size() && freeRanges[insertIndex].offset < offset; insertIndex++);
+	freeRanges.insert(freeRanges.begin() + insertIndex, { offset, count });
+	freeCount += count;
+
+	// merge with next and previous ranges
+	if (insertIndex + 1 < freeRanges.size() && offset + count == freeRanges[insertIndex + 1].offset)
+	{
+		freeRanges[insertIndex].count += freeRanges[insertIndex + 1].count;
+		freeRanges.erase(freeRanges.begin() + insertIndex + 1);
+	}
+	if (insertIndex > 0 && freeRanges[insertIndex - 1].offset + freeRanges[insertIndex - 1].count == offset)
+	{
+		freeRanges[insertIndex - 1].count += freeRanges[insertIndex].count;
+		freeRanges.erase(freeRanges.begin() + insertIndex);
+	}
+}
+
+void sf::GlGeometryArena::SetUpVertexArray()
+{
+	const std::vector<BufferComponentInfo>& components = m_vertexBufferLayout->GetComponentInfos();
+	for (int i = 0; i < components.size(); i++)
+	{
+		glEnableVertexArrayAttrib(gl_vao, i);
+		glVertexArrayAttribBinding(gl_vao, i, 0);
+		GLenum type;
+		switch (components[i].dataType)
+		{
+			case DataType::f32:
+			case DataType::vec2f32:
+			case DataType::vec3f32:
+			case DataType::vec4f32:
+				type = GL_FLOAT; break;
+			case DataType::vec2f16:
+				type = GL_HALF_FLOAT; break;
+			case DataType::vec2i16:
+			case DataType::vec4i16:
+				type = GL_SHORT; break;
+			case DataType::vec4u8:
+				type = GL_UNSIGNED_BYTE; break;
+			case DataType::vec4u16:
+				type = GL_UNSIGNED_SHORT; break;
+			default:
+				std::cout << "[GlGeometryArena] Vertex attribute skipped" << std::endl;
+				assert(false);
+				continue;
+		}
+		// padded types like snorm normals read only the first three of their four components
+		GLint size = VertexFormat::GetShaderComponentCount(components[i].component, components[i].dataType);
+		if (VertexFormat::IsInteger(components[i].component, components[i].dataType))
+			glVertexArrayAttribIFormat(gl_vao, i, size, type, components[i].byteOffset);
+		else
+			glVertexArrayAttribFormat(gl_vao, i, size, type, type == GL_FLOAT || type == GL_HALF_FLOAT ? GL_FALSE : GL_TRUE, components[i].byteOffset);
+	}
+}
+
+void sf::GlGeometryArena::Rebuild(uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+	uint32_t vertexSize = m_vertexBufferLayout->GetSize();
+
+	uint32_t newVertexBuffer, newIndexBuffer;
+	glCreateBuffers(1, &newVertexBuffer);
+	glCreateBuffers(1, &newIndexBuffer);
+	glNamedBufferStorage(newVertexBuffer, (GLsizeiptr)vertexCapacity * vertexSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(newIndexBuffer, (GLsizeiptr)indexCapacity * m_indexSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	// pack every live allocation at the start of the new buffers
+	uint32_t vertexCursor = 0, indexCursor = 0;
+	for (auto& pair : m_allocations)
+	{
+		Allocation& allocation = pair.second;
+		if (allocation.vertexCount > 0)
+			glCopyNamedBufferSubData(gl_vertexBuffer, newVertexBuffer, (GLintptr)allocation.baseVertex * vertexSize, (GLintptr)vertexCursor * vertexSize, (GLsizeiptr)allocation.vertexCount * vertexSize);
+		if (allocation.indexCount > 0)
+			glCopyNamedBufferSubData(gl_indexBuffer, newIndexBuffer, (GLintptr)allocation.firstIndex * m_indexSize, (GLintptr)indexCursor * m_indexSize, (GLsizeiptr)allocation.indexCount * m_indexSize);
+		allocation.baseVertex = vertexCursor;
+		allocation.firstIndex = indexCursor;
+		vertexCursor += allocation.vertexCount;
+		indexCursor += allocation.indexCount;
+	}
+
+	if (gl_vertexBuffer != 0)
+	{
+		GlState::ForgetBuffer(gl_vertexBuffer);
+		glDeleteBuffers(1, &gl_vertexBuffer);
+	}
+	if (gl_indexBuffer != 0)
+	{
+		GlState::ForgetBuffer(gl_indexBuffer);
+		glDeleteBuffers(1, &gl_indexBuffer);
+	}
+	gl_vertexBuffer = newVertexBuffer;
+	gl_indexBuffer = newIndexBuffer;
+	glVertexArrayVertexBuffer(gl_vao, 0, gl_vertexBuffer, 0, vertexSize);
+	glVertexArrayElementBuffer(gl_vao, gl_indexBuffer);
+
+	m_vertexCapacity = vertexCapacity;
+	m_indexCapacity = indexCapacity;
+	RendererStats::TrackMemory(RendererStats::MemoryCategory::Meshes, gl_vao, (uint64_t)vertexCapacity * vertexSize + (uint64_t)indexCapacity * m_indexSize);
+	m_vertexEnd = vertexCursor;
+	m_indexEnd = indexCursor;
+	m_freeVertexCount = 0;
+	m_freeIndexCount = 0;
+	m_freeVertexRanges.clear();
+	m_freeIndexRanges.clear();
+}
+
+void sf::GlGeometryArena::Create(const BufferLayout* vertexBufferLayout, DataType indexType, uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+	assert(!isInitialized);
+	assert(indexType == DataType::u32 || indexType == DataType::u16);
+	m_vertexBufferLayout = vertexBufferLayout;
+	m_indexSize = GetDataTypeSize(indexType);
+	m_glIndexType = indexType == DataType::u16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	glCreateVertexArrays(1, &gl_vao);
+	SetUpVertexArray();
+	gl_vertexBuffer = 0;
+	gl_indexBuffer = 0;
+	Rebuild(vertexCapacity, indexCapacity);
+	isInitialized = true;
+}
+
+void sf::GlGeometryArena::Delete()
+{
+	if (!isInitialized)
+		return;
+	GlState::ForgetVertexArray(gl_vao);
+	GlState::ForgetBuffer(gl_vertexBuffer);
+	GlState::ForgetBuffer(gl_indexBuffer);
+	RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Meshes, gl_vao);
+	glDeleteVertexArrays(1, &gl_vao);
+	glDeleteBuffers(1, &gl_vertexBuffer);
+	glDeleteBuffers(1, &gl_indexBuffer);
+	m_allocations.clear();
+	isInitialized = false;
+}
+
+const sf::GlGeometryArena::Allocation& sf::GlGeometryArena::Add(uint32_t id, const MeshData* mesh)
+{
+	assert(isInitialized);
+	assert(!Contains(id));
+	assert(mesh->vertexBufferLayout == m_vertexBufferLayout);
+	assert(m_indexSize == sizeof(uint32_t) || mesh->vertexCount < 65536);
+
+	Allocation allocation = { 0, mesh->vertexCount, 0, mesh->indexCount };
+	bool allocated = AllocateRange(m_freeVertexRanges, m_freeVertexCount, m_vertexEnd, m_vertexCapacity, mesh->vertexCount, allocation.baseVertex);
+	if (allocated && !AllocateRange(m_freeIndexRanges, m_freeIndexCount, m_indexEnd, m_indexCapacity, mesh->indexCount, allocation.firstIndex))
+	{
+		FreeRangeAndCoalesce(m_freeVertexRanges, m_freeVertexCount, m_vertexEnd, allocation.baseVertex, mesh->vertexCount);
+		allocated = false;
+	}
+
+	if (!allocated)
+	{
+		// compacting may be enough, otherwise grow
+		uint32_t vertexCapacity = m_vertexCapacity;
+		uint32_t indexCapacity = m_indexCapacity;
+		while (m_vertexEnd - m_freeVertexCount + mesh->vertexCount > vertexCapacity)
+			vertexCapacity *= 2;
+		while (m_indexEnd - m_freeIndexCount + mesh->indexCount > indexCapacity)
+			indexCapacity *= 2;
+		if (vertexCapacity != m_vertexCapacity || indexCapacity != m_indexCapacity)
+			std::cout << "[GlGeometryArena] Growing to " << vertexCapacity << " vertices and " << indexCapacity << " indices" << std::endl;
+		Rebuild(vertexCapacity, indexCapacity);
+
+		allocation.baseVertex = m_vertexEnd;
+		allocation.firstIndex = m_indexEnd;
+		m_vertexEnd += mesh->vertexCount;
+		m_indexEnd += mesh->indexCount;
+	}
+
+	uint32_t vertexSize = m_vertexBufferLayout->GetSize();
+	glNamedBufferSubData(gl_vertexBuffer, (GLintptr)allocation.baseVertex * vertexSize, (GLsizeiptr)mesh->vertexCount * vertexSize, mesh->vertexBuffer);
+	if (m_indexSize == sizeof(uint32_t))
+		glNamedBufferSubData(gl_indexBuffer, (GLintptr)allocation.firstIndex * sizeof(uint32_t), (GLsizeiptr)mesh->indexCount * sizeof(uint32_t), mesh->indexBuffer);
+	else
+	{
+		std::vector<uint16_t> shortIndices(mesh->indexBuffer, mesh->indexBuffer + mesh->indexCount);
+		glNamedBufferSubData(gl_indexBuffer, (GLintptr)allocation.firstIndex * sizeof(uint16_t), (GLsizeiptr)mesh->indexCount * sizeof(uint16_t), shortIndices.data());
+	}
+	RendererStats::Upload(RendererStats::UploadSite::MeshGeometry, (uint64_t)mesh->vertexCount * vertexSize + (uint64_t)mesh->indexCount * m_indexSize);
+
+	m_allocations[id] = allocation;
+	return m_allocations[id];
+}
+
+void sf::GlGeometryArena::Remove(uint32_t id)
+{
+	assert(Contains(id));
+	const Allocation& allocation = m_allocations[id];
+	FreeRangeAndCoalesce(m_freeVertexRanges, m_freeVertexCount, m_vertexEnd, allocation.baseVertex, allocation.vertexCount);
+	FreeRangeAndCoalesce(m_freeIndexRanges, m_freeIndexCount, m_indexEnd, allocation.firstIndex, allocation.indexCount);
+	m_allocations.erase(id);
+
+	if ((m_freeVertexCount > COMPACTION_MIN_FREE_VERTICES && m_freeVertexCount > m_vertexEnd / 2) ||
+		(m_freeIndexCount > COMPACTION_MIN_FREE_INDICES && m_freeIndexCount > m_indexEnd / 2))
+		Compact();
+}
+
+void sf::GlGeometryArena::Compact()
+{
+	Rebuild(m_vertexCapacity, m_indexCapacity);
+}
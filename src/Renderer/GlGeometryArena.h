@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <BufferLayout.h>
+#include <MeshData.h>
+
+namespace sf {
+
+	/*
+	 * Suballocates every mesh sharing a vertex buffer layout into one vertex buffer and one index buffer
+	 * so they can all be drawn with the same vao. Indices are stored relative to each mesh and drawn
+	 * with a base vertex. Freed ranges go to a free list and the buffers get compacted when too much
+	 * of them is holes. Arenas created with 16 bit indices only take meshes with less than 65536 vertices,
+	 * their indices are narrowed when uploaded.
+	 */
+	class GlGeometryArena
+	{
+	public:
+		struct Allocation
+		{
+			uint32_t baseVertex;
+			uint32_t vertexCount;
+			uint32_t firstIndex;
+			uint32_t indexCount;
+		};
+
+	private:
+		struct FreeRange
+		{
+			uint32_t offset;
+			uint32_t count;
+		};
+
+		const BufferLayout* m_vertexBufferLayout = nullptr;
+		uint32_t m_indexSize = sizeof(uint32_t);
+		uint32_t m_glIndexType = 0;
+		uint32_t m_vertexCapacity = 0;
+		uint32_t m_indexCapacity = 0;
+		uint32_t m_vertexEnd = 0;
+		uint32_t m_indexEnd = 0;
+		uint32_t m_freeVertexCount = 0;
+		uint32_t m_freeIndexCount = 0;
+		std::vector<FreeRange> m_freeVertexRanges;
+		std::vector<FreeRange> m_freeIndexRanges;
+		std::unordered_map<uint32_t, Allocation> m_allocations;
+
+		static bool AllocateRange(std::vector<FreeRange>& freeRanges, uint32_t& freeCount, uint32_t& end, uint32_t capacity, uint32_t count, uint32_t& outOffset);
+		static void FreeRangeAndCoalesce(std::vector<FreeRange>& freeRanges, uint32_t& freeCount, uint32_t& end, uint32_t offset, uint32_t count);
+		void Rebuild(uint32_t vertexCapacity, uint32_t indexCapacity);
+		void SetUpVertexArray();
+
+	public:
+		bool isInitialized = false;
+		uint32_t gl_vao;
+		uint32_t gl_vertexBuffer;
+		uint32_t gl_indexBuffer;
+
+		/* indexType is DataType::u32 or DataType::u16 */
+		void Create(const BufferLayout* vertexBufferLayout, DataType indexType = DataType::u32, uint32_t vertexCapacity = 1 << 16, uint32_t indexCapacity = 1 << 18);
+		void Delete();
+
+		/* Allocations are keyed by an id chosen by the caller, so the mesh can be gone before it is removed */
+		const Allocation& Add(uint32_t id, const MeshData* mesh);
+		void Remove(uint32_t id);
+		void Compact();
+
+		inline bool Contains(uint32_t id) const { return m_allocations.find(id) != m_allocations.end(); }
+		inline const Allocation& Get(uint32_t id) const { return m_allocations.at(id); }
+		inline uint32_t GetVertexCapacity() const { return m_vertexCapacity; }
+		inline uint32_t GetIndexCapacity() const { return m_indexCapacity; }
+		/* Bytes per index and the gl type to draw with */
+		inline uint32_t GetIndexSize() const { return m_indexSize; }
+		inline uint32_t GetGlIndexType() const { return m_glIndexType; }
+	};
+}
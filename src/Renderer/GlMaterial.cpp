@@ -1,20 +1,92 @@
 #include "GlMaterial.h"
 
 #include <iostream>
+#include <unordered_set>
 
 #include <Renderer/GlTexture.h>
 #include <Renderer/GlCubemap.h>
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
 
-void sf::GlMaterial::Create(const Material* material, const BufferLayout* vertexBufferLayout)
+namespace sf {
+	uint32_t glMaterialIdCounter = 0;
+	std::vector<uint64_t> zeroUniformData;
+
+	bool IsValueUniformType(uint32_t glType)
+	{
+		switch (glType)
+		{
+		case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+		case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+		case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+		case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+		case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+		case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+		case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+			return true;
+		default: // samplers and images
+			return false;
+		}
+	}
+
+	/* Uniforms start as zero after linking, this puts one back to that value */
+	void WriteZeroUniform(int location, uint32_t glType, int arraySize)
+	{
+		if (zeroUniformData.size() < (size_t)(8 * arraySize)) // largest types are mat4 and dvec4, 64 bytes
+			zeroUniformData.resize(8 * arraySize, 0);
+		const float* f = (const float*)zeroUniformData.data();
+		const int32_t* i = (const int32_t*)zeroUniformData.data();
+		const uint32_t* u = (const uint32_t*)zeroUniformData.data();
+		const double* d = (const double*)zeroUniformData.data();
+		switch (glType)
+		{
+		case GL_FLOAT: glUniform1fv(location, arraySize, f); break;
+		case GL_FLOAT_VEC2: glUniform2fv(location, arraySize, f); break;
+		case GL_FLOAT_VEC3: glUniform3fv(location, arraySize, f); break;
+		case GL_FLOAT_VEC4: glUniform4fv(location, arraySize, f); break;
+		case GL_DOUBLE: glUniform1dv(location, arraySize, d); break;
+		case GL_DOUBLE_VEC2: glUniform2dv(location, arraySize, d); break;
+		case GL_DOUBLE_VEC3: glUniform3dv(location, arraySize, d); break;
+		case GL_DOUBLE_VEC4: glUniform4dv(location, arraySize, d); break;
+		case GL_BOOL:
+		case GL_INT: glUniform1iv(location, arraySize, i); break;
+		case GL_BOOL_VEC2:
+		case GL_INT_VEC2: glUniform2iv(location, arraySize, i); break;
+		case GL_BOOL_VEC3:
+		case GL_INT_VEC3: glUniform3iv(location, arraySize, i); break;
+		case GL_BOOL_VEC4:
+		case GL_INT_VEC4: glUniform4iv(location, arraySize, i); break;
+		case GL_UNSIGNED_INT: glUniform1uiv(location, arraySize, u); break;
+		case GL_UNSIGNED_INT_VEC2: glUniform2uiv(location, arraySize, u); break;
+		case GL_UNSIGNED_INT_VEC3: glUniform3uiv(location, arraySize, u); break;
+		case GL_UNSIGNED_INT_VEC4: glUniform4uiv(location, arraySize, u); break;
+		case GL_FLOAT_MAT2: glUniformMatrix2fv(location, arraySize, GL_FALSE, f); break;
+		case GL_FLOAT_MAT3: glUniformMatrix3fv(location, arraySize, GL_FALSE, f); break;
+		case GL_FLOAT_MAT4: glUniformMatrix4fv(location, arraySize, GL_FALSE, f); break;
+		case GL_FLOAT_MAT2x3: glUniformMatrix2x3fv(location, arraySize, GL_FALSE, f); break;
+		case GL_FLOAT_MAT2x4: glUniformMatrix2x4fv(location, arraySize, GL_FALSE, f); break;
+		case GL_FLOAT_MAT3x2: glUniformMatrix3x2fv(location, arraySize, GL_FALSE, f); break;
+		case GL_FLOAT_MAT3x4: glUniformMatrix3x4fv(location, arraySize, GL_FALSE, f); break;
+		case GL_FLOAT_MAT4x2: glUniformMatrix4x2fv(location, arraySize, GL_FALSE, f); break;
+		case GL_FLOAT_MAT4x3: glUniformMatrix4x3fv(location, arraySize, GL_FALSE, f); break;
+		default:
+			assert(!"Data type not handled");
+			break;
+		}
+	}
+}
+
+void sf::GlMaterial::Create(const Material* material, const BufferLayout* vertexBufferLayout, bool waitForShader)
 {
+	m_id = glMaterialIdCounter++;
 	m_material = material;
 	assert(m_material != nullptr);
 	assert((m_material->vertShaderFilePath.length() > 0 || m_material->meshShaderFilePath.length() > 0) &&
 		   (m_material->fragShaderFilePath.length() > 0));
-	m_shader = new GlShader();
-	m_shader->Create(*m_material, vertexBufferLayout);
+	m_shader = GlShader::AcquireShared(*m_material, vertexBufferLayout);
+	m_finished = false;
 
-	for (const std::pair<std::string, Uniform>& uniformPair : m_material->uniforms)
+	for (const std::pair<std::string, Uniform>& uniformPair : m_material->GetUniforms())
 	{
 		if (uniformPair.second.dataType == DataType::bitmap)
 		{
@@ -32,27 +104,126 @@ void sf::GlMaterial::Create(const Material* material, const BufferLayout* vertex
 		glGenBuffers(1, &newSsbo);
 		glBindBuffer(GL_SHADER_STORAGE_BUFFER, newSsbo);
 		glBufferData(GL_SHADER_STORAGE_BUFFER, m_material->buffers[i].size, m_material->buffers[i].pointer, GL_STATIC_DRAW);
+		RendererStats::Upload(RendererStats::UploadSite::MaterialBuffers, m_material->buffers[i].size);
+		RendererStats::TrackMemory(RendererStats::MemoryCategory::StorageBuffers, newSsbo, m_material->buffers[i].size);
 		m_ssbos[m_material->buffers[i].pointer] = newSsbo;
 	}
+
+	if (waitForShader)
+		Finish();
+}
+
+void sf::GlMaterial::Finish()
+{
+	if (m_finished)
+		return;
+	m_shader->FinishCreate();
+	BuildBindingTable();
+	m_finished = true;
+}
+
+void sf::GlMaterial::Delete()
+{
+	GlShader::ReleaseShared(m_shader);
+	m_shader = nullptr;
+
+	for (auto& pair : m_textures)
+	{
+		GlTexture* texture = (GlTexture*)pair.second;
+		texture->Delete();
+		delete texture;
+	}
+	m_textures.clear();
+
+	for (auto& pair : m_ssbos)
+	{
+		GlState::ForgetBuffer(pair.second);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::StorageBuffers, pair.second);
+		glDeleteBuffers(1, &pair.second);
+	}
+	m_ssbos.clear();
+	m_uniformBindings.clear();
+	m_defaultBindings.clear();
+	m_boundUniformRevision = ~0u;
+	m_finished = false;
+}
+
+void sf::GlMaterial::BuildBindingTable()
+{
+	m_uniformBindings.clear();
+
+	for (const std::pair<const std::string, Uniform>& uniformPair : m_material->GetUniforms())
+	{
+		int location = m_shader->GetUniformLocation(uniformPair.first);
+		if (location == -1)
+			continue;
+		UniformBinding binding = { location, -1, uniformPair.second.dataType, &uniformPair.second, -1, nullptr, nullptr };
+		if (binding.dataType == DataType::bitmap || binding.dataType == DataType::cubemap)
+		{
+			binding.textureIndex = m_shader->GetOrAssignTextureIndex(uniformPair.first);
+			glProgramUniform1i(m_shader->gl_id, location, binding.textureIndex);
+			// bitmaps set after creation also need a texture
+			if (binding.dataType == DataType::bitmap && uniformPair.second.data.p != nullptr && m_textures.find(uniformPair.second.data.p) == m_textures.end())
+			{
+				GlTexture* newTexture = new GlTexture();
+				newTexture->CreateFromBitmap(*((Bitmap*)uniformPair.second.data.p));
+				m_textures[uniformPair.second.data.p] = newTexture;
+			}
+			binding.source = uniformPair.second.data.p;
+			binding.texture = binding.source == nullptr ? nullptr : m_textures[binding.source];
+		}
+		m_uniformBindings.push_back(binding);
+	}
+
+	for (const std::pair<const std::string, RendererUniform>& uniformPair : m_material->GetRendererUniforms())
+	{
+		int location = m_shader->GetUniformLocation(uniformPair.first);
+		if (location == -1)
+			continue;
+		assert(uniformPair.second.dataType == DataType::bitmap || uniformPair.second.dataType == DataType::cubemap);
+		UniformBinding binding = { location, m_shader->GetOrAssignTextureIndex(uniformPair.first), uniformPair.second.dataType, nullptr, (int32_t)uniformPair.second.data, nullptr, nullptr };
+		glProgramUniform1i(m_shader->gl_id, location, binding.textureIndex);
+		m_uniformBindings.push_back(binding);
+	}
+
+	// the program is shared, anything this material leaves out could still hold another material's value
+	m_defaultBindings.clear();
+	std::unordered_set<int> boundLocations;
+	for (const UniformBinding& binding : m_uniformBindings)
+		boundLocations.insert(binding.location);
+	for (uint32_t i = 0; i < (uint32_t)BuiltinUniform::Count; i++)
+		boundLocations.insert(m_shader->GetBuiltinUniformLocation((BuiltinUniform)i));
+	for (const std::pair<const std::string, ShaderUniformData>& uniformPair : m_shader->m_uniformCache)
+	{
+		if (uniformPair.second.location == -1 || !boundLocations.insert(uniformPair.second.location).second)
+			continue; // inactive, already set or the alias of an array
+		DefaultBinding binding = { uniformPair.second.location, -1, uniformPair.second.type, uniformPair.second.arraySize };
+		if (!IsValueUniformType(binding.glType))
+		{
+			binding.textureIndex = m_shader->GetOrAssignTextureIndex(uniformPair.first);
+			glProgramUniform1i(m_shader->gl_id, binding.location, binding.textureIndex);
+		}
+		m_defaultBindings.push_back(binding);
+	}
+	m_shader->m_lastMaterialId = ~0u;
+
+	m_boundUniformRevision = m_material->GetUniformRevision();
 }
 
 void sf::GlMaterial::Bind(const std::vector<void*>& rendererUniformVector)
 {
-	if (m_material->isDoubleSided)
-		glDisable(GL_CULL_FACE);
-	else
-		glEnable(GL_CULL_FACE);
+	GlState::SetEnabled(GL_CULL_FACE, !m_material->isDoubleSided);
 
 	switch (m_material->drawMode)
 	{
 	case MaterialDrawMode::Fill:
-		glPolygonMode(GL_FRONT, GL_FILL);
+		GlState::PolygonMode(GL_FRONT, GL_FILL);
 		break;
 	case MaterialDrawMode::Lines:
-		glPolygonMode(GL_FRONT, GL_LINE);
+		GlState::PolygonMode(GL_FRONT, GL_LINE);
 		break;
 	case MaterialDrawMode::Points:
-		glPolygonMode(GL_FRONT, GL_POINT);
+		GlState::PolygonMode(GL_FRONT, GL_POINT);
 		break;
 	default:
 		assert(!"Invalid draw mode");
@@ -62,16 +233,16 @@ void sf::GlMaterial::Bind(const std::vector<void*>& rendererUniformVector)
 	switch (m_material->blendMode)
 	{
 	case MaterialBlendMode::Alpha:
-		glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
+		GlState::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+		GlState::BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
 		break;
 	case MaterialBlendMode::Multiply:
-		glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-		glBlendFuncSeparate(GL_DST_COLOR, GL_ZERO, GL_ONE, GL_ONE);
+		GlState::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+		GlState::BlendFuncSeparate(GL_DST_COLOR, GL_ZERO, GL_ONE, GL_ONE);
 		break;
 	case MaterialBlendMode::Add:
-		glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-		glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
+		GlState::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+		GlState::BlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
 		break;
 	default:
 		assert(!"Invalid blend mode");
@@ -80,77 +251,67 @@ void sf::GlMaterial::Bind(const std::vector<void*>& rendererUniformVector)
 
 	m_shader->Bind();
 
-	for (const std::pair<std::string, Uniform>& uniform : m_material->uniforms)
+	if (m_material->GetUniformRevision() != m_boundUniformRevision)
+		BuildBindingTable();
+
+	for (UniformBinding& binding : m_uniformBindings)
 	{
-		int uniformTextureIndex;
-		switch (uniform.second.dataType)
+		switch (binding.dataType)
 		{
 		case DataType::bitmap:
-			uniformTextureIndex = m_shader->GetOrAssignTextureIndex(uniform.first);
-			if (uniform.second.data.p == nullptr) // clear uniform if not provided
-			{
-				glActiveTexture(GL_TEXTURE0 + uniformTextureIndex);
-				glBindTexture(GL_TEXTURE_2D, 0);
-				m_shader->SetUniform1i(uniform.first, uniformTextureIndex);
-			}
-			else
-			{
-				GlTexture* texture = (GlTexture*)m_textures[uniform.second.data.p];
-				texture->Bind(uniformTextureIndex);
-				m_shader->SetUniform1i(uniform.first, uniformTextureIndex);
-			}
-			break;
 		case DataType::cubemap:
-			uniformTextureIndex = m_shader->GetOrAssignTextureIndex(uniform.first);
-			if (uniform.second.data.p == nullptr) // clear uniform if not provided
+		{
+			void* source = binding.uniform != nullptr ? binding.uniform->data.p : rendererUniformVector[binding.rendererUniformIndex];
+			if (binding.uniform != nullptr && source != binding.source)
 			{
-				glActiveTexture(GL_TEXTURE0 + uniformTextureIndex);
-				glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-				m_shader->SetUniform1i(uniform.first, uniformTextureIndex);
+				binding.source = source;
+				binding.texture = source == nullptr ? nullptr : m_textures[source];
 			}
+			void* texture = binding.uniform != nullptr ? binding.texture : source;
+			if (texture == nullptr) // clear uniform if not provided
+				GlState::BindTexture(binding.textureIndex, 0);
+			else if (binding.dataType == DataType::bitmap)
+				((GlTexture*)texture)->Bind(binding.textureIndex);
 			else
-			{
-				GlCubemap* cubemap = (GlCubemap*)m_textures[uniform.second.data.p];
-				cubemap->Bind(uniformTextureIndex);
-				m_shader->SetUniform1i(uniform.first, uniformTextureIndex);
-			}
+				((GlCubemap*)texture)->Bind(binding.textureIndex);
 			break;
+		}
 		case DataType::b:
 		case DataType::f32:
-			m_shader->SetUniform1f(uniform.first, uniform.second.data.f32);
+			glUniform1f(binding.location, binding.uniform->data.f32);
 			break;
 		case DataType::i32:
-			m_shader->SetUniform1i(uniform.first, uniform.second.data.i32);
+			glUniform1i(binding.location, binding.uniform->data.i32);
 			break;
 		case DataType::u32:
-			m_shader->SetUniform1u(uniform.first, uniform.second.data.u32);
+			glUniform1ui(binding.location, binding.uniform->data.u32);
 			break;
 		case DataType::vec2f32:
-			m_shader->SetUniform2fv(uniform.first, (float*)uniform.second.data.p);
+			glUniform2fv(binding.location, 1, (float*)binding.uniform->data.p);
 			break;
 		case DataType::vec3f32:
-			m_shader->SetUniform3fv(uniform.first, (float*)uniform.second.data.p);
+			glUniform3fv(binding.location, 1, (float*)binding.uniform->data.p);
 			break;
 		case DataType::vec4f32:
-			m_shader->SetUniform4fv(uniform.first, (float*)uniform.second.data.p);
+			glUniform4fv(binding.location, 1, (float*)binding.uniform->data.p);
 			break;
 		case DataType::vec2i32:
-			m_shader->SetUniform2iv(uniform.first, (int32_t*)uniform.second.data.p);
+			glUniform2iv(binding.location, 1, (int32_t*)binding.uniform->data.p);
 			break;
 		case DataType::vec3i32:
-			m_shader->SetUniform3iv(uniform.first, (int32_t*)uniform.second.data.p);
+			glUniform3iv(binding.location, 1, (int32_t*)binding.uniform->data.p);
 			break;
 		case DataType::vec4i32:
-			m_shader->SetUniform4iv(uniform.first, (int32_t*)uniform.second.data.p);
+			glUniform4iv(binding.location, 1, (int32_t*)binding.uniform->data.p);
 			break;
 		case DataType::vec2u32:
-			m_shader->SetUniform2uiv(uniform.first, (uint32_t*)uniform.second.data.p);
+			glUniform2uiv(binding.location, 1, (uint32_t*)binding.uniform->data.p);
 			break;
 		case DataType::vec3u32:
-			m_shader->SetUniform3uiv(uniform.first, (uint32_t*)uniform.second.data.p);
+			glUniform3uiv(binding.location, 1, (uint32_t*)binding.uniform->data.p);
 			break;
 		case DataType::vec4u32:
-			m_shader->SetUniform4uiv(uniform.first, (uint32_t*)uniform.second.data.p);
+			glUniform4uiv(binding.location, 1, (uint32_t*)binding.uniform->data.p);
 			break;
 		default:
 			assert(!"Data type not handled");
@@ -158,61 +319,38 @@ void sf::GlMaterial::Bind(const std::vector<void*>& rendererUniformVector)
 		}
 	}
 
-	for (const std::pair<std::string, RendererUniform>& uniform : m_material->rendererUniforms)
+	bool programHoldsOtherValues = m_shader->m_lastMaterialId != m_id;
+	m_shader->m_lastMaterialId = m_id;
+	for (const DefaultBinding& binding : m_defaultBindings)
 	{
-		int uniformTextureIndex;
-		switch (uniform.second.dataType)
-		{
-		case DataType::bitmap:
-			uniformTextureIndex = m_shader->GetOrAssignTextureIndex(uniform.first);
-			if (rendererUniformVector[(uint32_t)uniform.second.data] == nullptr) // clear uniform if not provided
-			{
-				glActiveTexture(GL_TEXTURE0 + uniformTextureIndex);
-				glBindTexture(GL_TEXTURE_2D, 0);
-				m_shader->SetUniform1i(uniform.first, uniformTextureIndex);
-			}
-			else
-			{
-				GlTexture* texture = (GlTexture*)rendererUniformVector[(uint32_t)uniform.second.data];
-				texture->Bind(uniformTextureIndex);
-				m_shader->SetUniform1i(uniform.first, uniformTextureIndex);
-			}
-			break;
-		case DataType::cubemap:
-			uniformTextureIndex = m_shader->GetOrAssignTextureIndex(uniform.first);
-			if (rendererUniformVector[(uint32_t)uniform.second.data] == nullptr) // clear uniform if not provided
-			{
-				glActiveTexture(GL_TEXTURE0 + uniformTextureIndex);
-				glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-				m_shader->SetUniform1i(uniform.first, uniformTextureIndex);
-			}
-			else
-			{
-				GlCubemap* cubemap = (GlCubemap*)rendererUniformVector[(uint32_t)uniform.second.data];
-				cubemap->Bind(uniformTextureIndex);
-				m_shader->SetUniform1i(uniform.first, uniformTextureIndex);
-			}
-			break;
-		default:
-			assert(!"Data type not handled");
-			break;
-		}
+		if (binding.textureIndex != -1)
+			GlState::BindTexture(binding.textureIndex, 0);
+		else if (programHoldsOtherValues)
+			WriteZeroUniform(binding.location, binding.glType, binding.arraySize);
 	}
 
 	for (int i = 0; i < m_material->buffers.size(); i++)
 	{
 		if (m_material->buffers[i].pointer == nullptr)
 			continue;
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, m_ssbos[m_material->buffers[i].pointer]);
+		GlState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, i, m_ssbos[m_material->buffers[i].pointer]);
 	}
 }
 
 void sf::GlMaterial::UpdateBufferData(uint32_t bufferIndex, uint32_t location, uint32_t size)
 {
 	assert(bufferIndex < m_material->buffers.size());
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssbos[m_material->buffers[bufferIndex].pointer]);
+	uint32_t ssbo = m_ssbos[m_material->buffers[bufferIndex].pointer];
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
 	if (location != ~0)
+	{
 		glBufferSubData(GL_SHADER_STORAGE_BUFFER, location, size, (uint8_t*) m_material->buffers[bufferIndex].pointer + location);
+		RendererStats::Upload(RendererStats::UploadSite::MaterialBuffers, size);
+	}
 	else
+	{
 		glBufferData(GL_SHADER_STORAGE_BUFFER, m_material->buffers[bufferIndex].size, m_material->buffers[bufferIndex].pointer, GL_STATIC_DRAW);
+		RendererStats::Upload(RendererStats::UploadSite::MaterialBuffers, m_material->buffers[bufferIndex].size);
+		RendererStats::TrackMemory(RendererStats::MemoryCategory::StorageBuffers, ssbo, m_material->buffers[bufferIndex].size);
+	}
 }
\ No newline at end of file
@@ -13,13 +13,46 @@ namespace sf {
 	struct GlMaterial
 	{
 		GlShader* m_shader;
+		uint32_t m_id;
 	private:
+		/* One entry per active uniform, built from the shader reflection so binding needs no name lookups */
+		struct UniformBinding
+		{
+			int location;
+			int textureIndex;
+			DataType dataType;
+			const Uniform* uniform; // null for renderer uniforms
+			int32_t rendererUniformIndex;
+			void* source; // bitmap the cached texture was resolved from
+			void* texture;
+		};
+
+		/* Active uniform of the shared program this material doesn't set, reset to zero when the program was last bound by another material */
+		struct DefaultBinding
+		{
+			int location;
+			int textureIndex; // -1 unless it's a sampler
+			uint32_t glType;
+			int arraySize;
+		};
+
 		const Material* m_material;
 		std::unordered_map<void*, void*> m_textures;
 		std::unordered_map<void*, uint32_t> m_ssbos;
+		std::vector<UniformBinding> m_uniformBindings;
+		std::vector<DefaultBinding> m_defaultBindings;
+		uint32_t m_boundUniformRevision = ~0u;
+		bool m_finished = false;
+
+		void BuildBindingTable();
 
 	public:
-		void Create(const Material* material, const BufferLayout* vertexBufferLayout);
+		/* Without waitForShader the program may still be compiling, Finish must be called before binding */
+		void Create(const Material* material, const BufferLayout* vertexBufferLayout, bool waitForShader = true);
+		inline bool IsReady() const { return m_finished || m_shader->IsReady(); }
+		inline bool IsFinished() const { return m_finished; }
+		void Finish();
+		void Delete();
 		void Bind(const std::vector<void*>& rendererUniformVector);
 		void UpdateBufferData(uint32_t bufferIndex, uint32_t location = ~0, uint32_t size = ~0);
 	};
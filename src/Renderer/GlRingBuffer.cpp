@@ -0,0 +1,130 @@
+#include "GlRingBuffer.h"
+
+#include <iostream>
+#include <cassert>
+
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
+
+#define REGION_ALIGNMENT 256
+#define FENCE_WAIT_TIMEOUT 1000000000 // 1 second in nanoseconds
+
+void sf::GlRingBuffer::CreateStorage(uint32_t bytesPerFrame)
+{
+	m_bytesPerFrame = ((bytesPerFrame + REGION_ALIGNMENT - 1) / REGION_ALIGNMENT) * REGION_ALIGNMENT;
+	m_currentOffset = 0;
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &gl_id);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, gl_id);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)m_bytesPerFrame * GL_RING_BUFFER_FRAME_COUNT, nullptr, flags);
+	m_mappedPointer = (uint8_t*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)m_bytesPerFrame * GL_RING_BUFFER_FRAME_COUNT, flags);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	assert(m_mappedPointer != nullptr);
+	RendererStats::TrackMemory(RendererStats::MemoryCategory::StorageBuffers, gl_id, (uint64_t)m_bytesPerFrame * GL_RING_BUFFER_FRAME_COUNT);
+}
+
+void sf::GlRingBuffer::Create(uint32_t bytesPerFrame)
+{
+	assert(!isInitialized);
+	CreateStorage(bytesPerFrame);
+	m_currentFrame = 0;
+	isInitialized = true;
+}
+
+void sf::GlRingBuffer::Delete()
+{
+	if (!isInitialized)
+		return;
+
+	for (uint32_t i = 0; i < GL_RING_BUFFER_FRAME_COUNT; i++)
+	{
+		if (m_fences[i] != nullptr)
+			glDeleteSync(m_fences[i]);
+		m_fences[i] = nullptr;
+	}
+	for (const RetiredBuffer& retiredBuffer : m_retiredBuffers)
+	{
+		GlState::ForgetBuffer(retiredBuffer.gl_id);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::StorageBuffers, retiredBuffer.gl_id);
+		glDeleteBuffers(1, &retiredBuffer.gl_id);
+	}
+	m_retiredBuffers.clear();
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, gl_id);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	GlState::ForgetBuffer(gl_id);
+	RendererStats::ReleaseMemory(RendererStats::MemoryCategory::StorageBuffers, gl_id);
+	glDeleteBuffers(1, &gl_id);
+	m_mappedPointer = nullptr;
+	isInitialized = false;
+}
+
+void sf::GlRingBuffer::BeginFrame()
+{
+	m_currentFrame = (m_currentFrame + 1) % GL_RING_BUFFER_FRAME_COUNT;
+	m_currentOffset = 0;
+
+	// wait until the gpu is done with the region we are about to overwrite
+	if (m_fences[m_currentFrame] != nullptr)
+	{
+		GLenum result = glClientWaitSync(m_fences[m_currentFrame], 0, 0);
+		while (result == GL_TIMEOUT_EXPIRED)
+			result = glClientWaitSync(m_fences[m_currentFrame], GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT);
+		assert(result != GL_WAIT_FAILED);
+		glDeleteSync(m_fences[m_currentFrame]);
+		m_fences[m_currentFrame] = nullptr;
+	}
+
+	// buffers replaced by a bigger one are only deleted once every frame that used them is done
+	for (int i = (int)m_retiredBuffers.size() - 1; i > -1; i--)
+	{
+		m_retiredBuffers[i].framesLeft--;
+		if (m_retiredBuffers[i].framesLeft > 0)
+			continue;
+		GlState::ForgetBuffer(m_retiredBuffers[i].gl_id);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::StorageBuffers, m_retiredBuffers[i].gl_id);
+		glDeleteBuffers(1, &m_retiredBuffers[i].gl_id);
+		m_retiredBuffers.erase(m_retiredBuffers.begin() + i);
+	}
+}
+
+void sf::GlRingBuffer::EndFrame()
+{
+	assert(m_fences[m_currentFrame] == nullptr);
+	m_fences[m_currentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+sf::GlRingBuffer::Allocation sf::GlRingBuffer::Allocate(uint32_t size, uint32_t alignment)
+{
+	assert(isInitialized);
+	assert(alignment <= REGION_ALIGNMENT);
+
+	uint32_t alignedOffset = ((m_currentOffset + alignment - 1) / alignment) * alignment;
+	if (alignedOffset + size > m_bytesPerFrame)
+	{
+		// out of space for this frame, move to a bigger buffer and keep the old one alive until the gpu is done with it
+		uint32_t newBytesPerFrame = m_bytesPerFrame * 2 > size ? m_bytesPerFrame * 2 : size;
+		std::cout << "[GlRingBuffer] Growing from " << m_bytesPerFrame << " to " << newBytesPerFrame << " bytes per frame" << std::endl;
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, gl_id);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		m_retiredBuffers.push_back({ gl_id, GL_RING_BUFFER_FRAME_COUNT });
+		for (uint32_t i = 0; i < GL_RING_BUFFER_FRAME_COUNT; i++)
+		{
+			if (m_fences[i] != nullptr)
+				glDeleteSync(m_fences[i]);
+			m_fences[i] = nullptr;
+		}
+
+		CreateStorage(newBytesPerFrame);
+		alignedOffset = 0;
+	}
+
+	m_currentOffset = alignedOffset + size;
+	RendererStats::Upload(RendererStats::UploadSite::FrameRingBuffer, size);
+	uint32_t offset = m_currentFrame * m_bytesPerFrame + alignedOffset;
+	return { gl_id, offset, m_mappedPointer + offset };
+}
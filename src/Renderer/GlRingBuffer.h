@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glad/glad.h>
+
+#define GL_RING_BUFFER_FRAME_COUNT 3
+
+namespace sf {
+
+	/*
+	 * Persistently mapped buffer split in one region per frame in flight.
+	 * Each frame writes into its own region and fences it when done, so the cpu
+	 * only waits if it gets GL_RING_BUFFER_FRAME_COUNT frames ahead of the gpu.
+	 */
+	class GlRingBuffer
+	{
+	public:
+		struct Allocation
+		{
+			uint32_t gl_buffer;
+			uint32_t offset;
+			void* pointer;
+		};
+
+	private:
+		struct RetiredBuffer
+		{
+			uint32_t gl_id;
+			uint32_t framesLeft;
+		};
+
+		uint32_t m_bytesPerFrame = 0;
+		uint32_t m_currentFrame = 0;
+		uint32_t m_currentOffset = 0;
+		uint8_t* m_mappedPointer = nullptr;
+		GLsync m_fences[GL_RING_BUFFER_FRAME_COUNT] = { nullptr };
+		std::vector<RetiredBuffer> m_retiredBuffers;
+
+		void CreateStorage(uint32_t bytesPerFrame);
+
+	public:
+		bool isInitialized = false;
+		uint32_t gl_id;
+
+		void Create(uint32_t bytesPerFrame);
+		void Delete();
+
+		void BeginFrame();
+		void EndFrame();
+
+		Allocation Allocate(uint32_t size, uint32_t alignment);
+	};
+}
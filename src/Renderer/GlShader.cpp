@@ -7,8 +7,43 @@
 #include <cassert>
 #include <cstring>
 
+#include <Hash.h>
+#include <FileUtils.h>
+#include <VertexFormat.h>
+#include <Renderer/GlState.h>
+
+#define SHADER_CACHE_FOLDER "shadercache"
+#define SHADER_CACHE_MAGIC 0x48435366 // "fSCH"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+bool sf::GlShader::parallelCompileSupported = false;
+sf::SkinningFormat sf::GlShader::skinningFormat = sf::SkinningFormat::Matrix3x4;
+
+namespace sf {
+	std::unordered_map<uint64_t, GlShader*> sharedShaders;
+	uint32_t sharedShaderIdCounter = 0;
+}
+
 namespace
 {
+	struct ProgramBinaryHeader
+	{
+		uint32_t magic;
+		uint32_t format;
+		uint32_t length;
+	};
+
+	const char* builtinUniformNames[(uint32_t)sf::BuiltinUniform::Count] = {
+		"PARTICLE_CYCLE_TIME",
+		"PARTICLE_LIFETIME",
+		"PARTICLE_ACCELERATION",
+		"bitmap",
+		"atlas"
+	};
+
 	void ResolveIncludes(std::string& shaderSource)
 	{
 		for (int i = 0; i < shaderSource.length(); i++)
@@ -36,20 +71,29 @@ namespace
 			if (isVertexShader)
 			{
 				out += "layout(location = " + std::to_string(currentLocation) + ") in ";
-				switch (bci.dataType)
+				// compact types are unpacked by the vertex fetch, only integer and octahedral ones change the declaration
+				bool isInteger = sf::VertexFormat::IsInteger(bci.component, bci.dataType);
+				switch (sf::VertexFormat::GetShaderComponentCount(bci.component, bci.dataType))
 				{
-					case sf::DataType::f32:
-						out += "float"; break;
-					case sf::DataType::vec2f32:
-						out += "vec2"; break;
-					case sf::DataType::vec3f32:
-						out += "vec3"; break;
-					case sf::DataType::vec4f32:
-						out += "vec4"; break;
+					case 1:
+						out += isInteger ? "uint" : "float"; break;
+					case 2:
+						out += isInteger ? "uvec2" : "vec2"; break;
+					case 3:
+						out += isInteger ? "uvec3" : "vec3"; break;
+					case 4:
+						out += isInteger ? "uvec4" : "vec4"; break;
 					default:
 						assert(!"Missing type, should add to this switch");
 				}
 				out += " ";
+				if (sf::VertexFormat::IsOctahedral(bci.component, bci.dataType))
+				{
+					const char* name = bci.component == sf::BufferComponent::Normal ? "VA_Normal" : "VA_Tangent";
+					out += std::string(name) + "_Oct;\n#define " + name + " OctDecode(" + name + "_Oct)\n#define HAS_" + name + " 1\n";
+					currentLocation++;
+					continue;
+				}
 			}
 			switch (bci.component)
 			{
@@ -72,6 +116,36 @@ namespace
 			}
 			currentLocation++;
 		}
+		if (isVertexShader && out.find("OctDecode") != std::string::npos)
+		{
+			out = "vec3 OctDecode(vec2 e)\n{\n\tvec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n\tfloat t = max(-n.z, 0.0);\n"
+				"\tn.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));\n\treturn normalize(n);\n}\n" + out;
+		}
+		return out;
+	}
+
+	std::string GenerateInstanceDataShaderHeader()
+	{
+		/* Vertex shaders that use MODEL_MATRIX can be drawn instanced, the block is inactive otherwise */
+		std::string out = "";
+		out += "layout (std430, binding = " + std::to_string(INSTANCE_DATA_SSBO_BINDING) + ") readonly buffer " INSTANCE_DATA_BLOCK_NAME "\n";
+		out += "{\n\tmat4 INSTANCE_MODEL_MATRICES[];\n};\n";
+		out += "#define MODEL_MATRIX INSTANCE_MODEL_MATRICES[gl_BaseInstance + gl_InstanceID]\n";
+		/* Where the instance's bones start in the frame skinning data, see assets/shaders/skinning.h */
+		out += "layout (std430, binding = " + std::to_string(INSTANCE_SKINNING_SSBO_BINDING) + ") readonly buffer _InstanceSkinning\n";
+		out += "{\n\tuint INSTANCE_SKINNING_OFFSETS[];\n};\n";
+		out += "#define SKINNING_OFFSET INSTANCE_SKINNING_OFFSETS[gl_BaseInstance + gl_InstanceID]\n";
+		out += "layout (std430, binding = " + std::to_string(SKINNING_DATA_SSBO_BINDING) + ") readonly buffer _SkinningData\n";
+		out += "{\n\tvec4 SKINNING_DATA[];\n};\n";
+		switch (sf::GlShader::skinningFormat)
+		{
+		case sf::SkinningFormat::Matrix4x4:
+			out += "#define SKINNING_FORMAT_MATRIX4X4 1\n"; break;
+		case sf::SkinningFormat::Matrix3x4:
+			out += "#define SKINNING_FORMAT_MATRIX3X4 1\n"; break;
+		case sf::SkinningFormat::DualQuaternion:
+			out += "#define SKINNING_FORMAT_DUAL_QUATERNION 1\n"; break;
+		}
 		return out;
 	}
 
@@ -116,6 +190,12 @@ namespace
 						std::string(mb.name) + "[gl_InstanceID * " + std::to_string(stride) + " + " + std::to_string(baseOffset + 1) + "], " +
 						std::string(mb.name) + "[gl_InstanceID * " + std::to_string(stride) + " + " + std::to_string(baseOffset + 2) + "])\n";
 					break;
+				case sf::BufferComponent::Velocity:
+					out += "#define " + std::string(mb.name) + "_LOAD_VELOCITY vec3(" +
+						std::string(mb.name) + "[gl_InstanceID * " + std::to_string(stride) + " + " + std::to_string(baseOffset + 0) + "], " +
+						std::string(mb.name) + "[gl_InstanceID * " + std::to_string(stride) + " + " + std::to_string(baseOffset + 1) + "], " +
+						std::string(mb.name) + "[gl_InstanceID * " + std::to_string(stride) + " + " + std::to_string(baseOffset + 2) + "])\n";
+					break;
 				case sf::BufferComponent::Rotation:
 					out += "#define " + std::string(mb.name) + "_LOAD_ROTATION vec4(" +
 						std::string(mb.name) + "[gl_InstanceID * " + std::to_string(stride) + " + " + std::to_string(baseOffset + 0) + "], " +
@@ -172,8 +252,22 @@ uint32_t sf::GlShader::CheckLinkStatusAndReturnProgram(uint32_t program, bool ou
 	return 0;
 }
 
-uint32_t sf::GlShader::CompileShader(uint32_t type, const std::string& source)
+uint32_t sf::GlShader::StartCompileShader(uint32_t type, const std::string& source)
+{
+	uint32_t id = glCreateShader(type);
+	const char* src = source.c_str();
+	glShaderSource(id, 1, &src, nullptr);
+	glCompileShader(id);
+	return id;
+}
+
+bool sf::GlShader::CheckCompileStatus(uint32_t shader, uint32_t type)
 {
+	int result;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
+	if (result != GL_FALSE)
+		return true;
+
 	std::string messageType;
 	switch (type)
 	{
@@ -190,28 +284,110 @@ uint32_t sf::GlShader::CompileShader(uint32_t type, const std::string& source)
 		messageType = "unknown";
 		break;
 	}
-	uint32_t id = glCreateShader(type);
-	const char* src = source.c_str();
-	glShaderSource(id, 1, &src, nullptr);
-	glCompileShader(id);
+	int length;
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+	char* message = (char*)alloca(length * sizeof(char));
+	glGetShaderInfoLog(shader, length, &length, message);
+	std::cout << "[GlShader] Failed to compile " << messageType << " shader" << std::endl;
+	std::cout << message << std::endl;
+	return false;
+}
 
-	int result;
-	glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-	if (result == GL_FALSE)
+void sf::GlShader::ComputeProgramHash()
+{
+	// binaries are only valid for the driver that produced them
+	m_programHash = Hash::Fnv1a64(glGetString(GL_RENDERER), strlen((const char*)glGetString(GL_RENDERER)));
+	m_programHash = Hash::Fnv1a64(glGetString(GL_VERSION), strlen((const char*)glGetString(GL_VERSION)), m_programHash);
+	for (const StageSource& stage : m_pendingStages)
 	{
-		int length;
-		glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-		char* message = (char*)alloca(length * sizeof(char));
-		glGetShaderInfoLog(id, length, &length, message);
-		std::cout << "[GlShader] Failed to compile " << messageType << " shader" << std::endl;
-		std::cout << message << std::endl;
-		glDeleteShader(id);
-		return 0;
+		m_programHash = Hash::Fnv1a64(&stage.type, sizeof(stage.type), m_programHash);
+		m_programHash = Hash::Fnv1a64(stage.source.data(), stage.source.length(), m_programHash);
 	}
-	return id;
+}
+
+void sf::GlShader::BeginProgram()
+{
+	gl_id = glCreateProgram();
+	std::cout << "[GlShader] Created program with id " << gl_id << std::endl;
+	m_loadedFromCache = LoadProgramBinary();
+	if (!m_loadedFromCache)
+		CompileAndLinkPendingStages();
+}
+
+void sf::GlShader::CompileAndLinkPendingStages()
+{
+	glProgramParameteri(gl_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	for (StageSource& stage : m_pendingStages)
+	{
+		stage.gl_id = StartCompileShader(stage.type, stage.source);
+		glAttachShader(gl_id, stage.gl_id);
+	}
+	glLinkProgram(gl_id);
+}
+
+std::string sf::GlShader::GetProgramBinaryPath() const
+{
+	char fileName[17];
+	snprintf(fileName, sizeof(fileName), "%016llx", (unsigned long long)m_programHash);
+	return FileUtils::CombinePaths(SHADER_CACHE_FOLDER, std::string(fileName) + ".bin");
+}
+
+bool sf::GlShader::LoadProgramBinary()
+{
+	std::ifstream ifs(GetProgramBinaryPath(), std::ios::binary);
+	if (ifs.fail())
+		return false;
+	ProgramBinaryHeader header;
+	ifs.read((char*)&header, sizeof(header));
+	if (!ifs || header.magic != SHADER_CACHE_MAGIC)
+		return false;
+	std::vector<char> binary(header.length);
+	ifs.read(binary.data(), header.length);
+	if (!ifs)
+		return false;
+	glProgramBinary(gl_id, header.format, binary.data(), header.length);
+	return true;
+}
+
+void sf::GlShader::SaveProgramBinary()
+{
+	static bool cacheFolderCreated = false;
+	if (!cacheFolderCreated)
+		cacheFolderCreated = FileUtils::CreateFolder(SHADER_CACHE_FOLDER);
+
+	GLint length = 0;
+	glGetProgramiv(gl_id, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	std::vector<char> binary(length);
+	ProgramBinaryHeader header;
+	header.magic = SHADER_CACHE_MAGIC;
+	glGetProgramBinary(gl_id, length, nullptr, (GLenum*)&header.format, binary.data());
+	header.length = length;
+
+	std::ofstream ofs(GetProgramBinaryPath(), std::ios::binary);
+	if (ofs.fail())
+	{
+		std::cout << "[GlShader] Could not write program binary to " << GetProgramBinaryPath() << std::endl;
+		return;
+	}
+	ofs.write((const char*)&header, sizeof(header));
+	ofs.write(binary.data(), length);
 }
 
 void sf::GlShader::Create(const Material& material, const BufferLayout* vertexBufferLayout)
+{
+	BeginCreate(material, vertexBufferLayout);
+	FinishCreate();
+}
+
+void sf::GlShader::BeginCreate(const Material& material, const BufferLayout* vertexBufferLayout)
+{
+	GatherSources(material, vertexBufferLayout);
+	BeginProgram();
+}
+
+void sf::GlShader::GatherSources(const Material& material, const BufferLayout* vertexBufferLayout)
 {
 	if (material.UsesMeshShader())
 	{
@@ -257,34 +433,11 @@ void sf::GlShader::Create(const Material& material, const BufferLayout* vertexBu
 		ResolveIncludes(meshShaderSource);
 		ResolveIncludes(fragShaderSource);
 
-		gl_id = glCreateProgram();
-		std::cout << "[GlShader] Created program with id " << gl_id << std::endl;
-		uint32_t ts, ms, fs;
-		if (material.UsesTaskShader())
-			ts = CompileShader(GL_TASK_SHADER_NV, taskShaderSource);
-		ms = CompileShader(GL_MESH_SHADER_NV, meshShaderSource);
-		fs = CompileShader(GL_FRAGMENT_SHADER, fragShaderSource);
-
-		if (material.UsesTaskShader())
-			if (!ts)
-				std::cout << taskShaderSource << std::endl;
-		if (!ms)
-			std::cout << meshShaderSource << std::endl;
-		if (!fs)
-			std::cout << fragShaderSource << std::endl;
-
 		if (material.UsesTaskShader())
-			glAttachShader(gl_id, ts);
-		glAttachShader(gl_id, ms);
-		glAttachShader(gl_id, fs);
-		glLinkProgram(gl_id);
-		CheckLinkStatusAndReturnProgram(gl_id, true);
-		glValidateProgram(gl_id);
-
-		if (material.UsesTaskShader())
-			glDeleteShader(ts);
-		glDeleteShader(ms);
-		glDeleteShader(fs);
+			m_pendingStages.push_back({ GL_TASK_SHADER_NV, taskShaderSource });
+		m_pendingStages.push_back({ GL_MESH_SHADER_NV, meshShaderSource });
+		m_pendingStages.push_back({ GL_FRAGMENT_SHADER, fragShaderSource });
+		ComputeProgramHash();
 		return;
 	}
 	m_vertFileName = material.vertShaderFilePath + ".glsl";
@@ -332,6 +485,7 @@ void sf::GlShader::Create(const Material& material, const BufferLayout* vertexBu
 	fragShaderSource = std::string((std::istreambuf_iterator<char>(ifs4)),
 		(std::istreambuf_iterator<char>()));
 
+	vertShaderSource = GenerateInstanceDataShaderHeader() + vertShaderSource;
 	vertShaderSource = GenerateBufferShaderHeader(material) + vertShaderSource;
 	vertShaderSource = GenerateVertexAttributeShaderHeader(*vertexBufferLayout) + vertShaderSource;
 	vertShaderSource = "#version 460\n" + vertShaderSource;
@@ -356,47 +510,63 @@ void sf::GlShader::Create(const Material& material, const BufferLayout* vertexBu
 	}
 	ResolveIncludes(fragShaderSource);
 
-	gl_id = glCreateProgram();
-	std::cout << "[GlShader] Created program with id " << gl_id << std::endl;
-	uint32_t vs, tcs, tes, fs;
-	vs = CompileShader(GL_VERTEX_SHADER, vertShaderSource);
+	m_pendingStages.push_back({ GL_VERTEX_SHADER, vertShaderSource });
 	if (material.UsesTessellation())
 	{
-		tcs = CompileShader(GL_TESS_CONTROL_SHADER, tescShaderSource);
-		tes = CompileShader(GL_TESS_EVALUATION_SHADER, teseShaderSource);
+		m_pendingStages.push_back({ GL_TESS_CONTROL_SHADER, tescShaderSource });
+		m_pendingStages.push_back({ GL_TESS_EVALUATION_SHADER, teseShaderSource });
 	}
-	fs = CompileShader(GL_FRAGMENT_SHADER, fragShaderSource);
+	m_pendingStages.push_back({ GL_FRAGMENT_SHADER, fragShaderSource });
+	ComputeProgramHash();
+}
 
-	if (!vs)
-		std::cout << vertShaderSource << std::endl;
-	if (material.UsesTessellation())
+bool sf::GlShader::IsReady() const
+{
+	if (IsFinished() || m_loadedFromCache || !parallelCompileSupported)
+		return true;
+	GLint completed = GL_FALSE;
+	glGetProgramiv(gl_id, GL_COMPLETION_STATUS_KHR, &completed);
+	return completed != GL_FALSE;
+}
+
+void sf::GlShader::FinishCreate()
+{
+	if (IsFinished())
+		return;
+
+	GLint linkStatus;
+	glGetProgramiv(gl_id, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus == GL_FALSE && m_loadedFromCache)
 	{
-		if (!tcs)
-			std::cout << tescShaderSource << std::endl;
-		if (!tes)
-			std::cout << teseShaderSource << std::endl;
+		// driver updates invalidate binaries, they are rebuilt from source and overwritten
+		std::cout << "[GlShader] Cached program binary rejected, compiling from source" << std::endl;
+		m_loadedFromCache = false;
+		CompileAndLinkPendingStages();
+		glGetProgramiv(gl_id, GL_LINK_STATUS, &linkStatus);
 	}
-	if (!fs)
-		std::cout << fragShaderSource << std::endl;
 
-	glAttachShader(gl_id, vs);
-	if (material.UsesTessellation())
+	if (linkStatus == GL_FALSE)
 	{
-		glAttachShader(gl_id, tcs);
-		glAttachShader(gl_id, tes);
+		for (const StageSource& stage : m_pendingStages)
+		{
+			if (!CheckCompileStatus(stage.gl_id, stage.type))
+				std::cout << stage.source << std::endl;
+		}
+		CheckLinkStatusAndReturnProgram(gl_id, true);
 	}
-	glAttachShader(gl_id, fs);
-	glLinkProgram(gl_id);
-	CheckLinkStatusAndReturnProgram(gl_id, true);
+	else if (!m_loadedFromCache)
+		SaveProgramBinary();
 	glValidateProgram(gl_id);
 
-	glDeleteShader(vs);
-	if (material.UsesTessellation())
+	for (const StageSource& stage : m_pendingStages)
 	{
-		glDeleteShader(tcs);
-		glDeleteShader(tes);
+		if (stage.gl_id != 0)
+			glDeleteShader(stage.gl_id);
 	}
-	glDeleteShader(fs);
+	m_pendingStages.clear();
+
+	Reflect();
+	m_supportsInstancing = m_blockBindings.find(INSTANCE_DATA_BLOCK_NAME) != m_blockBindings.end();
 }
 
 void sf::GlShader::CreateComputeFromFile(const std::string& computeShaderPath)
@@ -409,19 +579,23 @@ void sf::GlShader::CreateComputeFromFile(const std::string& computeShaderPath)
 	std::string computeShaderSource((std::istreambuf_iterator<char>(ifs)),
 		(std::istreambuf_iterator<char>()));
 	ResolveIncludes(computeShaderSource);
-	gl_id = glCreateProgram();
-	std::cout << "[GlShader] Created program with id " << gl_id << std::endl;
-	uint32_t cs = CompileShader(GL_COMPUTE_SHADER, computeShaderSource);
-	glAttachShader(gl_id, cs);
-	glLinkProgram(gl_id);
-	glValidateProgram(gl_id);
-	glDeleteShader(cs);
+	m_pendingStages.push_back({ GL_COMPUTE_SHADER, computeShaderSource });
+	ComputeProgramHash();
+	BeginProgram();
+	FinishCreate();
 }
 
 void sf::GlShader::Delete()
 {
+	for (const StageSource& stage : m_pendingStages)
+	{
+		if (stage.gl_id != 0)
+			glDeleteShader(stage.gl_id);
+	}
+	m_pendingStages.clear();
 	if (gl_id != -1)
 	{
+		GlState::ForgetProgram(gl_id);
 		glDeleteProgram(gl_id);
 		uint32_t boundProgram; glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&boundProgram);
 		if (gl_id == boundProgram)
@@ -429,25 +603,123 @@ void sf::GlShader::Delete()
 		std::cout << "[GlShader] Deleted program with id " << gl_id << std::endl;
 	}
 	gl_id = -1;
+	m_supportsInstancing = false;
+}
+
+sf::GlShader* sf::GlShader::AcquireShared(const Material& material, const BufferLayout* vertexBufferLayout)
+{
+	GlShader* shader = new GlShader();
+	shader->GatherSources(material, vertexBufferLayout);
+	auto iterator = sharedShaders.find(shader->m_programHash);
+	if (iterator != sharedShaders.end())
+	{
+		delete shader;
+		iterator->second->m_referenceCount++;
+		std::cout << "[GlShader] Reusing program with id " << iterator->second->gl_id << std::endl;
+		return iterator->second;
+	}
+	shader->m_id = sharedShaderIdCounter++;
+	shader->m_referenceCount = 1;
+	shader->BeginProgram();
+	sharedShaders[shader->m_programHash] = shader;
+	return shader;
+}
+
+void sf::GlShader::ReleaseShared(GlShader* shader)
+{
+	assert(shader->m_referenceCount > 0);
+	shader->m_referenceCount--;
+	if (shader->m_referenceCount > 0)
+		return;
+	sharedShaders.erase(shader->m_programHash);
+	shader->Delete();
+	delete shader;
 }
 
 void sf::GlShader::Bind() const
 {
 	assert(gl_id != -1);
-	glUseProgram(gl_id);
+	GlState::UseProgram(gl_id);
 }
 
-int sf::GlShader::GetUniformLocation(const std::string& name)
+void sf::GlShader::Reflect()
 {
-	if (m_uniformCache.find(name) != m_uniformCache.end() && m_uniformCache[name].location != -1)
-		return m_uniformCache[name].location;
+	m_uniformCache.clear();
+	m_blockBindings.clear();
+	m_textureIndexCounter = 0;
+	m_lastMaterialId = ~0u;
+
+	GLint nameBufferLength = 1;
+	const GLenum namedInterfaces[] = { GL_UNIFORM, GL_UNIFORM_BLOCK, GL_SHADER_STORAGE_BLOCK };
+	for (GLenum namedInterface : namedInterfaces)
+	{
+		GLint maxNameLength = 0;
+		glGetProgramInterfaceiv(gl_id, namedInterface, GL_MAX_NAME_LENGTH, &maxNameLength);
+		if (maxNameLength > nameBufferLength)
+			nameBufferLength = maxNameLength;
+	}
+	std::vector<char> nameBuffer(nameBufferLength);
+
+	// loose uniforms, block members are left out since they are set through buffers
+	GLint uniformCount = 0;
+	glGetProgramInterfaceiv(gl_id, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformCount);
+	const GLenum uniformProperties[] = { GL_TYPE, GL_LOCATION, GL_BLOCK_INDEX, GL_ARRAY_SIZE };
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLint values[4];
+		glGetProgramResourceiv(gl_id, GL_UNIFORM, i, 4, uniformProperties, 4, nullptr, values);
+		if (values[2] != -1)
+			continue;
+		glGetProgramResourceName(gl_id, GL_UNIFORM, i, nameBufferLength, nullptr, nameBuffer.data());
+		std::string name(nameBuffer.data());
+		ShaderUniformData& uniformData = m_uniformCache[name];
+		uniformData.location = values[1];
+		uniformData.type = values[0];
+		uniformData.arraySize = values[3];
+
+		// arrays are reported as name[0], they are set by name
+		if (name.length() > 3 && name.compare(name.length() - 3, 3, "[0]") == 0)
+			m_uniformCache[name.substr(0, name.length() - 3)] = uniformData;
+	}
+
+	const GLenum blockInterfaces[] = { GL_UNIFORM_BLOCK, GL_SHADER_STORAGE_BLOCK };
+	const GLenum blockProperties[] = { GL_BUFFER_BINDING };
+	for (GLenum blockInterface : blockInterfaces)
+	{
+		GLint blockCount = 0;
+		glGetProgramInterfaceiv(gl_id, blockInterface, GL_ACTIVE_RESOURCES, &blockCount);
+		for (GLint i = 0; i < blockCount; i++)
+		{
+			GLint binding;
+			glGetProgramResourceiv(gl_id, blockInterface, i, 1, blockProperties, 1, nullptr, &binding);
+			glGetProgramResourceName(gl_id, blockInterface, i, nameBufferLength, nullptr, nameBuffer.data());
+			m_blockBindings[std::string(nameBuffer.data())] = binding;
+		}
+	}
+
+	for (uint32_t i = 0; i < (uint32_t)BuiltinUniform::Count; i++)
+	{
+		auto iterator = m_uniformCache.find(builtinUniformNames[i]);
+		m_builtinUniformLocations[i] = iterator == m_uniformCache.end() ? -1 : iterator->second.location;
+	}
+}
 
-	int location = glGetUniformLocation(gl_id, name.c_str());
-	if (location == -1)
-		std::cout << "[GlShader] Could not get uniform location for '" << name << "' in shader " << m_vertFileName << "-" << m_fragFileName << std::endl;
+int sf::GlShader::GetBlockBinding(const std::string& name) const
+{
+	auto iterator = m_blockBindings.find(name);
+	return iterator == m_blockBindings.end() ? -1 : iterator->second;
+}
 
-	m_uniformCache[name].location = location;
-	return location;
+int sf::GlShader::GetUniformLocation(const std::string& name)
+{
+	// every active uniform is cached after linking, anything else is inactive and only reported once
+	auto iterator = m_uniformCache.find(name);
+	if (iterator != m_uniformCache.end())
+		return iterator->second.location;
+
+	std::cout << "[GlShader] Could not get uniform location for '" << name << "' in shader " << m_vertFileName << "-" << m_fragFileName << std::endl;
+	m_uniformCache[name].location = -1;
+	return -1;
 }
 
 int sf::GlShader::GetOrAssignTextureIndex(const std::string& name)
@@ -524,4 +796,25 @@ void sf::GlShader::SetUniform1i(const std::string& name, int32_t value)
 void sf::GlShader::SetUniform1u(const std::string& name, uint32_t value)
 {
 	glUniform1ui(GetUniformLocation(name), value);
-}
\ No newline at end of file
+}
+
+void sf::GlShader::SetUniform2fv(BuiltinUniform uniform, const float* pointer, uint32_t number)
+{
+	glUniform2fv(m_builtinUniformLocations[(uint32_t)uniform], number, pointer);
+}
+void sf::GlShader::SetUniform3fv(BuiltinUniform uniform, const float* pointer, uint32_t number)
+{
+	glUniform3fv(m_builtinUniformLocations[(uint32_t)uniform], number, pointer);
+}
+void sf::GlShader::SetUniform4fv(BuiltinUniform uniform, const float* pointer, uint32_t number)
+{
+	glUniform4fv(m_builtinUniformLocations[(uint32_t)uniform], number, pointer);
+}
+void sf::GlShader::SetUniform1f(BuiltinUniform uniform, float value)
+{
+	glUniform1f(m_builtinUniformLocations[(uint32_t)uniform], value);
+}
+void sf::GlShader::SetUniform1i(BuiltinUniform uniform, int32_t value)
+{
+	glUniform1i(m_builtinUniformLocations[(uint32_t)uniform], value);
+}
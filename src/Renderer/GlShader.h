@@ -2,12 +2,18 @@
 
 #include <string>
 #include <glad/glad.h>
+#include <vector>
 #include <unordered_map>
 
 #include <Material.h>
 
 #include <BufferLayout.h>
 
+#define INSTANCE_DATA_SSBO_BINDING 7
+#define INSTANCE_DATA_BLOCK_NAME "_InstanceData"
+#define INSTANCE_SKINNING_SSBO_BINDING 6
+#define SKINNING_DATA_SSBO_BINDING 5
+
 namespace sf {
 
 	class ComputeShader;
@@ -16,6 +22,27 @@ namespace sf {
 	struct ShaderUniformData {
 		int location = -1;
 		int textureIndex = -1;
+		uint32_t type = 0;
+		int arraySize = 1;
+	};
+
+	/* How bone transforms are stored in the frame skinning buffer, read by assets/shaders/skinning.h */
+	enum class SkinningFormat
+	{
+		Matrix4x4, // 64 bytes per bone
+		Matrix3x4, // 48 bytes per bone, last row is implicit
+		DualQuaternion // 32 bytes per bone, bone scale is dropped
+	};
+
+	/* Uniforms the renderer sets itself, their locations are resolved once after linking */
+	enum class BuiltinUniform
+	{
+		ParticleCycleTime = 0,
+		ParticleLifetime,
+		ParticleAcceleration,
+		Bitmap,
+		Atlas,
+		Count
 	};
 
 	class GlShader
@@ -30,24 +57,74 @@ namespace sf {
 		std::string m_taskFileName;
 		std::string m_meshFileName;
 		std::unordered_map<std::string, ShaderUniformData> m_uniformCache;
+		std::unordered_map<std::string, int> m_blockBindings;
+		int m_builtinUniformLocations[(uint32_t)BuiltinUniform::Count];
 		int m_textureIndexCounter = 0;
+		bool m_supportsInstancing = false;
+
+		// sources are kept until the program is finished in case the cached binary is rejected
+		struct StageSource
+		{
+			uint32_t type;
+			std::string source;
+			uint32_t gl_id = 0;
+		};
+		std::vector<StageSource> m_pendingStages;
+		uint64_t m_programHash = 0;
+		bool m_loadedFromCache = false;
+
+		uint32_t m_id = 0;
+		uint32_t m_referenceCount = 0;
+		// material whose uniform values the program currently holds
+		uint32_t m_lastMaterialId = ~0u;
 	public:
 		uint32_t gl_id = -1;
+		/* Set by the renderer when GL_KHR_parallel_shader_compile is available */
+		static bool parallelCompileSupported;
+		/* Baked into vertex shaders, set before creating any */
+		static SkinningFormat skinningFormat;
 	private:
 		static uint32_t CheckLinkStatusAndReturnProgram(uint32_t program, bool outputErrorMessages);
-		static uint32_t CompileShader(uint32_t type, const std::string& source);
+		static uint32_t StartCompileShader(uint32_t type, const std::string& source);
+		static bool CheckCompileStatus(uint32_t shader, uint32_t type);
+		void GatherSources(const Material& material, const BufferLayout* vertexBufferLayout);
+		void ComputeProgramHash();
+		void BeginProgram();
+		void CompileAndLinkPendingStages();
+		std::string GetProgramBinaryPath() const;
+		bool LoadProgramBinary();
+		void SaveProgramBinary();
+		void Reflect();
 		int GetUniformLocation(const std::string& name);
 		int GetOrAssignTextureIndex(const std::string& uniform);
 	public:
 		void Create(const Material& material, const BufferLayout* vertexBufferLayout);
+		/* Starts compiling or loads the cached binary, FinishCreate must be called before using the shader */
+		void BeginCreate(const Material& material, const BufferLayout* vertexBufferLayout);
+		void FinishCreate();
+		/* True once FinishCreate won't block, always true without parallel compilation */
+		bool IsReady() const;
+		inline bool IsFinished() const { return m_pendingStages.size() == 0; }
 
 		void CreateComputeFromFile(const std::string& computeShaderPath);
 
+		/*
+		 * Materials that end up with the same final sources share one program, only their uniform values differ.
+		 * The program starts compiling on first acquire and is deleted when the last material releases it.
+		 */
+		static GlShader* AcquireShared(const Material& material, const BufferLayout* vertexBufferLayout);
+		static void ReleaseShared(GlShader* shader);
+		/* Small id of a shared program, used to group draws by program */
+		inline uint32_t GetId() const { return m_id; }
+
 		void Delete();
 		GlShader() = default;
 		~GlShader() = default;
 
 		inline bool Initialized() { return gl_id != -1; };
+		inline bool SupportsInstancing() const { return m_supportsInstancing; }
+		inline int GetBuiltinUniformLocation(BuiltinUniform uniform) const { return m_builtinUniformLocations[(uint32_t)uniform]; }
+		int GetBlockBinding(const std::string& name) const;
 		void Bind() const;
 
 		void SetUniformMatrix4fv(const std::string& name, const float* pointer, uint32_t number = 1);
@@ -66,5 +143,11 @@ namespace sf {
 		void SetUniform1f(const std::string& name, float value);
 		void SetUniform1i(const std::string& name, int32_t value);
 		void SetUniform1u(const std::string& name, uint32_t value);
+
+		void SetUniform2fv(BuiltinUniform uniform, const float* pointer, uint32_t number = 1);
+		void SetUniform3fv(BuiltinUniform uniform, const float* pointer, uint32_t number = 1);
+		void SetUniform4fv(BuiltinUniform uniform, const float* pointer, uint32_t number = 1);
+		void SetUniform1f(BuiltinUniform uniform, float value);
+		void SetUniform1i(BuiltinUniform uniform, int32_t value);
 	};
 }
\ No newline at end of file
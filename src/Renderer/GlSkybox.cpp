@@ -1,6 +1,8 @@
 #include "GlSkybox.h"
 
 #include <Components/Camera.h>
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
 
 bool sf::GlSkybox::generated = false;
 uint32_t sf::GlSkybox::gl_VAO;
@@ -60,15 +62,16 @@ void sf::GlSkybox::SetCubemap(GlCubemap* cubemap)
 		glGenVertexArrays(1, &gl_VAO);
 		glGenBuffers(1, &gl_VBO);
 
-		glBindVertexArray(gl_VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, gl_VBO);
+		GlState::BindVertexArray(gl_VAO);
+		GlState::BindBuffer(GL_ARRAY_BUFFER, gl_VBO);
 
 		glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
+		RendererStats::Upload(RendererStats::UploadSite::StaticGeometry, sizeof(cubeVertices));
 
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
 
-		glBindVertexArray(0);
+		GlState::BindVertexArray(0);
 		generated = true;
 	}
 
@@ -98,20 +101,20 @@ void sf::GlSkybox::Draw(const glm::mat4& viewMatrix, const glm::mat4& projection
 	if (!generated)
 		return;
 
-	glDisable(GL_DEPTH_TEST);
+	GlState::SetEnabled(GL_DEPTH_TEST, false);
 
 	shader.Bind();
-	glPolygonMode(GL_FRONT, GL_FILL);
-	glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
+	GlState::PolygonMode(GL_FRONT, GL_FILL);
+	GlState::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+	GlState::BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
 
 	glm::mat4 fixedViewMat = glm::mat4(glm::mat3(viewMatrix));
 	shader.SetUniformMatrix4fv("view", &(fixedViewMat[0][0]));
 	shader.SetUniformMatrix4fv("projection", &(projectionMatrix[0][0]));
-	glBindVertexArray(gl_VAO);
+	GlState::BindVertexArray(gl_VAO);
 	cubemap->Bind();
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
+	RendererStats::Draw(1, 12);
 
-	glEnable(GL_DEPTH_TEST);
+	GlState::SetEnabled(GL_DEPTH_TEST, true);
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "GlSpriteBatcher.h"
+
+#include <cstring>
+#include <cassert>
+#include <glad/glad.h>
+
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
+
+// empty texels between bitmaps so linear filtering doesn't pick up the neighbours
+#define SPRITE_ATLAS_PADDING 1
+
+void sf::GlSpriteBatcher::Create(uint32_t pageSize)
+{
+	assert(pageSize > 0);
+	m_pageSize = pageSize;
+}
+
+void sf::GlSpriteBatcher::Delete()
+{
+	for (AtlasPage* page : m_pages)
+	{
+		page->texture.Delete();
+		delete page;
+	}
+	m_pages.clear();
+}
+
+sf::GlSpriteBatcher::Region sf::GlSpriteBatcher::AddBitmap(const Bitmap& bitmap)
+{
+	uint32_t paddedWidth = bitmap.width + SPRITE_ATLAS_PADDING;
+	uint32_t paddedHeight = bitmap.height + SPRITE_ATLAS_PADDING;
+
+	uint32_t pageIndex = 0;
+	glm::uvec2 position;
+	for (; pageIndex < m_pages.size(); pageIndex++)
+	{
+		if (m_pages[pageIndex]->packer.Insert(paddedWidth, paddedHeight, position))
+			break;
+	}
+	if (pageIndex == m_pages.size())
+	{
+		// bitmaps bigger than the page size get a page of their own
+		uint32_t width = paddedWidth > m_pageSize ? paddedWidth : m_pageSize;
+		uint32_t height = paddedHeight > m_pageSize ? paddedHeight : m_pageSize;
+		AtlasPage* page = new AtlasPage();
+		page->texture.Create(width, height, 4, DataType::u8, GlTexture::ClampToEdge, false);
+		page->packer.Create(width, height);
+		bool inserted = page->packer.Insert(paddedWidth, paddedHeight, position);
+		assert(inserted);
+		m_pages.push_back(page);
+	}
+
+	AtlasPage& page = *m_pages[pageIndex];
+	page.texture.UpdateRegion(bitmap, position.x, position.y);
+	page.regionCount++;
+
+	glm::vec2 pageSize = glm::vec2((float)page.packer.width, (float)page.packer.height);
+	Region region;
+	region.page = pageIndex;
+	region.uvRect = glm::vec4(
+		(float)position.x / pageSize.x,
+		(float)position.y / pageSize.y,
+		(float)(position.x + bitmap.width) / pageSize.x,
+		(float)(position.y + bitmap.height) / pageSize.y);
+	return region;
+}
+
+void sf::GlSpriteBatcher::RemoveBitmap(const Region& region)
+{
+	assert(region.page < m_pages.size() && m_pages[region.page]->regionCount > 0);
+	AtlasPage& page = *m_pages[region.page];
+	page.regionCount--;
+	if (page.regionCount == 0)
+		page.packer.Clear();
+}
+
+void sf::GlSpriteBatcher::Add(const Region& region, const glm::vec2& topLeft, const glm::vec2& size)
+{
+	m_pages[region.page]->sprites.push_back({ topLeft, size, region.uvRect });
+}
+
+void sf::GlSpriteBatcher::Draw(GlRingBuffer& ringBuffer, uint32_t storageBufferOffsetAlignment)
+{
+	for (AtlasPage* page : m_pages)
+	{
+		if (page->sprites.size() == 0)
+			continue;
+
+		uint32_t spritesSize = (uint32_t)(page->sprites.size() * sizeof(SpriteInstance));
+		GlRingBuffer::Allocation sprites = ringBuffer.Allocate(spritesSize, storageBufferOffsetAlignment);
+		memcpy(sprites.pointer, page->sprites.data(), spritesSize);
+		GlState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, sprites.gl_buffer, sprites.offset, spritesSize);
+		page->texture.Bind(0);
+
+		glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0, (GLsizei)page->sprites.size());
+		RendererStats::Draw((uint32_t)page->sprites.size(), page->sprites.size() * 2);
+
+		page->sprites.clear();
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include <Bitmap.h>
+#include <SkylinePacker.h>
+#include <Renderer/GlTexture.h>
+#include <Renderer/GlRingBuffer.h>
+
+namespace sf {
+
+	/*
+	 * Packs sprite bitmaps into rgba atlas pages and draws every sprite added in a frame with one
+	 * instanced call per page, instance data goes through the frame ring buffer. Sprites keep their
+	 * order within a page, pages are drawn in creation order.
+	 */
+	class GlSpriteBatcher
+	{
+	public:
+		// where a bitmap lives inside the atlas
+		struct Region
+		{
+			uint32_t page = ~0U;
+			glm::vec4 uvRect; // min uv, max uv
+		};
+
+		// std430 layout matching assets/shaders/sprite.vert.glsl
+		struct SpriteInstance
+		{
+			glm::vec2 topLeft; // pixels
+			glm::vec2 size;
+			glm::vec4 uvRect;
+		};
+
+	private:
+		struct AtlasPage
+		{
+			GlTexture texture;
+			SkylinePacker packer;
+			uint32_t regionCount = 0;
+			std::vector<SpriteInstance> sprites; // added this frame
+		};
+
+		std::vector<AtlasPage*> m_pages;
+		uint32_t m_pageSize = 0;
+
+	public:
+		void Create(uint32_t pageSize = 2048);
+		void Delete();
+
+		Region AddBitmap(const Bitmap& bitmap);
+		/* Space is reclaimed once every region in the page is removed */
+		void RemoveBitmap(const Region& region);
+
+		void Add(const Region& region, const glm::vec2& topLeft, const glm::vec2& size);
+		/* Expects the sprite shader and the quad vao to be bound, pages go to texture unit 0 */
+		void Draw(GlRingBuffer& ringBuffer, uint32_t storageBufferOffsetAlignment);
+	};
+}
@@ -0,0 +1,275 @@
+#include "GlState.h"
+
+#define UNKNOWN ~0U
+#define MAX_TEXTURE_UNITS 32
+#define MAX_INDEXED_BINDINGS 16
+
+namespace sf::GlState
+{
+	struct IndexedBinding
+	{
+		uint32_t buffer;
+		GLintptr offset;
+		GLsizeiptr size; // 0 for whole buffer bindings
+	};
+
+	enum Capability
+	{
+		Blend = 0,
+		CullFace,
+		DepthTest,
+		CapabilityCount
+	};
+
+	uint32_t program;
+	uint32_t vao;
+	uint32_t arrayBuffer;
+	uint32_t drawIndirectBuffer;
+	IndexedBinding uniformBuffers[MAX_INDEXED_BINDINGS];
+	IndexedBinding storageBuffers[MAX_INDEXED_BINDINGS];
+	uint32_t textures[MAX_TEXTURE_UNITS];
+
+	uint32_t capabilities[CapabilityCount];
+	uint32_t depthMask;
+	GLenum polygonModeFace;
+	GLenum polygonMode;
+	GLenum blendEquation[2];
+	GLenum blendFunc[4];
+
+	Stats currentFrameStats;
+	Stats lastFrameStats;
+
+	inline bool Filter(bool unchanged)
+	{
+		if (unchanged)
+			currentFrameStats.filteredCalls++;
+		else
+			currentFrameStats.issuedCalls++;
+		return unchanged;
+	}
+
+	inline IndexedBinding* GetIndexedBinding(GLenum target, uint32_t index)
+	{
+		if (index >= MAX_INDEXED_BINDINGS)
+			return nullptr;
+		if (target == GL_UNIFORM_BUFFER)
+			return &uniformBuffers[index];
+		if (target == GL_SHADER_STORAGE_BUFFER)
+			return &storageBuffers[index];
+		return nullptr;
+	}
+
+	inline int GetCapabilityIndex(GLenum capability)
+	{
+		switch (capability)
+		{
+		case GL_BLEND: return Blend;
+		case GL_CULL_FACE: return CullFace;
+		case GL_DEPTH_TEST: return DepthTest;
+		default: return -1;
+		}
+	}
+}
+
+void sf::GlState::Invalidate()
+{
+	program = UNKNOWN;
+	vao = UNKNOWN;
+	arrayBuffer = UNKNOWN;
+	drawIndirectBuffer = UNKNOWN;
+	for (uint32_t i = 0; i < MAX_INDEXED_BINDINGS; i++)
+	{
+		uniformBuffers[i].buffer = UNKNOWN;
+		storageBuffers[i].buffer = UNKNOWN;
+	}
+	for (uint32_t i = 0; i < MAX_TEXTURE_UNITS; i++)
+		textures[i] = UNKNOWN;
+	for (uint32_t i = 0; i < CapabilityCount; i++)
+		capabilities[i] = UNKNOWN;
+	depthMask = UNKNOWN;
+	polygonModeFace = UNKNOWN;
+	polygonMode = UNKNOWN;
+	blendEquation[0] = blendEquation[1] = UNKNOWN;
+	blendFunc[0] = blendFunc[1] = blendFunc[2] = blendFunc[3] = UNKNOWN;
+}
+
+void sf::GlState::EndFrame()
+{
+	lastFrameStats = currentFrameStats;
+	currentFrameStats = Stats();
+}
+
+const sf::GlState::Stats& sf::GlState::GetLastFrameStats()
+{
+	return lastFrameStats;
+}
+
+void sf::GlState::UseProgram(uint32_t program)
+{
+	if (Filter(GlState::program == program))
+		return;
+	GlState::program = program;
+	currentFrameStats.programBinds++;
+	glUseProgram(program);
+}
+
+void sf::GlState::BindVertexArray(uint32_t vao)
+{
+	if (Filter(GlState::vao == vao))
+		return;
+	GlState::vao = vao;
+	currentFrameStats.vertexArrayBinds++;
+	glBindVertexArray(vao);
+}
+
+void sf::GlState::BindBuffer(GLenum target, uint32_t buffer)
+{
+	uint32_t* cached = target == GL_ARRAY_BUFFER ? &arrayBuffer : (target == GL_DRAW_INDIRECT_BUFFER ? &drawIndirectBuffer : nullptr);
+	if (cached != nullptr)
+	{
+		if (Filter(*cached == buffer))
+			return;
+		*cached = buffer;
+	}
+	else
+		currentFrameStats.issuedCalls++;
+	glBindBuffer(target, buffer);
+}
+
+void sf::GlState::BindBufferBase(GLenum target, uint32_t index, uint32_t buffer)
+{
+	IndexedBinding* cached = GetIndexedBinding(target, index);
+	if (cached != nullptr)
+	{
+		if (Filter(cached->buffer == buffer && cached->size == 0))
+			return;
+		*cached = { buffer, 0, 0 };
+	}
+	else
+		currentFrameStats.issuedCalls++;
+	glBindBufferBase(target, index, buffer);
+}
+
+void sf::GlState::BindBufferRange(GLenum target, uint32_t index, uint32_t buffer, GLintptr offset, GLsizeiptr size)
+{
+	IndexedBinding* cached = GetIndexedBinding(target, index);
+	if (cached != nullptr)
+	{
+		if (Filter(cached->buffer == buffer && cached->offset == offset && cached->size == size))
+			return;
+		*cached = { buffer, offset, size };
+	}
+	else
+		currentFrameStats.issuedCalls++;
+	glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void sf::GlState::BindTexture(uint32_t unit, uint32_t texture)
+{
+	if (unit < MAX_TEXTURE_UNITS)
+	{
+		if (Filter(textures[unit] == texture))
+			return;
+		textures[unit] = texture;
+	}
+	else
+		currentFrameStats.issuedCalls++;
+	currentFrameStats.textureBinds++;
+	glBindTextureUnit(unit, texture);
+}
+
+void sf::GlState::SetEnabled(GLenum capability, bool enabled)
+{
+	int index = GetCapabilityIndex(capability);
+	if (index != -1)
+	{
+		if (Filter(capabilities[index] == (uint32_t)enabled))
+			return;
+		capabilities[index] = (uint32_t)enabled;
+	}
+	else
+		currentFrameStats.issuedCalls++;
+	if (enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+void sf::GlState::DepthMask(bool enabled)
+{
+	if (Filter(depthMask == (uint32_t)enabled))
+		return;
+	depthMask = (uint32_t)enabled;
+	glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void sf::GlState::PolygonMode(GLenum face, GLenum mode)
+{
+	if (Filter(polygonModeFace == face && polygonMode == mode))
+		return;
+	polygonModeFace = face;
+	polygonMode = mode;
+	glPolygonMode(face, mode);
+}
+
+void sf::GlState::BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
+{
+	if (Filter(blendEquation[0] == modeRGB && blendEquation[1] == modeAlpha))
+		return;
+	blendEquation[0] = modeRGB;
+	blendEquation[1] = modeAlpha;
+	glBlendEquationSeparate(modeRGB, modeAlpha);
+}
+
+void sf::GlState::BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+{
+	if (Filter(blendFunc[0] == srcRGB && blendFunc[1] == dstRGB && blendFunc[2] == srcAlpha && blendFunc[3] == dstAlpha))
+		return;
+	blendFunc[0] = srcRGB;
+	blendFunc[1] = dstRGB;
+	blendFunc[2] = srcAlpha;
+	blendFunc[3] = dstAlpha;
+	glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+
+void sf::GlState::ForgetProgram(uint32_t program)
+{
+	if (GlState::program == program)
+		GlState::program = UNKNOWN;
+}
+
+void sf::GlState::ForgetVertexArray(uint32_t vao)
+{
+	if (GlState::vao == vao)
+		GlState::vao = UNKNOWN;
+}
+
+void sf::GlState::ForgetBuffer(uint32_t buffer)
+{
+	if (arrayBuffer == buffer)
+		arrayBuffer = UNKNOWN;
+	if (drawIndirectBuffer == buffer)
+		drawIndirectBuffer = UNKNOWN;
+	for (uint32_t i = 0; i < MAX_INDEXED_BINDINGS; i++)
+	{
+		if (uniformBuffers[i].buffer == buffer)
+			uniformBuffers[i].buffer = UNKNOWN;
+		if (storageBuffers[i].buffer == buffer)
+			storageBuffers[i].buffer = UNKNOWN;
+	}
+}
+
+void sf::GlState::ForgetTexture(uint32_t texture)
+{
+	for (uint32_t i = 0; i < MAX_TEXTURE_UNITS; i++)
+	{
+		if (textures[i] == texture)
+			textures[i] = UNKNOWN;
+	}
+}
+
+void sf::GlState::InvalidateTextureUnit(uint32_t unit)
+{
+	if (unit < MAX_TEXTURE_UNITS)
+		textures[unit] = UNKNOWN;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <glad/glad.h>
+
+namespace sf::GlState {
+
+	/*
+	 * Shadow copy of the gl state the renderer touches while drawing, calls that would not change
+	 * anything are dropped. Everything starts unknown and is invalidated every frame, so state changed
+	 * behind its back only needs to be reported when it happens in the middle of a frame.
+	 */
+
+	struct Stats
+	{
+		uint32_t issuedCalls = 0;
+		uint32_t filteredCalls = 0;
+		/* Binds that reached gl, already included in issuedCalls */
+		uint32_t programBinds = 0;
+		uint32_t vertexArrayBinds = 0;
+		uint32_t textureBinds = 0;
+	};
+
+	void Invalidate();
+	void EndFrame();
+	const Stats& GetLastFrameStats();
+
+	void UseProgram(uint32_t program);
+	void BindVertexArray(uint32_t vao);
+	/* Only GL_ARRAY_BUFFER and GL_DRAW_INDIRECT_BUFFER are cached, element buffers belong to the vao */
+	void BindBuffer(GLenum target, uint32_t buffer);
+	void BindBufferBase(GLenum target, uint32_t index, uint32_t buffer);
+	void BindBufferRange(GLenum target, uint32_t index, uint32_t buffer, GLintptr offset, GLsizeiptr size);
+	void BindTexture(uint32_t unit, uint32_t texture);
+
+	void SetEnabled(GLenum capability, bool enabled);
+	void DepthMask(bool enabled);
+	void PolygonMode(GLenum face, GLenum mode);
+	void BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha);
+	void BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+
+	/* Must be called before deleting gl objects so a recycled name is not mistaken for a bound one */
+	void ForgetProgram(uint32_t program);
+	void ForgetVertexArray(uint32_t vao);
+	void ForgetBuffer(uint32_t buffer);
+	void ForgetTexture(uint32_t texture);
+	/* For code that binds textures to edit them, which happens on the active unit */
+	void InvalidateTextureUnit(uint32_t unit);
+}
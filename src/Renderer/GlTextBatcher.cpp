@@ -0,0 +1,269 @@
+#include "GlTextBatcher.h"
+
+#include <cstring>
+#include <cassert>
+#include <glad/glad.h>
+
+#include <Hash.h>
+#include <SebTextTextData.h>
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
+
+// should be consistent with LINE_HEIGHT_EM in vendor/sebtext/shader.vert.glsl
+#define LINE_HEIGHT_EM 1.3f
+
+sf::GlTextBatcher::FontGpuData& sf::GlTextBatcher::GetOrCreateFont(const char* fontPath, uint64_t fontKey)
+{
+	auto iterator = m_fonts.find(fontKey);
+	if (iterator != m_fonts.end())
+		return *iterator->second;
+	FontGpuData* font = new FontGpuData(fontPath);
+	glGenBuffers(1, &font->gl_ssbo_bezierData);
+	glGenBuffers(1, &font->gl_ssbo_glyphMetaData);
+	m_fonts[fontKey] = font;
+	return *font;
+}
+
+void sf::GlTextBatcher::AddGlyphs(FontGpuData& font, const std::vector<const SebText::GlyphData*>& newGlyphs)
+{
+	SebText::TextRenderData trd = SebText::CreateRenderData(newGlyphs, font.fontData);
+
+	// offsets in the render data are relative to the new glyphs, they go after the ones already cached
+	int metaDataBase = (int)font.glyphMetaData.size();
+	int pointBase = (int)font.bezierPoints.size();
+	for (uint32_t i = 0; i < newGlyphs.size(); i++)
+	{
+		SebText::GlyphRenderData glyph = trd.AllGlyphData[i];
+		trd.GlyphMetaData[glyph.ContourDataOffset] += pointBase;
+		glyph.ContourDataOffset += metaDataBase;
+		glyph.PointDataOffset += pointBase;
+		font.glyphs[newGlyphs[i]] = glyph;
+	}
+	font.glyphMetaData.insert(font.glyphMetaData.end(), trd.GlyphMetaData.begin(), trd.GlyphMetaData.end());
+	font.bezierPoints.insert(font.bezierPoints.end(), trd.BezierPoints.begin(), trd.BezierPoints.end());
+	font.glyphDataChanged = true;
+}
+
+const sf::GlTextBatcher::TextLayout& sf::GlTextBatcher::GetOrCreateLayout(FontGpuData& font, uint64_t fontKey, const char* string)
+{
+	uint64_t key = Hash::Fnv1a64(string, strlen(string), fontKey);
+	auto iterator = m_layoutLookup.find(key);
+	if (iterator != m_layoutLookup.end())
+	{
+		m_layouts.splice(m_layouts.begin(), m_layouts, iterator->second);
+		return m_layouts.front();
+	}
+
+	if (m_layouts.size() >= m_layoutCapacity)
+	{
+		m_layoutLookup.erase(m_layouts.back().key);
+		m_layouts.pop_back();
+	}
+
+	SebText::TextData td(string, font.fontData);
+	std::vector<const SebText::GlyphData*> newGlyphs;
+	for (const SebText::GlyphData* glyph : td.UniquePrintableCharacters)
+	{
+		if (font.glyphs.find(glyph) == font.glyphs.end())
+			newGlyphs.push_back(glyph);
+	}
+	if (newGlyphs.size() > 0)
+		AddGlyphs(font, newGlyphs);
+
+	m_layouts.emplace_front();
+	TextLayout& layout = m_layouts.front();
+	layout.key = key;
+	layout.lineCount = td.LineCount;
+	layout.lastCharacterPerLine = td.LastCharacterPerLine;
+	layout.glyphs.reserve(td.PrintableCharacters.size());
+	layout.glyphSources.reserve(td.PrintableCharacters.size());
+	for (const SebText::PrintableCharacter& character : td.PrintableCharacters)
+	{
+		const SebText::GlyphData* glyphData = td.UniquePrintableCharacters[character.GlyphIndex];
+		const SebText::GlyphRenderData& glyph = font.glyphs.at(glyphData);
+		layout.glyphSources.push_back(glyphData);
+		layout.glyphs.push_back({ glyph.Size, { character.offsetX, character.offsetY }, character.letterAdvance, character.wordAdvance, glyph.ContourDataOffset, character.line, 0, 0 });
+	}
+	m_layoutLookup[key] = m_layouts.begin();
+	return layout;
+}
+
+void sf::GlTextBatcher::AddMsdfQuads(FontGpuData& font, const TextLayout& layout, const TextInstance& text)
+{
+	if (font.msdfAtlas == nullptr)
+	{
+		font.msdfAtlas = new MsdfAtlas();
+		font.msdfAtlas->Create(font.fontData, font.fontPath);
+		font.msdfTexture.CreateFromBitmap(font.msdfAtlas->bitmap, GlTexture::ClampToEdge, false);
+	}
+
+	// same placement as the vector text vertex shader
+	float lineAligned =
+		text.alignmentV == 0 ? -LINE_HEIGHT_EM :
+		text.alignmentV == 1 ? LINE_HEIGHT_EM * ((float)(text.lineCount - 2) * 0.5f) :
+		LINE_HEIGHT_EM * (float)(text.lineCount - 1);
+	for (uint32_t i = 0; i < layout.glyphs.size(); i++)
+	{
+		const MsdfAtlas::Glyph* atlasGlyph = font.msdfAtlas->GetGlyph(layout.glyphSources[i]);
+		if (atlasGlyph == nullptr) // outside of the atlas character range
+			continue;
+		const GlyphInstance& glyph = layout.glyphs[i];
+		const GlyphInstance& lastGlyph = layout.glyphs[layout.lastCharacterPerLine[glyph.line]];
+		float lineWidth = (lastGlyph.letterAdvance * text.letterSpacing + lastGlyph.wordAdvance * text.wordSpacing + lastGlyph.offset.x + lastGlyph.boundsSize.x) * text.fontSize;
+		float alignmentOffset = text.alignmentH == 2 ? lineWidth : text.alignmentH == 1 ? lineWidth * 0.5f : 0.0f;
+
+		MsdfQuad quad;
+		quad.center.x = (glyph.letterAdvance * text.letterSpacing + glyph.wordAdvance * text.wordSpacing + glyph.offset.x) * text.fontSize + text.globalOffset.x - alignmentOffset;
+		quad.center.y = (lineAligned - (float)glyph.line * LINE_HEIGHT_EM * text.lineSpacing + glyph.offset.y) * text.fontSize - text.globalOffset.y;
+		quad.size = atlasGlyph->size * text.fontSize;
+		quad.uvRect = atlasGlyph->uvRect;
+		quad.color = text.color;
+		font.msdfQuads.push_back(quad);
+	}
+}
+
+void sf::GlTextBatcher::Create(uint32_t layoutCapacity)
+{
+	assert(layoutCapacity > 0);
+	m_layoutCapacity = layoutCapacity;
+}
+
+void sf::GlTextBatcher::Delete()
+{
+	for (auto& pair : m_fonts)
+	{
+		if (pair.second->msdfAtlas != nullptr)
+		{
+			pair.second->msdfTexture.Delete();
+			delete pair.second->msdfAtlas;
+		}
+		GlState::ForgetBuffer(pair.second->gl_ssbo_bezierData);
+		GlState::ForgetBuffer(pair.second->gl_ssbo_glyphMetaData);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::TextBuffers, pair.second->gl_ssbo_bezierData);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::TextBuffers, pair.second->gl_ssbo_glyphMetaData);
+		glDeleteBuffers(1, &pair.second->gl_ssbo_bezierData);
+		glDeleteBuffers(1, &pair.second->gl_ssbo_glyphMetaData);
+		delete pair.second;
+	}
+	m_fonts.clear();
+	m_layouts.clear();
+	m_layoutLookup.clear();
+}
+
+void sf::GlTextBatcher::Add(const char* fontPath, const char* string, const glm::vec4& color, float size, int alignmentH, int alignmentV, const glm::vec2& pixelOffset, TextRenderMode renderMode)
+{
+	uint64_t fontKey = Hash::Fnv1a64(fontPath, strlen(fontPath));
+	FontGpuData& font = GetOrCreateFont(fontPath, fontKey);
+	const TextLayout& layout = GetOrCreateLayout(font, fontKey, string);
+	if (layout.glyphs.size() == 0)
+		return;
+
+	SebText::LayoutSettings defaultSettings;
+	TextInstance text;
+	text.color = color;
+	text.globalOffset = pixelOffset;
+	text.fontSize = size;
+	text.lineSpacing = defaultSettings.LineSpacing;
+	text.letterSpacing = defaultSettings.LetterSpacing;
+	text.wordSpacing = defaultSettings.WordSpacing;
+	text.alignmentH = alignmentH;
+	text.alignmentV = alignmentV;
+	text.lineCount = layout.lineCount;
+	text.firstGlyph = (int)font.glyphInstances.size();
+	text.firstLine = (int)font.lastCharacterPerLine.size();
+	text.padding = 0;
+
+	if (renderMode == TextRenderMode::Msdf)
+	{
+		AddMsdfQuads(font, layout, text);
+		return;
+	}
+
+	int textIndex = (int)font.textInstances.size();
+	font.textInstances.push_back(text);
+	for (const GlyphInstance& glyph : layout.glyphs)
+	{
+		font.glyphInstances.push_back(glyph);
+		font.glyphInstances.back().textIndex = textIndex;
+	}
+	for (int lastCharacter : layout.lastCharacterPerLine)
+		font.lastCharacterPerLine.push_back(text.firstGlyph + lastCharacter);
+}
+
+void sf::GlTextBatcher::Draw(GlRingBuffer& ringBuffer, uint32_t storageBufferOffsetAlignment)
+{
+	for (auto& pair : m_fonts)
+	{
+		FontGpuData& font = *pair.second;
+		if (font.glyphInstances.size() == 0)
+			continue;
+
+		if (font.glyphDataChanged)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, font.gl_ssbo_bezierData);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, font.bezierPoints.size() * sizeof(glm::vec2), font.bezierPoints.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, font.gl_ssbo_glyphMetaData);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, font.glyphMetaData.size() * sizeof(int), font.glyphMetaData.data(), GL_STATIC_DRAW);
+			uint64_t bezierBytes = font.bezierPoints.size() * sizeof(glm::vec2);
+			uint64_t metaDataBytes = font.glyphMetaData.size() * sizeof(int);
+			RendererStats::Upload(RendererStats::UploadSite::TextOutlines, bezierBytes + metaDataBytes);
+			RendererStats::TrackMemory(RendererStats::MemoryCategory::TextBuffers, font.gl_ssbo_bezierData, bezierBytes);
+			RendererStats::TrackMemory(RendererStats::MemoryCategory::TextBuffers, font.gl_ssbo_glyphMetaData, metaDataBytes);
+			font.glyphDataChanged = false;
+		}
+
+		uint32_t glyphsSize = (uint32_t)(font.glyphInstances.size() * sizeof(GlyphInstance));
+		uint32_t textsSize = (uint32_t)(font.textInstances.size() * sizeof(TextInstance));
+		uint32_t linesSize = (uint32_t)(font.lastCharacterPerLine.size() * sizeof(int));
+		GlRingBuffer::Allocation glyphs = ringBuffer.Allocate(glyphsSize, storageBufferOffsetAlignment);
+		memcpy(glyphs.pointer, font.glyphInstances.data(), glyphsSize);
+		GlRingBuffer::Allocation texts = ringBuffer.Allocate(textsSize, storageBufferOffsetAlignment);
+		memcpy(texts.pointer, font.textInstances.data(), textsSize);
+		GlRingBuffer::Allocation lines = ringBuffer.Allocate(linesSize, storageBufferOffsetAlignment);
+		memcpy(lines.pointer, font.lastCharacterPerLine.data(), linesSize);
+
+		GlState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, glyphs.gl_buffer, glyphs.offset, glyphsSize);
+		GlState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, font.gl_ssbo_bezierData);
+		GlState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, font.gl_ssbo_glyphMetaData);
+		GlState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, lines.gl_buffer, lines.offset, linesSize);
+		GlState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, 5, texts.gl_buffer, texts.offset, textsSize);
+
+		glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0, (GLsizei)font.glyphInstances.size());
+		RendererStats::Draw((uint32_t)font.glyphInstances.size(), font.glyphInstances.size() * 2);
+
+		font.glyphInstances.clear();
+		font.textInstances.clear();
+		font.lastCharacterPerLine.clear();
+	}
+}
+
+void sf::GlTextBatcher::DrawMsdf(GlRingBuffer& ringBuffer, uint32_t storageBufferOffsetAlignment)
+{
+	for (auto& pair : m_fonts)
+	{
+		FontGpuData& font = *pair.second;
+		if (font.msdfQuads.size() == 0)
+			continue;
+
+		uint32_t quadsSize = (uint32_t)(font.msdfQuads.size() * sizeof(MsdfQuad));
+		GlRingBuffer::Allocation quads = ringBuffer.Allocate(quadsSize, storageBufferOffsetAlignment);
+		memcpy(quads.pointer, font.msdfQuads.data(), quadsSize);
+		GlState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, quads.gl_buffer, quads.offset, quadsSize);
+		font.msdfTexture.Bind(0);
+
+		glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0, (GLsizei)font.msdfQuads.size());
+		RendererStats::Draw((uint32_t)font.msdfQuads.size(), font.msdfQuads.size() * 2);
+
+		font.msdfQuads.clear();
+	}
+}
+
+bool sf::GlTextBatcher::HasMsdfText() const
+{
+	for (const auto& pair : m_fonts)
+	{
+		if (pair.second->msdfQuads.size() > 0)
+			return true;
+	}
+	return false;
+}
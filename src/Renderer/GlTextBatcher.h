@@ -0,0 +1,123 @@
+#pragma once
+
+#include <list>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include <SebTextFontData.h>
+#include <SebTextRenderData.h>
+
+#include <MsdfAtlas.h>
+#include <Components/Text.h>
+#include <Renderer/GlTexture.h>
+#include <Renderer/GlRingBuffer.h>
+
+namespace sf {
+
+	/*
+	 * Collects every text drawn in a frame and draws them with one instanced call per font.
+	 * Glyph outlines are uploaded once per font and shared by all strings. String layouts are kept
+	 * in a bounded lru keyed by font and string, so text that changes every frame only costs the
+	 * layout, per frame instance data goes through the frame ring buffer.
+	 * Texts in msdf mode are positioned on the cpu and drawn as textured quads sampling the font atlas.
+	 */
+	class GlTextBatcher
+	{
+	public:
+		// std430 layouts matching vendor/sebtext/shader.vert.glsl
+		struct GlyphInstance
+		{
+			glm::vec2 boundsSize;
+			glm::vec2 offset;
+			float letterAdvance;
+			float wordAdvance;
+			int contourDataOffset;
+			int line;
+			int textIndex;
+			int padding;
+		};
+
+		struct TextInstance
+		{
+			glm::vec4 color;
+			glm::vec2 globalOffset;
+			float fontSize;
+			float lineSpacing;
+			float letterSpacing;
+			float wordSpacing;
+			int alignmentH;
+			int alignmentV;
+			int lineCount;
+			int firstGlyph;
+			int firstLine;
+			int padding;
+		};
+
+		// std430 layout matching assets/shaders/msdfText.vert.glsl
+		struct MsdfQuad
+		{
+			glm::vec2 center; // pixels, y up
+			glm::vec2 size;
+			glm::vec4 uvRect;
+			glm::vec4 color;
+		};
+
+	private:
+		struct FontGpuData
+		{
+			SebText::FontData fontData;
+			std::unordered_map<const SebText::GlyphData*, SebText::GlyphRenderData> glyphs;
+			std::vector<glm::vec2> bezierPoints;
+			std::vector<int> glyphMetaData;
+			bool glyphDataChanged = false;
+			uint32_t gl_ssbo_bezierData = 0;
+			uint32_t gl_ssbo_glyphMetaData = 0;
+
+			// texts added this frame
+			std::vector<GlyphInstance> glyphInstances;
+			std::vector<TextInstance> textInstances;
+			std::vector<int> lastCharacterPerLine;
+
+			// created on first msdf use
+			MsdfAtlas* msdfAtlas = nullptr;
+			GlTexture msdfTexture;
+			std::vector<MsdfQuad> msdfQuads;
+
+			std::string fontPath;
+			FontGpuData(const char* fontPath) : fontData(fontPath), fontPath(fontPath) {}
+		};
+
+		struct TextLayout
+		{
+			uint64_t key;
+			std::vector<GlyphInstance> glyphs;
+			std::vector<const SebText::GlyphData*> glyphSources;
+			std::vector<int> lastCharacterPerLine;
+			int lineCount;
+		};
+
+		std::unordered_map<uint64_t, FontGpuData*> m_fonts;
+		std::list<TextLayout> m_layouts; // most recently used first
+		std::unordered_map<uint64_t, std::list<TextLayout>::iterator> m_layoutLookup;
+		uint32_t m_layoutCapacity = 0;
+
+		FontGpuData& GetOrCreateFont(const char* fontPath, uint64_t fontKey);
+		const TextLayout& GetOrCreateLayout(FontGpuData& font, uint64_t fontKey, const char* string);
+		void AddGlyphs(FontGpuData& font, const std::vector<const SebText::GlyphData*>& newGlyphs);
+		void AddMsdfQuads(FontGpuData& font, const TextLayout& layout, const TextInstance& text);
+
+	public:
+		void Create(uint32_t layoutCapacity = 256);
+		void Delete();
+
+		void Add(const char* fontPath, const char* string, const glm::vec4& color, float size, int alignmentH, int alignmentV, const glm::vec2& pixelOffset, TextRenderMode renderMode = TextRenderMode::Vector);
+		/* Expects the text shader and the quad vao to be bound */
+		void Draw(GlRingBuffer& ringBuffer, uint32_t storageBufferOffsetAlignment);
+		/* Expects the msdf text shader and the quad vao to be bound, atlases go to texture unit 0 */
+		void DrawMsdf(GlRingBuffer& ringBuffer, uint32_t storageBufferOffsetAlignment);
+		bool HasMsdfText() const;
+	};
+}
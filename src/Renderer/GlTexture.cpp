@@ -4,10 +4,17 @@
 #include <cassert>
 #include <iostream>
 
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
+
 void sf::GlTexture::Create(uint32_t width, uint32_t height, int channelCount, DataType storageDataType, WrapMode wrapMode, bool mipmap)
 {
 	if (this->isInitialized)
+	{
+		GlState::ForgetTexture(this->gl_id);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, this->gl_id);
 		glDeleteTextures(1, &this->gl_id);
+	}
 
 	this->isInitialized = true;
 	this->width = width;
@@ -24,6 +31,7 @@ void sf::GlTexture::Create(uint32_t width, uint32_t height, int channelCount, Da
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, this->width, this->height, 0, format, type, nullptr);
+	RendererStats::TrackTexture(this->gl_id, internalFormat, this->width, this->height, 1, mipmap);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -31,13 +39,17 @@ void sf::GlTexture::Create(uint32_t width, uint32_t height, int channelCount, Da
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->wrapMode == WrapMode::Repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE);
 
 	glBindTexture(GL_TEXTURE_2D, 0);
-
+	GlState::InvalidateTextureUnit(0);
 }
 
 void sf::GlTexture::CreateFromBitmap(const Bitmap& bitmap, WrapMode wrapMode, bool mipmap, int internalFormat)
 {
 	if (this->isInitialized)
+	{
+		GlState::ForgetTexture(this->gl_id);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, this->gl_id);
 		glDeleteTextures(1, &this->gl_id);
+	}
 
 	this->isInitialized = true;
 	this->height = bitmap.height;
@@ -60,35 +72,56 @@ void sf::GlTexture::CreateFromBitmap(const Bitmap& bitmap, WrapMode wrapMode, bo
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat == -1 ? deducedInternalFormat : internalFormat, this->width, this->height, 0, format, type, bitmap.buffer);
+	RendererStats::TrackTexture(this->gl_id, internalFormat == -1 ? deducedInternalFormat : internalFormat, this->width, this->height, 1, mipmap);
 
 	if (mipmap)
 		glGenerateMipmap(GL_TEXTURE_2D);
 
 	glBindTexture(GL_TEXTURE_2D, 0);
+	GlState::InvalidateTextureUnit(0);
+}
+
+void sf::GlTexture::UpdateRegion(const Bitmap& bitmap, uint32_t x, uint32_t y)
+{
+	assert(x + bitmap.width <= (uint32_t)this->width && y + bitmap.height <= (uint32_t)this->height);
+
+	int internalFormat;
+	GLenum type, format;
+	DeduceGlTextureEnums(bitmap.channelCount, bitmap.dataType, type, internalFormat, format);
+
+	glBindTexture(GL_TEXTURE_2D, this->gl_id);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, bitmap.width, bitmap.height, format, type, bitmap.buffer);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	GlState::InvalidateTextureUnit(0);
 }
 
 void sf::GlTexture::ComputeMipmap()
 {
 	glBindTexture(GL_TEXTURE_2D, this->gl_id);
 	glGenerateMipmap(GL_TEXTURE_2D);
+	GlState::InvalidateTextureUnit(0);
 }
 
 void sf::GlTexture::Delete()
 {
 	if (this->gl_id != 0)
+	{
+		GlState::ForgetTexture(this->gl_id);
+		RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, this->gl_id);
 		glDeleteTextures(1, &this->gl_id);
+	}
 	this->gl_id = 0;
 }
 
 void sf::GlTexture::Bind(uint32_t slot) const
 {
-	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_2D, this->gl_id);
+	GlState::BindTexture(slot, this->gl_id);
 }
 
 void sf::GlTexture::Unbind() const
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GlState::BindTexture(0, 0);
 }
 
 void sf::DeduceGlTextureEnums(int channelCount, DataType storageDataType, GLenum& type, int& internalFormat, GLenum& format)
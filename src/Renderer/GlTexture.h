@@ -35,6 +35,9 @@ namespace sf {
 			bool mipmap = true,
 			int internalFormat = -1);
 
+		/* Writes the bitmap at x, y without reallocating, the texture keeps its storage format */
+		void UpdateRegion(const Bitmap& bitmap, uint32_t x, uint32_t y);
+
 		void Delete();
 		GlTexture() = default;
 		~GlTexture() = default;
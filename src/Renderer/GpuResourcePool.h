@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+#include <GpuHandle.h>
+
+namespace sf {
+
+	/*
+	 * Generational slot map for gpu side data. Lookups are an index and two compares, the owner is
+	 * checked too so a copied resource carrying someone else's handle gets its own slot. Retired slots
+	 * stop resolving right away but keep their value until removed, so the gpu objects can be deleted
+	 * once no frame in flight uses them.
+	 */
+	template<typename T>
+	class GpuResourcePool
+	{
+	private:
+		struct Slot
+		{
+			T value;
+			const void* owner = nullptr;
+			uint32_t generation = 1;
+			bool used = false;
+		};
+		std::vector<Slot> m_slots;
+		std::vector<uint32_t> m_freeSlots;
+
+	public:
+		inline GpuHandle Add(const void* owner, const T& value)
+		{
+			uint32_t index;
+			if (m_freeSlots.size() > 0)
+			{
+				index = m_freeSlots.back();
+				m_freeSlots.pop_back();
+			}
+			else
+			{
+				index = (uint32_t)m_slots.size();
+				m_slots.emplace_back();
+			}
+			m_slots[index].value = value;
+			m_slots[index].owner = owner;
+			m_slots[index].used = true;
+			return { index, m_slots[index].generation };
+		}
+
+		inline T* Get(GpuHandle handle, const void* owner)
+		{
+			if (handle.index >= m_slots.size())
+				return nullptr;
+			Slot& slot = m_slots[handle.index];
+			if (slot.generation != handle.generation || slot.owner != owner || owner == nullptr)
+				return nullptr;
+			return &slot.value;
+		}
+
+		/* The value stays accessible through GetRetired until Remove */
+		inline void Retire(GpuHandle handle)
+		{
+			assert(handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation);
+			m_slots[handle.index].owner = nullptr;
+		}
+
+		inline T& GetRetired(GpuHandle handle)
+		{
+			assert(handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation);
+			return m_slots[handle.index].value;
+		}
+
+		inline void Remove(GpuHandle handle)
+		{
+			assert(handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation);
+			Slot& slot = m_slots[handle.index];
+			slot.value = T();
+			slot.owner = nullptr;
+			slot.used = false;
+			slot.generation++;
+			if (slot.generation == 0) // 0 is never a valid generation
+				slot.generation = 1;
+			m_freeSlots.push_back(handle.index);
+		}
+
+		template<typename F>
+		inline void ForEach(F function)
+		{
+			for (Slot& slot : m_slots)
+			{
+				if (slot.used)
+					function(slot.value);
+			}
+		}
+
+		inline void Clear()
+		{
+			m_slots.clear();
+			m_freeSlots.clear();
+		}
+	};
+}
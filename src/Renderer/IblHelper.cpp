@@ -8,6 +8,8 @@
 #include <iostream>
 
 #include <Renderer/GlShader.h>
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
 #include <Bitmap.h>
 
 namespace sf::IblHelper
@@ -39,6 +41,7 @@ namespace sf::IblHelper
 		glTextureStorage2D(texture.id, texture.levels, internalFormat, width, height);
 		glTextureParameteri(texture.id, GL_TEXTURE_MIN_FILTER, texture.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 		glTextureParameteri(texture.id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		RendererStats::TrackTexture(texture.id, internalFormat, width, height, target == GL_TEXTURE_CUBE_MAP ? 6 : 1, mipmap);
 		return texture;
 	}
 
@@ -65,7 +68,11 @@ namespace sf::IblHelper
 		lut.channelCount = 2;
 		lut.storageDataType = dataType;
 		if (lut.isInitialized)
+		{
+			GlState::ForgetTexture(lut.gl_id);
+			RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, lut.gl_id);
 			glDeleteTextures(1, &lut.gl_id);
+		}
 		lut.gl_id = m_spBRDF_LUT.id;
 		lut.isInitialized = true;
 	}
@@ -86,7 +93,7 @@ namespace sf::IblHelper
 
 		equirect2CubeComputeShader.Bind();
 		Texture envTextureUnfiltered = createTexture(GL_TEXTURE_CUBE_MAP, kEnvMapSize, kEnvMapSize, internalFormat, true);
-		glBindTextureUnit(0, equirectTexture.gl_id);
+		GlState::BindTexture(0, equirectTexture.gl_id);
 		glBindImageTexture(0, envTextureUnfiltered.id, 0, GL_TRUE, 0, GL_WRITE_ONLY, internalFormat);
 		glDispatchCompute(envTextureUnfiltered.width / 32, envTextureUnfiltered.height / 32, 6);
 		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
@@ -95,7 +102,11 @@ namespace sf::IblHelper
 		environmentCubemap.size = envTextureUnfiltered.width;
 		environmentCubemap.storageDataType = dataType;
 		if (environmentCubemap.isInitialized)
+		{
+			GlState::ForgetTexture(environmentCubemap.gl_id);
+			RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, environmentCubemap.gl_id);
 			glDeleteTextures(1, &environmentCubemap.gl_id);
+		}
 		environmentCubemap.gl_id = envTextureUnfiltered.id;
 		environmentCubemap.isInitialized = true;
 	}
@@ -116,7 +127,7 @@ namespace sf::IblHelper
 			m_envTexture.width, m_envTexture.height, 6);
 
 		spmapComputeShader.Bind();
-		glBindTextureUnit(0, environmentCubemap.gl_id);
+		GlState::BindTexture(0, environmentCubemap.gl_id);
 
 		// Pre-filter rest of the mip chain.
 		const float deltaRoughness = 1.0f / glm::max(float(m_envTexture.levels - 1), 1.0f);
@@ -132,7 +143,11 @@ namespace sf::IblHelper
 		prefilterCubemap.size = m_envTexture.width;
 		prefilterCubemap.storageDataType = dataType;
 		if (prefilterCubemap.isInitialized)
+		{
+			GlState::ForgetTexture(prefilterCubemap.gl_id);
+			RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, prefilterCubemap.gl_id);
 			glDeleteTextures(1, &prefilterCubemap.gl_id);
+		}
 		prefilterCubemap.gl_id = m_envTexture.id;
 		prefilterCubemap.isInitialized = true;
 	}
@@ -148,7 +163,7 @@ namespace sf::IblHelper
 		Texture m_irmapTexture = createTexture(GL_TEXTURE_CUBE_MAP, kIrradianceMapSize, kIrradianceMapSize, internalFormat, false);
 
 		irmapComputeShader.Bind();
-		glBindTextureUnit(0, environmentCubemap.gl_id);
+		GlState::BindTexture(0, environmentCubemap.gl_id);
 		glBindImageTexture(0, m_irmapTexture.id, 0, GL_TRUE, 0, GL_WRITE_ONLY, internalFormat);
 		glDispatchCompute(m_irmapTexture.width / 32, m_irmapTexture.height / 32, 6);
 		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
@@ -156,7 +171,11 @@ namespace sf::IblHelper
 		irradianceCubemap.size = m_irmapTexture.width;
 		irradianceCubemap.storageDataType = dataType;
 		if (irradianceCubemap.isInitialized)
+		{
+			GlState::ForgetTexture(irradianceCubemap.gl_id);
+			RendererStats::ReleaseMemory(RendererStats::MemoryCategory::Textures, irradianceCubemap.gl_id);
 			glDeleteTextures(1, &irradianceCubemap.gl_id);
+		}
 		irradianceCubemap.gl_id = m_irmapTexture.id;
 		irradianceCubemap.isInitialized = true;
 	}
@@ -0,0 +1,80 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+#define PASS_BITS 2
+#define PROGRAM_BITS 8
+#define MATERIAL_BITS 10
+#define MESH_BITS 14
+#define PIECE_BITS 8
+#define DEPTH_BITS 21
+
+#define BIT_MASK(bits) ((1ull << (bits)) - 1ull)
+
+uint64_t sf::RenderQueue::ComputeKey(RenderPass pass, bool translucent, uint32_t programId, uint32_t materialId, uint32_t meshId, uint32_t piece, float normalizedDepth)
+{
+	uint64_t depth = (uint64_t)(glm::clamp(normalizedDepth, 0.0f, 1.0f) * (float)BIT_MASK(DEPTH_BITS));
+	uint64_t key = ((uint64_t)pass & BIT_MASK(PASS_BITS)) << 62;
+	if (!translucent)
+	{
+		key |= ((uint64_t)programId & BIT_MASK(PROGRAM_BITS)) << (MATERIAL_BITS + MESH_BITS + PIECE_BITS + DEPTH_BITS);
+		key |= ((uint64_t)materialId & BIT_MASK(MATERIAL_BITS)) << (MESH_BITS + PIECE_BITS + DEPTH_BITS);
+		key |= ((uint64_t)meshId & BIT_MASK(MESH_BITS)) << (PIECE_BITS + DEPTH_BITS);
+		key |= ((uint64_t)piece & BIT_MASK(PIECE_BITS)) << DEPTH_BITS;
+		key |= depth;
+	}
+	else
+	{
+		key |= 1ull << 61;
+		key |= (BIT_MASK(DEPTH_BITS) - depth) << (PROGRAM_BITS + MATERIAL_BITS + MESH_BITS + PIECE_BITS);
+		key |= ((uint64_t)programId & BIT_MASK(PROGRAM_BITS)) << (MATERIAL_BITS + MESH_BITS + PIECE_BITS);
+		key |= ((uint64_t)materialId & BIT_MASK(MATERIAL_BITS)) << (MESH_BITS + PIECE_BITS);
+		key |= ((uint64_t)meshId & BIT_MASK(MESH_BITS)) << PIECE_BITS;
+		key |= ((uint64_t)piece & BIT_MASK(PIECE_BITS));
+	}
+	return key;
+}
+
+uint32_t sf::RenderQueue::AddBounds(const glm::vec3& center, float radius)
+{
+	m_boundsX.push_back(center.x);
+	m_boundsY.push_back(center.y);
+	m_boundsZ.push_back(center.z);
+	m_boundsRadius.push_back(radius);
+	return (uint32_t)m_boundsRadius.size() - 1;
+}
+
+void sf::RenderQueue::Submit(uint64_t key, const DrawPacket& packet, uint32_t boundsIndex)
+{
+	m_sortEntries.push_back({ key, (uint32_t)m_packets.size(), boundsIndex });
+	m_packets.push_back(packet);
+}
+
+void sf::RenderQueue::Cull(const Frustum& frustum)
+{
+	m_boundsVisible.resize(m_boundsRadius.size());
+	frustum.CullSpheres(m_boundsX.data(), m_boundsY.data(), m_boundsZ.data(), m_boundsRadius.data(), (uint32_t)m_boundsRadius.size(), m_boundsVisible.data());
+
+	// packets without bounds are always drawn
+	m_sortEntries.erase(std::remove_if(m_sortEntries.begin(), m_sortEntries.end(), [this](const SortEntry& entry) {
+		return entry.boundsIndex != ~0U && !m_boundsVisible[entry.boundsIndex];
+	}), m_sortEntries.end());
+}
+
+void sf::RenderQueue::Sort()
+{
+	// sort small entries instead of moving whole packets around, packet index keeps it deterministic
+	std::sort(m_sortEntries.begin(), m_sortEntries.end(), [](const SortEntry& a, const SortEntry& b) {
+		return a.key < b.key || (a.key == b.key && a.packetIndex < b.packetIndex);
+	});
+}
+
+void sf::RenderQueue::Clear()
+{
+	m_packets.clear();
+	m_sortEntries.clear();
+	m_boundsX.clear();
+	m_boundsY.clear();
+	m_boundsZ.clear();
+	m_boundsRadius.clear();
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include <Renderer/Frustum.h>
+
+#define SKINNING_DISABLED 0xFFFFFFFFU
+
+namespace sf {
+
+	struct MeshData;
+	struct Material;
+	struct GlMaterial;
+
+	enum class RenderPass
+	{
+		World = 0
+	};
+
+	struct DrawPacket
+	{
+		const MeshData* meshData;
+		const Material* material;
+		GlMaterial* glMaterial;
+		uint32_t skinningOffset; // first vec4 of the skeleton in the frame skinning data, SKINNING_DISABLED if not animated
+		uint32_t piece;
+		glm::mat4 modelMatrix;
+	};
+
+	/*
+	 * Draws are submitted with a 64 bit key and executed in key order.
+	 * Opaque key:      | pass 2 | translucent 1 | program 8 | material 10 | mesh 14 | piece 8 | depth 21 |
+	 * Translucent key: | pass 2 | translucent 1 | inverted depth 21 | program 8 | material 10 | mesh 14 | piece 8 |
+	 * so opaque draws are grouped by state and go front to back inside each group,
+	 * while translucent draws go back to front. Materials sharing a program sort next to each other
+	 * so switching between them only changes uniforms. The material decides the vertex layout and
+	 * so the geometry arena, the mesh bits keep draws of the same mesh next to each other.
+	 */
+	class RenderQueue
+	{
+	private:
+		struct SortEntry
+		{
+			uint64_t key;
+			uint32_t packetIndex;
+			uint32_t boundsIndex;
+		};
+		std::vector<DrawPacket> m_packets;
+		std::vector<SortEntry> m_sortEntries;
+
+		// world space bounding spheres shared by the packets of one submission, kept apart for simd culling
+		std::vector<float> m_boundsX;
+		std::vector<float> m_boundsY;
+		std::vector<float> m_boundsZ;
+		std::vector<float> m_boundsRadius;
+		std::vector<uint8_t> m_boundsVisible;
+
+	public:
+		static uint64_t ComputeKey(RenderPass pass, bool translucent, uint32_t programId, uint32_t materialId, uint32_t meshId, uint32_t piece, float normalizedDepth);
+
+		uint32_t AddBounds(const glm::vec3& center, float radius);
+		void Submit(uint64_t key, const DrawPacket& packet, uint32_t boundsIndex = ~0U);
+		void Cull(const Frustum& frustum);
+		void Sort();
+		void Clear();
+
+		inline uint32_t Size() const { return (uint32_t)m_sortEntries.size(); }
+		inline uint64_t GetKey(uint32_t index) const { return m_sortEntries[index].key; }
+		inline const DrawPacket& Get(uint32_t index) const { return m_packets[m_sortEntries[index].packetIndex]; }
+	};
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <assert.h>
 #include <cstring>
+#include <cfloat>
+#include <algorithm>
 #include <iostream>
 #include <unordered_map>
 #include <glm/gtc/matrix_transform.hpp>
@@ -17,11 +19,21 @@
 
 #include <Renderer/GlSkybox.h>
 #include <Renderer/IblHelper.h>
+#include <Renderer/RenderQueue.h>
+#include <Renderer/GlRingBuffer.h>
+#include <Renderer/GlGeometryArena.h>
+#include <Renderer/Frustum.h>
+#include <Renderer/GlState.h>
+#include <Renderer/RendererStats.h>
+#include <Renderer/GpuResourcePool.h>
+#include <Renderer/GlTextBatcher.h>
+#include <Renderer/GlSpriteBatcher.h>
+#include <Renderer/GlFramebuffer.h>
 
-#include <SebTextFontData.h>
-#include <SebTextTextData.h>
 #include <SebTextRenderData.h>
 
+#define LOD_HYSTERESIS 0.25f
+
 namespace sf::Renderer
 {
 	const Window* window;
@@ -42,6 +54,9 @@ namespace sf::Renderer
 
 	glm::mat4 cameraView;
 	glm::mat4 cameraProjection;
+	float cameraFarClippingPlane;
+	Frustum cameraFrustum;
+	float lodThreshold = 1.0f; // pixels
 
 	glm::vec3 clearColor;
 
@@ -52,61 +67,85 @@ namespace sf::Renderer
 		uint32_t gl_vao;
 	};
 
-	struct ParticleSystemData
-	{
-		float emissionTimer = 0.0f;
-		float cycleCurrentTime = 0.0f;
-		uint32_t currentParticle = 0;
-		uint32_t particlesToWaitFor = 0;
-		uint32_t gl_ssbo;
-	};
+	// unit quad shared by sprites and text, positions in [-0.5, 0.5] and uvs in [0, 1]
+	MeshGpuData screenQuadGpuData = { ~0U, ~0U, ~0U };
 
-	struct SpriteQuad
-	{
-		uint32_t gl_vertexBuffer;
-		uint32_t gl_indexBuffer;
-		uint32_t gl_vao;
-		glm::vec2 vertices[8];
-		uint32_t indices[6];
-	};
-	SpriteQuad spriteQuad;
-	std::unordered_map<const sf::Bitmap*, GlTexture> spriteTextures;
+	GpuResourcePool<GlSpriteBatcher::Region> spriteRegions; // bitmap handles point here
+	GlSpriteBatcher spriteBatcher;
 	GlShader spriteShader;
 
-	struct TextGpuData
-	{
-		SebText::TextData textData;
-		uint32_t gl_ssbo_perInstanceData;
-		uint32_t gl_ssbo_bezierData;
-		uint32_t gl_ssbo_glyphMetaData;
-		uint32_t gl_ssbo_lastCharPerLine;
-		uint32_t gl_ubo_layoutData;
-		TextGpuData(const std::string& text, const SebText::FontData& fontData) : textData(text, fontData) {}
-	};
-	MeshGpuData textMeshGpuData = { ~0U, ~0U, ~0U };
-	std::unordered_map<unsigned, SebText::FontData> fontPathToFontData;
-	std::unordered_map<unsigned, std::unordered_map<unsigned, TextGpuData>> fontPathAndStringToTextData;
-	std::vector<SebText::GlyphRenderData> prevGlyphRenderData;
-	SebText::LayoutSettings textLayoutSettings;
+	GlTextBatcher textBatcher;
 	GlShader textShader;
+	GlShader msdfTextShader;
 
-	struct SharedGpuData
+	// written once per frame, binding 0, std140 block size is a multiple of 16
+	struct alignas(16) SharedGpuData
 	{
-		glm::mat4 modelMatrix;
 		glm::mat4 cameraMatrix;
 		glm::vec3 cameraPosition;
 		glm::vec2 windowSize;
 	};
-	uint32_t sharedGpuData_gl_ubo;
 	SharedGpuData sharedGpuData;
 
-	std::unordered_map<const sf::SkeletonData*, uint32_t> skeletonSsbos;
+	// written per draw, binding 1
+	struct ObjectGpuData
+	{
+		glm::mat4 modelMatrix;
+	};
+
+	GlRingBuffer frameRingBuffer;
+	// headless windows have nothing to present, frames are drawn here and read back
+	GlFramebuffer offscreenTarget;
+	int32_t uniformBufferOffsetAlignment;
+	int32_t storageBufferOffsetAlignment;
+
+	// bones of every skeleton drawn this frame go in one buffer uploaded before the render queue is drawn,
+	// draw packets only carry where their skeleton starts
+	struct SkeletonGpuData
+	{
+		uint32_t generation = ~0U; // skinningGeneration the bones were packed in
+		uint32_t offset = 0; // first vec4 in skinningData
+	};
+	GpuResourcePool<SkeletonGpuData> skeletonGpuData;
+	std::vector<glm::vec4> skinningData;
+	uint32_t skinningGeneration = 0;
+
+	// every mesh lives in the geometry arena of its vertex buffer layout, the id is its slot in the pool.
+	// meshes with less than 65536 vertices go in a separate arena per layout with 16 bit indices
+	struct ArenaMeshGpuData
+	{
+		uint32_t id;
+		GlGeometryArena* arena;
+	};
+	std::unordered_map<const BufferLayout*, GlGeometryArena*> geometryArenas;
+	std::unordered_map<const BufferLayout*, GlGeometryArena*> shortIndexGeometryArenas;
+	GpuResourcePool<ArenaMeshGpuData> meshGpuData;
 
-	std::unordered_map<const sf::MeshData*, MeshGpuData> meshGpuData;
+	std::vector<Transform> particleInitialTransforms; // scratch for emission
 
-	std::unordered_map<void*, ParticleSystemData> particleSystemData;
+	// one gl material per vertex buffer layout the material is used with, there are rarely more than one
+	struct MaterialGpuData
+	{
+		std::vector<std::pair<const BufferLayout*, GlMaterial*>> variants;
+	};
+	GpuResourcePool<MaterialGpuData> materials;
+	// variants created by PrewarmMaterial whose programs may still be compiling
+	std::vector<GlMaterial*> prewarmingMaterials;
+
+	// released resources are deleted once every frame that could still be using them is done
+	enum class GpuResourceType
+	{
+		Mesh, Skeleton, Bitmap, Material
+	};
+	struct PendingRelease
+	{
+		GpuResourceType type;
+		GpuHandle handle;
+		uint32_t framesLeft;
+	};
+	std::vector<PendingRelease> pendingReleases;
 
-	std::unordered_map<const Material*, std::unordered_map<const BufferLayout*, GlMaterial*>> materials;
+	RenderQueue renderQueue;
 
 	struct EnvironmentData
 	{
@@ -131,148 +170,350 @@ namespace sf::Renderer
 	bool debugDrawEnabled = false;
 	glm::vec3 debugDrawColor = { 0.0f, 0.0f, 0.0f };
 
-	void TransferVertexData(const sf::MeshData* mesh)
+	inline const ArenaMeshGpuData& GetMeshGpuData(const sf::MeshData* mesh)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, meshGpuData[mesh].gl_vertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, mesh->vertexCount * mesh->vertexBufferLayout->GetSize(), mesh->vertexBuffer, GL_STATIC_DRAW);
-
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshGpuData[mesh].gl_indexBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->indexCount * sizeof(uint32_t), mesh->indexBuffer, GL_STATIC_DRAW);
+		const ArenaMeshGpuData* gpuData = meshGpuData.Get(mesh->gpuHandle, mesh);
+		assert(gpuData != nullptr);
+		return *gpuData;
 	}
 
-	void CreateMeshGpuData(const sf::MeshData* mesh)
+	const ArenaMeshGpuData& GetOrCreateMeshGpuData(const sf::MeshData* mesh)
 	{
-		meshGpuData[mesh] = MeshGpuData();
-		glGenVertexArrays(1, &meshGpuData[mesh].gl_vao);
-		glGenBuffers(1, &meshGpuData[mesh].gl_vertexBuffer);
-		glGenBuffers(1, &meshGpuData[mesh].gl_indexBuffer);
-
-		glBindVertexArray(meshGpuData[mesh].gl_vao);
-		glBindBuffer(GL_ARRAY_BUFFER, meshGpuData[mesh].gl_vertexBuffer);
+		const ArenaMeshGpuData* gpuData = meshGpuData.Get(mesh->gpuHandle, mesh);
+		if (gpuData != nullptr)
+			return *gpuData;
+
+		const BufferLayout* layout = mesh->vertexBufferLayout;
+		bool shortIndices = mesh->vertexCount < 65536;
+		std::unordered_map<const BufferLayout*, GlGeometryArena*>& arenas = shortIndices ? shortIndexGeometryArenas : geometryArenas;
+		if (arenas.find(layout) == arenas.end())
+		{
+			arenas[layout] = new GlGeometryArena();
+			arenas[layout]->Create(layout, shortIndices ? DataType::u16 : DataType::u32);
+		}
 
-		// update vertices
-		glBufferData(GL_ARRAY_BUFFER, mesh->vertexCount * mesh->vertexBufferLayout->GetSize(), mesh->vertexBuffer, GL_STATIC_DRAW);
+		mesh->gpuHandle = meshGpuData.Add(mesh, { 0, arenas[layout] });
+		ArenaMeshGpuData* newGpuData = meshGpuData.Get(mesh->gpuHandle, mesh);
+		newGpuData->id = mesh->gpuHandle.index;
+		newGpuData->arena->Add(newGpuData->id, mesh);
+		return *newGpuData;
+	}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshGpuData[mesh].gl_indexBuffer);
-		// update indices to draw
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->indexCount * sizeof(uint32_t), mesh->indexBuffer, GL_STATIC_DRAW);
+	uint32_t GetOrPackSkinningOffset(const sf::SkeletonData* skeleton)
+	{
+		SkeletonGpuData* gpuData = skeletonGpuData.Get(skeleton->gpuHandle, skeleton);
+		if (gpuData == nullptr)
+		{
+			skeleton->gpuHandle = skeletonGpuData.Add(skeleton, SkeletonGpuData());
+			gpuData = skeletonGpuData.Get(skeleton->gpuHandle, skeleton);
+		}
+		if (gpuData->generation == skinningGeneration) // already packed for another piece or entity
+			return gpuData->offset;
 
-		const std::vector<BufferComponentInfo>& components = mesh->vertexBufferLayout->GetComponentInfos();
-		for (int i = 0; i < components.size(); i++)
+		gpuData->generation = skinningGeneration;
+		gpuData->offset = (uint32_t)skinningData.size();
+		switch (GlShader::skinningFormat)
 		{
-			glEnableVertexAttribArray(i);
-			switch (components[i].dataType)
+		case SkinningFormat::Matrix4x4:
+			for (const glm::mat4& matrix : skeleton->m_skinningMatrices)
+				skinningData.insert(skinningData.end(), { matrix[0], matrix[1], matrix[2], matrix[3] });
+			break;
+		case SkinningFormat::Matrix3x4:
+			for (const glm::mat4& matrix : skeleton->m_skinningMatrices)
 			{
-				case DataType::f32:
-					glVertexAttribPointer(i, 1, GL_FLOAT, GL_FALSE, mesh->vertexBufferLayout->GetSize(), (void*)(uint64_t)components[i].byteOffset);
-					break;
-				case DataType::vec2f32:
-					glVertexAttribPointer(i, 2, GL_FLOAT, GL_FALSE, mesh->vertexBufferLayout->GetSize(), (void*)(uint64_t)components[i].byteOffset);
-					break;
-				case DataType::vec3f32:
-					glVertexAttribPointer(i, 3, GL_FLOAT, GL_FALSE, mesh->vertexBufferLayout->GetSize(), (void*)(uint64_t)components[i].byteOffset);
-					break;
-				case DataType::vec4f32:
-					glVertexAttribPointer(i, 4, GL_FLOAT, GL_FALSE, mesh->vertexBufferLayout->GetSize(), (void*)(uint64_t)components[i].byteOffset);
-					break;
-				case DataType::vec4u8:
-					glVertexAttribPointer(i, 4, GL_UNSIGNED_BYTE, GL_FALSE, mesh->vertexBufferLayout->GetSize(), (void*)(uint64_t)components[i].byteOffset);
-					break;
-				case DataType::vec4u16:
-					glVertexAttribPointer(i, 4, GL_UNSIGNED_SHORT, GL_FALSE, mesh->vertexBufferLayout->GetSize(), (void*)(uint64_t)components[i].byteOffset);
-					break;
-				default:
-					std::cout << "[Renderer] Vertex attribute skipped" << std::endl;
-					assert(false);
-					break;
+				for (uint32_t row = 0; row < 3; row++)
+					skinningData.push_back(glm::vec4(matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]));
 			}
+			break;
+		case SkinningFormat::DualQuaternion:
+			for (const glm::mat4& matrix : skeleton->m_skinningMatrices)
+			{
+				glm::mat3 rotationMatrix = glm::mat3(glm::normalize(glm::vec3(matrix[0])), glm::normalize(glm::vec3(matrix[1])), glm::normalize(glm::vec3(matrix[2])));
+				glm::quat real = glm::normalize(glm::quat_cast(rotationMatrix));
+				glm::quat dual = glm::quat(0.0f, matrix[3].x, matrix[3].y, matrix[3].z) * real * 0.5f;
+				skinningData.push_back(glm::vec4(real.x, real.y, real.z, real.w));
+				skinningData.push_back(glm::vec4(dual.x, dual.y, dual.z, dual.w));
+			}
+			break;
 		}
-
-		TransferVertexData(mesh);
-		glBindVertexArray(0);
+		return gpuData->offset;
 	}
 
-	void CreateSpriteGpuData()
+	void DeleteReleasedResource(const PendingRelease& release)
 	{
-		Material spriteMat;
-		spriteMat.vertShaderFilePath = "assets/shaders/sprite.vert";
-		spriteMat.fragShaderFilePath = "assets/shaders/sprite.frag";
-		spriteShader.Create(spriteMat, &positionUvVertexLayout);
-
-		// quad uvs and indices won't change
-		spriteQuad.vertices[1] = { 0.0f, 0.0f };
-		spriteQuad.vertices[3] = { 0.0f, 1.0f };
-		spriteQuad.vertices[5] = { 1.0f, 1.0f };
-		spriteQuad.vertices[7] = { 1.0f, 0.0f };
+		switch (release.type)
+		{
+		case GpuResourceType::Mesh:
+		{
+			ArenaMeshGpuData& gpuData = meshGpuData.GetRetired(release.handle);
+			gpuData.arena->Remove(gpuData.id);
+			meshGpuData.Remove(release.handle);
+			break;
+		}
+		case GpuResourceType::Skeleton:
+			skeletonGpuData.Remove(release.handle);
+			break;
+		case GpuResourceType::Bitmap:
+			spriteBatcher.RemoveBitmap(spriteRegions.GetRetired(release.handle));
+			spriteRegions.Remove(release.handle);
+			break;
+		case GpuResourceType::Material:
+			for (auto& variant : materials.GetRetired(release.handle).variants)
+			{
+				auto prewarmingIterator = std::find(prewarmingMaterials.begin(), prewarmingMaterials.end(), variant.second);
+				if (prewarmingIterator != prewarmingMaterials.end())
+					prewarmingMaterials.erase(prewarmingIterator);
+				variant.second->Delete();
+				delete variant.second;
+			}
+			materials.Remove(release.handle);
+			break;
+		}
+	}
 
-		spriteQuad.indices[0] = 0;
-		spriteQuad.indices[1] = 1;
-		spriteQuad.indices[2] = 2;
-		spriteQuad.indices[3] = 2;
-		spriteQuad.indices[4] = 3;
-		spriteQuad.indices[5] = 0;
+	void ProcessPendingReleases(bool deleteAll)
+	{
+		for (int i = (int)pendingReleases.size() - 1; i > -1; i--)
+		{
+			pendingReleases[i].framesLeft--;
+			if (pendingReleases[i].framesLeft > 0 && !deleteAll)
+				continue;
+			DeleteReleasedResource(pendingReleases[i]);
+			pendingReleases.erase(pendingReleases.begin() + i);
+		}
+	}
 
-		glGenVertexArrays(1, &spriteQuad.gl_vao);
-		glGenBuffers(1, &spriteQuad.gl_vertexBuffer);
-		glGenBuffers(1, &spriteQuad.gl_indexBuffer);
+	void CreateScreenQuadGpuData()
+	{
+		glGenVertexArrays(1, &screenQuadGpuData.gl_vao);
+		glGenBuffers(1, &screenQuadGpuData.gl_vertexBuffer);
+		glGenBuffers(1, &screenQuadGpuData.gl_indexBuffer);
 
-		glBindVertexArray(spriteQuad.gl_vao);
-		glBindBuffer(GL_ARRAY_BUFFER, spriteQuad.gl_vertexBuffer);
+		GlState::BindVertexArray(screenQuadGpuData.gl_vao);
+		GlState::BindBuffer(GL_ARRAY_BUFFER, screenQuadGpuData.gl_vertexBuffer);
 
 		// update vertices
-		glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * 2 * 4, spriteQuad.vertices, GL_DYNAMIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(SebText::Vertex), SebText::MeshVertices, GL_STATIC_DRAW);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, spriteQuad.gl_indexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, screenQuadGpuData.gl_indexBuffer);
 		// update indices to draw
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * 6, spriteQuad.indices, GL_DYNAMIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(unsigned int), SebText::MeshIndices, GL_STATIC_DRAW);
+		RendererStats::Upload(RendererStats::UploadSite::StaticGeometry, 4 * sizeof(SebText::Vertex) + 6 * sizeof(unsigned int));
+
 		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2) * 2, (void*)0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SebText::Vertex), (void*)0);
 		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2) * 2, (void*)sizeof(glm::vec2));
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SebText::Vertex), (void*)(sizeof(glm::vec3)));
+
+		GlState::BindVertexArray(0);
+	}
+
+	GlMaterial* GetOrCreateMaterialVariant(const Material* material, const BufferLayout* vertexBufferLayout, bool waitForShader)
+	{
+		assert(material != nullptr);
+		MaterialGpuData* gpuData = materials.Get(material->gpuHandle, material);
+		if (gpuData == nullptr)
+		{
+			material->gpuHandle = materials.Add(material, MaterialGpuData());
+			gpuData = materials.Get(material->gpuHandle, material);
+		}
+
+		/* vertexBufferLayout can be null if using mesh shading */
+		for (const auto& variant : gpuData->variants)
+		{
+			if (variant.first == vertexBufferLayout)
+				return variant.second;
+		}
+
+		GlMaterial* newMaterial = new GlMaterial();
+		newMaterial->Create(material, vertexBufferLayout, waitForShader);
+		gpuData->variants.push_back({ vertexBufferLayout, newMaterial });
+		return newMaterial;
+	}
+
+	GlMaterial* GetOrCreateMaterial(const Material* material, const BufferLayout* vertexBufferLayout)
+	{
+		GlMaterial* glMaterial = GetOrCreateMaterialVariant(material, vertexBufferLayout, true);
+		// drawn before its prewarm finished, waits for the program
+		glMaterial->Finish();
+		return glMaterial;
+	}
 
-		glBindVertexArray(0);
+	void UploadSharedGpuData()
+	{
+		GlRingBuffer::Allocation allocation = frameRingBuffer.Allocate(sizeof(SharedGpuData), uniformBufferOffsetAlignment);
+		memcpy(allocation.pointer, &sharedGpuData, sizeof(SharedGpuData));
+		GlState::BindBufferRange(GL_UNIFORM_BUFFER, 0, allocation.gl_buffer, allocation.offset, sizeof(SharedGpuData));
 	}
 
-	void CreateTextGpuData(const char* fontPath, const char* string, const SebText::TextRenderData& trd, const SebText::TextData& td)
+	void UploadObjectGpuData(const glm::mat4& modelMatrix)
 	{
-		unsigned fontPathHash = Hash::SimpleStringHash(fontPath);
-		unsigned stringHash = Hash::SimpleStringHash(string);
+		GlRingBuffer::Allocation allocation = frameRingBuffer.Allocate(sizeof(ObjectGpuData), uniformBufferOffsetAlignment);
+		((ObjectGpuData*)allocation.pointer)->modelMatrix = modelMatrix;
+		GlState::BindBufferRange(GL_UNIFORM_BUFFER, 1, allocation.gl_buffer, allocation.offset, sizeof(ObjectGpuData));
+	}
 
-		std::vector<SebText::InstanceData> instanceData;
-		SebText::CreateInstanceData(instanceData, fontPathAndStringToTextData[fontPathHash].at(stringHash).textData, prevGlyphRenderData, textLayoutSettings);
+	void UploadInstanceGpuData(uint32_t firstPacket, uint32_t instanceCount)
+	{
+		GlRingBuffer::Allocation allocation = frameRingBuffer.Allocate(instanceCount * sizeof(glm::mat4), storageBufferOffsetAlignment);
+		glm::mat4* modelMatrices = (glm::mat4*)allocation.pointer;
+		for (uint32_t i = 0; i < instanceCount; i++)
+			modelMatrices[i] = renderQueue.Get(firstPacket + i).modelMatrix;
+		GlState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCE_DATA_SSBO_BINDING, allocation.gl_buffer, allocation.offset, instanceCount * sizeof(glm::mat4));
+
+		GlRingBuffer::Allocation skinningAllocation = frameRingBuffer.Allocate(instanceCount * sizeof(uint32_t), storageBufferOffsetAlignment);
+		uint32_t* skinningOffsets = (uint32_t*)skinningAllocation.pointer;
+		for (uint32_t i = 0; i < instanceCount; i++)
+			skinningOffsets[i] = renderQueue.Get(firstPacket + i).skinningOffset;
+		GlState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCE_SKINNING_SSBO_BINDING, skinningAllocation.gl_buffer, skinningAllocation.offset, instanceCount * sizeof(uint32_t));
+	}
 
-		glGenBuffers(1, &(fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_perInstanceData));
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_perInstanceData);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, instanceData.size() * sizeof(SebText::InstanceData), instanceData.data(), GL_STATIC_DRAW);
+	inline bool CanShareMultiDraw(const DrawPacket& a, const DrawPacket& b)
+	{
+		// same material means same vertex buffer layout, the index type still has to match
+		return b.meshData != nullptr && a.glMaterial == b.glMaterial &&
+			GetMeshGpuData(a.meshData).arena == GetMeshGpuData(b.meshData).arena;
+	}
 
-		glGenBuffers(1, &(fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_bezierData));
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_bezierData);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, trd.BezierPoints.size() * sizeof(glm::vec2), trd.BezierPoints.data(), GL_STATIC_DRAW);
+	inline void GetPieceIndexRange(const MeshData* meshData, uint32_t piece, uint32_t& drawStart, uint32_t& drawEnd)
+	{
+		drawStart = meshData->pieces[piece];
+		drawEnd = meshData->pieceCount > piece + 1 ? meshData->pieces[piece + 1] : meshData->indexCount;
+	}
 
-		glGenBuffers(1, &(fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_glyphMetaData));
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_glyphMetaData);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, trd.GlyphMetaData.size() * sizeof(int), trd.GlyphMetaData.data(), GL_STATIC_DRAW);
+	inline GLenum GetPrimitiveMode(const DrawPacket& packet)
+	{
+		if (packet.material->UsesTessellation())
+		{
+			assert(packet.meshData->vertexCountPerPrimitive == packet.material->tessPatchVertexCount);
+			glPatchParameteri(GL_PATCH_VERTICES, packet.material->tessPatchVertexCount);
+			return GL_PATCHES;
+		}
+		assert(packet.meshData->vertexCountPerPrimitive == 3);
+		return GL_TRIANGLES;
+	}
 
-		glGenBuffers(1, &(fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_lastCharPerLine));
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_lastCharPerLine);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, td.LastCharacterPerLine.size() * sizeof(int), td.LastCharacterPerLine.data(), GL_STATIC_DRAW);
+	inline float GetMaxScale(const glm::mat4& matrix)
+	{
+		return glm::sqrt(glm::max(glm::max(glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+			glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1]))), glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))));
+	}
 
-		glGenBuffers(1, &(fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ubo_layoutData));
-		glBindBuffer(GL_UNIFORM_BUFFER, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ubo_layoutData);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(SebText::LayoutSettings), &textLayoutSettings, GL_DYNAMIC_DRAW);
+	// skinned vertices are weighted averages of bone transformed positions, so they stay inside the box around all transformed bone spheres
+	void ComputeSkinnedBounds(const MeshData* meshData, const SkeletonData* skeletonData, glm::vec3& outCenter, float& outRadius)
+	{
+		glm::vec3 boxMin = glm::vec3(FLT_MAX);
+		glm::vec3 boxMax = glm::vec3(-FLT_MAX);
+		uint32_t boneCount = (uint32_t)meshData->boneBoundingSpheres.size();
+		if (boneCount > skeletonData->m_skinningMatrices.size())
+			boneCount = (uint32_t)skeletonData->m_skinningMatrices.size();
+		for (uint32_t i = 0; i < boneCount; i++)
+		{
+			const glm::vec4& sphere = meshData->boneBoundingSpheres[i];
+			if (sphere.w < 0.0f)
+				continue;
+			const glm::mat4& skinningMatrix = skeletonData->m_skinningMatrices[i];
+			glm::vec3 center = skinningMatrix * glm::vec4(glm::vec3(sphere), 1.0f);
+			float radius = sphere.w * GetMaxScale(skinningMatrix);
+			boxMin = glm::min(boxMin, center - radius);
+			boxMax = glm::max(boxMax, center + radius);
+		}
+		if (boxMin.x > boxMax.x)
+		{
+			outCenter = meshData->boundingSphereCenter;
+			outRadius = meshData->boundingSphereRadius;
+			return;
+		}
+		outCenter = (boxMin + boxMax) * 0.5f;
+		outRadius = glm::length(boxMax - boxMin) * 0.5f;
 	}
 
-	GlMaterial* GetOrCreateMaterial(const Material* material, const BufferLayout* vertexBufferLayout)
+	float ComputeNormalizedDepth(const glm::vec3& worldPosition)
 	{
-		assert(material != nullptr);
-		/* vertexBufferLayout can be null if using mesh shading */
-		if (materials.find(material) != materials.end() && materials[material].find(vertexBufferLayout) != materials[material].end())
-			return materials[material][vertexBufferLayout];
+		float viewDepth = -(cameraView * glm::vec4(worldPosition, 1.0f)).z;
+		return viewDepth / cameraFarClippingPlane;
+	}
 
-		GlMaterial* newMaterial = new GlMaterial();
-		newMaterial->Create(material, vertexBufferLayout);
-		materials[material][vertexBufferLayout] = newMaterial;
-		return newMaterial;
+	// coarsest lod whose simplification error stays under lodThreshold pixels at the bounding sphere center, going
+	// coarser than the current lod needs some margin so meshes sitting at a threshold don't swap every frame
+	const MeshData* SelectLod(const MeshData* meshData, uint32_t& currentLod, const glm::vec3& worldCenter, float scale)
+	{
+		if (meshData->lods.empty())
+			return meshData;
+		float viewDepth = -(cameraView * glm::vec4(worldCenter, 1.0f)).z;
+		float clipW = glm::max(cameraProjection[2][3] * -viewDepth + cameraProjection[3][3], 1e-4f); // depth for perspective, 1 for orthographic
+		float pixelsPerUnit = scale * cameraProjection[1][1] * sharedGpuData.windowSize.y * 0.5f / clipW;
+
+		uint32_t lod = 0;
+		while (lod < meshData->lods.size())
+		{
+			float threshold = lod + 1 > currentLod ? lodThreshold * (1.0f - LOD_HYSTERESIS) : lodThreshold;
+			if (meshData->lods[lod]->simplificationError * pixelsPerUnit > threshold)
+				break;
+			lod++;
+		}
+		currentLod = lod;
+		return lod == 0 ? meshData : meshData->lods[lod - 1];
+	}
+
+	void DrawPacketGeometry(const DrawPacket& packet)
+	{
+		if (packet.meshData == nullptr)
+		{
+			glDrawMeshTasksNV(0, packet.material->meshWorkGroupCount);
+			RendererStats::Draw(1, 0); // primitives are generated on the gpu
+			return;
+		}
+
+		const ArenaMeshGpuData& gpuData = GetMeshGpuData(packet.meshData);
+		const GlGeometryArena::Allocation& allocation = gpuData.arena->Get(gpuData.id);
+		uint32_t drawEnd, drawStart;
+		GetPieceIndexRange(packet.meshData, packet.piece, drawStart, drawEnd);
+		glDrawElementsInstancedBaseVertex(GetPrimitiveMode(packet), drawEnd - drawStart, gpuData.arena->GetGlIndexType(),
+			(void*)((uint64_t)(allocation.firstIndex + drawStart) * gpuData.arena->GetIndexSize()), 1, allocation.baseVertex);
+		RendererStats::Draw(1, (drawEnd - drawStart) / packet.meshData->vertexCountPerPrimitive);
+	}
+
+	struct DrawElementsIndirectCommand
+	{
+		uint32_t count;
+		uint32_t instanceCount;
+		uint32_t firstIndex;
+		int32_t baseVertex;
+		uint32_t baseInstance;
+	};
+
+	void DrawPacketsIndirect(uint32_t firstPacket, uint32_t packetCount)
+	{
+		// model matrices go in packet order so each command's base instance is its first packet in the bucket
+		UploadInstanceGpuData(firstPacket, packetCount);
+
+		GlRingBuffer::Allocation commandAllocation = frameRingBuffer.Allocate(packetCount * sizeof(DrawElementsIndirectCommand), sizeof(DrawElementsIndirectCommand));
+		DrawElementsIndirectCommand* commands = (DrawElementsIndirectCommand*)commandAllocation.pointer;
+		uint32_t commandCount = 0;
+		uint64_t primitiveCount = 0;
+		for (uint32_t i = 0; i < packetCount;)
+		{
+			const DrawPacket& packet = renderQueue.Get(firstPacket + i);
+			uint32_t instanceCount = 1;
+			while (i + instanceCount < packetCount &&
+				renderQueue.Get(firstPacket + i + instanceCount).meshData == packet.meshData &&
+				renderQueue.Get(firstPacket + i + instanceCount).piece == packet.piece)
+				instanceCount++;
+
+			const ArenaMeshGpuData& gpuData = GetMeshGpuData(packet.meshData);
+			const GlGeometryArena::Allocation& allocation = gpuData.arena->Get(gpuData.id);
+			uint32_t drawEnd, drawStart;
+			GetPieceIndexRange(packet.meshData, packet.piece, drawStart, drawEnd);
+			commands[commandCount++] = { drawEnd - drawStart, instanceCount, allocation.firstIndex + drawStart, (int32_t)allocation.baseVertex, i };
+			primitiveCount += (uint64_t)(drawEnd - drawStart) / packet.meshData->vertexCountPerPrimitive * instanceCount;
+			i += instanceCount;
+		}
+
+		const GlGeometryArena* arena = GetMeshGpuData(renderQueue.Get(firstPacket).meshData).arena;
+		GlState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, commandAllocation.gl_buffer);
+		glMultiDrawElementsIndirect(GetPrimitiveMode(renderQueue.Get(firstPacket)), arena->GetGlIndexType(), (void*)(uint64_t)commandAllocation.offset, commandCount, 0);
+		RendererStats::Draw(packetCount, primitiveCount);
 	}
 
 #ifdef SF_DEBUG
@@ -331,8 +572,7 @@ bool sf::Renderer::Initialize(const Window& windowArg, const glm::vec3& clearCol
 	clearColor = clearColorArg;
 	window = &windowArg;
 
-	materials.clear();
-	materials.reserve(64);
+	materials.Clear();
 
 	if (!gladLoadGLLoader((GLADloadproc)window->GetOpenGlFunctionAddress()))
 	{
@@ -358,25 +598,52 @@ bool sf::Renderer::Initialize(const Window& windowArg, const glm::vec3& clearCol
 	std::cout << "[Renderer] Renderer: " << glGetString(GL_RENDERER) << std::endl;
 	std::cout << "[Renderer] OpenGL version supported " << glGetString(GL_VERSION) << std::endl;
 
-	glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
-	glEnable(GL_BLEND);
+	GlShader::parallelCompileSupported = false;
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for (GLint i = 0; i < extensionCount; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (strcmp(extension, "GL_KHR_parallel_shader_compile") == 0 || strcmp(extension, "GL_ARB_parallel_shader_compile") == 0)
+		{
+			// not exposed by glad, let the driver pick the number of compiler threads
+			typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+			PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)
+				((void* (*)(const char*))window->GetOpenGlFunctionAddress())(extension[3] == 'K' ? "glMaxShaderCompilerThreadsKHR" : "glMaxShaderCompilerThreadsARB");
+			if (maxShaderCompilerThreads != nullptr)
+				maxShaderCompilerThreads(0xFFFFFFFF);
+			GlShader::parallelCompileSupported = true;
+			break;
+		}
+	}
+	std::cout << "[Renderer] Parallel shader compilation " << (GlShader::parallelCompileSupported ? "supported" : "not supported") << std::endl;
+
+	GlState::Invalidate();
+	GlState::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+	GlState::BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
+	GlState::SetEnabled(GL_BLEND, true);
 
-	glPolygonMode(GL_FRONT, GL_FILL);
+	GlState::PolygonMode(GL_FRONT, GL_FILL);
 	glCullFace(GL_BACK);
 
-	glDepthMask(GL_TRUE);
-	glEnable(GL_DEPTH_TEST);
+	GlState::DepthMask(true);
+	GlState::SetEnabled(GL_DEPTH_TEST, true);
 	glDepthFunc(GL_LESS);
 
 	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	glClearColor(clearColor.r, clearColor.g, clearColor.b, 0.0f);
 	glViewport(0, 0, window->GetWidth(), window->GetHeight());
+	if (window->IsHeadless() && !offscreenTarget.Create(window->GetWidth(), window->GetHeight()))
+		return false;
 
 	sf::Renderer::aspectRatio = (float)(window->GetWidth()) / (float)(window->GetHeight());
 
-	glGenBuffers(1, &sharedGpuData_gl_ubo);
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferOffsetAlignment);
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageBufferOffsetAlignment);
+	frameRingBuffer.Create(4096 * uniformBufferOffsetAlignment);
+	textBatcher.Create();
+	spriteBatcher.Create();
 
 	rendererUniformVector.resize(3);
 	rendererUniformVector[(uint32_t)RendererUniformData::BrdfLUT] = &environmentData.lookupTexture;
@@ -394,13 +661,25 @@ void sf::Renderer::OnResize()
 
 void sf::Renderer::Predraw()
 {
+	if (offscreenTarget.isInitialized)
+		offscreenTarget.Bind();
+
 	// clear
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	// anything outside the renderer may have touched the state since last frame
+	GlState::Invalidate();
+	frameRingBuffer.BeginFrame();
+
+	IsPrewarmingDone();
+
 	sharedGpuData.windowSize = glm::vec2((float)window->GetWidth(), (float)window->GetHeight());
 
 	if (!activeCameraEntity)
+	{
+		UploadSharedGpuData();
 		return;
+	}
 
 	// camera matrices
 	const Transform& transformComponent = activeCameraEntity.GetComponent<Transform>();
@@ -434,16 +713,61 @@ void sf::Renderer::Predraw()
 				cameraComponent.farClippingPlane);
 	}
 
+	cameraFarClippingPlane = cameraComponent.farClippingPlane;
 	cameraView = (glm::mat4)glm::conjugate(transformComponent.rotation);
 	cameraView = glm::translate(cameraView, -transformComponent.position);
 
 	sharedGpuData.cameraMatrix = cameraProjection * cameraView;
 	sharedGpuData.cameraPosition = transformComponent.position;
+	cameraFrustum.ExtractFromMatrix(sharedGpuData.cameraMatrix);
+
+	UploadSharedGpuData();
 }
 
 void sf::Renderer::Postdraw()
 {
 	drawLineLines.clear();
+	frameRingBuffer.EndFrame();
+	ProcessPendingReleases(false);
+	GlState::EndFrame();
+	RendererStats::EndFrame();
+}
+
+const sf::RendererStats::Frame& sf::Renderer::GetLastFrameStats()
+{
+	return RendererStats::GetLastFrame();
+}
+
+void sf::Renderer::ReadFrame(Bitmap& target)
+{
+	uint32_t width = window->GetWidth();
+	uint32_t height = window->GetHeight();
+	if (target.buffer == nullptr || target.dataType != DataType::u8 || target.channelCount != 3 || target.width != width || target.height != height)
+	{
+		free(target.buffer);
+		target.CreateSolid(DataType::u8, 3, width, height);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, offscreenTarget.isInitialized ? offscreenTarget.gl_id : 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, target.buffer);
+
+	// gl rows start at the bottom
+	uint32_t rowSize = width * 3;
+	std::vector<uint8_t> row(rowSize);
+	for (uint32_t y = 0; y < height / 2; y++)
+	{
+		uint8_t* a = (uint8_t*)target.buffer + y * rowSize;
+		uint8_t* b = (uint8_t*)target.buffer + (height - 1 - y) * rowSize;
+		memcpy(row.data(), a, rowSize);
+		memcpy(a, b, rowSize);
+		memcpy(b, row.data(), rowSize);
+	}
+}
+
+void sf::Renderer::SetSkinningFormat(SkinningFormat format)
+{
+	GlShader::skinningFormat = format;
 }
 
 void sf::Renderer::SetClearColor(const glm::vec3& clearColorArg)
@@ -457,6 +781,11 @@ const glm::vec3& sf::Renderer::GetClearColor()
 	return clearColor;
 }
 
+void sf::Renderer::SetLodThreshold(float pixels)
+{
+	lodThreshold = pixels;
+}
+
 void sf::Renderer::SetActiveCameraEntity(Entity cameraEntity)
 {
 	activeCameraEntity = cameraEntity;
@@ -494,45 +823,34 @@ void sf::Renderer::DrawMesh(Mesh& mesh, Transform& transform)
 	if (mesh.meshData != nullptr && mesh.meshData->vertexCount == 0)
 		return;
 
-	sharedGpuData.modelMatrix = transform.ComputeMatrix();
-	glBindBuffer(GL_UNIFORM_BUFFER, sharedGpuData_gl_ubo);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(SharedGpuData), &sharedGpuData, GL_DYNAMIC_DRAW);
+	glm::mat4 modelMatrix = transform.ComputeMatrix();
+	float depth = ComputeNormalizedDepth(transform.position);
 
 	if (mesh.meshData == nullptr)
 	{
 		assert(mesh.materials.size() == 1);
 		assert(mesh.materials[0]->UsesMeshShader());
 		GlMaterial* materialToUse = GetOrCreateMaterial(mesh.materials[0], nullptr);
-		materialToUse->Bind(rendererUniformVector);
-		glDrawMeshTasksNV(0, mesh.materials[0]->meshWorkGroupCount);
+		renderQueue.Submit(RenderQueue::ComputeKey(RenderPass::World, mesh.materials[0]->IsTransparent(), materialToUse->m_shader->GetId(), materialToUse->m_id, 0, 0, depth),
+			{ nullptr, mesh.materials[0], materialToUse, SKINNING_DISABLED, 0, modelMatrix });
 		return;
 	}
 
-	if (meshGpuData.find(mesh.meshData) == meshGpuData.end()) // create mesh data if not there
-		CreateMeshGpuData(mesh.meshData);
-
-	for (uint32_t i = 0; i < mesh.meshData->pieceCount; i++)
+	const MeshData* meshData = mesh.meshData;
+	uint32_t boundsIndex = ~0U;
+	if (mesh.meshData->HasBounds())
 	{
-		GlMaterial* materialToUse = GetOrCreateMaterial(mesh.materials[i], mesh.meshData->vertexBufferLayout);
-		materialToUse->Bind(rendererUniformVector);
-
-		uint32_t drawEnd, drawStart;
-		drawStart = mesh.meshData->pieces[i];
-		drawEnd = mesh.meshData->pieceCount > i + 1 ? mesh.meshData->pieces[i + 1] : mesh.meshData->indexCount;
+		glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(mesh.meshData->boundingSphereCenter, 1.0f));
+		boundsIndex = renderQueue.AddBounds(center, mesh.meshData->boundingSphereRadius * glm::abs(transform.scale));
+		meshData = SelectLod(mesh.meshData, mesh.lod, center, glm::abs(transform.scale));
+	}
+	uint32_t meshId = GetOrCreateMeshGpuData(meshData).id;
 
-		glBindVertexArray(meshGpuData[mesh.meshData].gl_vao);
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, sharedGpuData_gl_ubo);
-		if (mesh.materials[i]->UsesTessellation())
-		{
-			assert(mesh.meshData->vertexCountPerPrimitive == mesh.materials[i]->tessPatchVertexCount);
-			glPatchParameteri(GL_PATCH_VERTICES, mesh.materials[i]->tessPatchVertexCount);
-			glDrawElements(GL_PATCHES, drawEnd - drawStart, GL_UNSIGNED_INT, (void*)(drawStart * sizeof(uint32_t)));
-		}
-		else
-		{
-			assert(mesh.meshData->vertexCountPerPrimitive == 3);
-			glDrawElements(GL_TRIANGLES, drawEnd - drawStart, GL_UNSIGNED_INT, (void*)(drawStart * sizeof(uint32_t)));
-		}
+	for (uint32_t i = 0; i < meshData->pieceCount; i++)
+	{
+		GlMaterial* materialToUse = GetOrCreateMaterial(mesh.materials[i], meshData->vertexBufferLayout);
+		renderQueue.Submit(RenderQueue::ComputeKey(RenderPass::World, mesh.materials[i]->IsTransparent(), materialToUse->m_shader->GetId(), materialToUse->m_id, meshId, i, depth),
+			{ meshData, mesh.materials[i], materialToUse, SKINNING_DISABLED, i, modelMatrix }, boundsIndex);
 	}
 }
 
@@ -540,50 +858,150 @@ void sf::Renderer::DrawSkinnedMesh(SkinnedMesh& mesh, Transform& transform)
 {
 	assert(mesh.skeletonData != nullptr);
 
-	if (skeletonSsbos.find(mesh.skeletonData) == skeletonSsbos.end()) // create skeleton ssbo if not there
-	{
-		uint32_t newSsbo;
-		glGenBuffers(1, &newSsbo);
-		skeletonSsbos[mesh.skeletonData] = newSsbo;
-	}
-
 	if (mesh.meshData->vertexCount == 0)
 		return;
 
 	if (!activeCameraEntity)
 		return;
 
-	if (meshGpuData.find(mesh.meshData) == meshGpuData.end()) // create mesh data if not there
-		CreateMeshGpuData(mesh.meshData);
+	uint32_t skinningOffset = mesh.skeletonData->m_animate ? GetOrPackSkinningOffset(mesh.skeletonData) : SKINNING_DISABLED;
 
-	sharedGpuData.modelMatrix = transform.ComputeMatrix();
-	glBindBuffer(GL_UNIFORM_BUFFER, sharedGpuData_gl_ubo);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(SharedGpuData), &sharedGpuData, GL_DYNAMIC_DRAW);
+	glm::mat4 modelMatrix = transform.ComputeMatrix();
+	float depth = ComputeNormalizedDepth(transform.position);
 
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, skeletonSsbos[mesh.skeletonData]);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, mesh.skeletonData->m_skinningMatrices.size() * sizeof(glm::mat4), &(mesh.skeletonData->m_skinningMatrices[0][0][0]), GL_DYNAMIC_DRAW);
-
-	for (uint32_t i = 0; i < mesh.meshData->pieceCount; i++)
+	const MeshData* meshData = mesh.meshData;
+	uint32_t boundsIndex = ~0U;
+	if (mesh.meshData->HasBounds())
 	{
-		GlMaterial* materialToUse = GetOrCreateMaterial(mesh.materials[i], mesh.meshData->vertexBufferLayout);
-		materialToUse->Bind(rendererUniformVector);
-		materialToUse->m_shader->SetUniform1i("animate", mesh.skeletonData->m_animate);
-
-		uint32_t drawEnd, drawStart;
-		drawStart = mesh.meshData->pieces[i];
-		drawEnd = mesh.meshData->pieceCount > i + 1 ? mesh.meshData->pieces[i + 1] : mesh.meshData->indexCount;
+		glm::vec3 center = mesh.meshData->boundingSphereCenter;
+		float radius = mesh.meshData->boundingSphereRadius;
+		if (mesh.skeletonData->m_animate)
+			ComputeSkinnedBounds(mesh.meshData, mesh.skeletonData, center, radius);
+		glm::vec3 worldCenter = glm::vec3(modelMatrix * glm::vec4(center, 1.0f));
+		boundsIndex = renderQueue.AddBounds(worldCenter, radius * glm::abs(transform.scale));
+		meshData = SelectLod(mesh.meshData, mesh.lod, worldCenter, glm::abs(transform.scale));
+	}
+	uint32_t meshId = GetOrCreateMeshGpuData(meshData).id;
 
-		glBindVertexArray(meshGpuData[mesh.meshData].gl_vao);
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, sharedGpuData_gl_ubo);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, skeletonSsbos[mesh.skeletonData]);
-		assert(mesh.meshData->vertexCountPerPrimitive == 3);
-		glDrawElements(GL_TRIANGLES, drawEnd - drawStart, GL_UNSIGNED_INT, (void*)(drawStart * sizeof(uint32_t)));
+	for (uint32_t i = 0; i < meshData->pieceCount; i++)
+	{
+		GlMaterial* materialToUse = GetOrCreateMaterial(mesh.materials[i], meshData->vertexBufferLayout);
+		renderQueue.Submit(RenderQueue::ComputeKey(RenderPass::World, mesh.materials[i]->IsTransparent(), materialToUse->m_shader->GetId(), materialToUse->m_id, meshId, i, depth),
+			{ meshData, mesh.materials[i], materialToUse, skinningOffset, i, modelMatrix }, boundsIndex);
 	}
 
 	if (debugDrawEnabled)
 		DebugDrawSkeleton(mesh, transform);
 }
 
+void sf::Renderer::DrawRenderQueue()
+{
+	renderQueue.Cull(cameraFrustum);
+	renderQueue.Sort();
+
+	if (skinningData.size() > 0)
+	{
+		uint32_t skinningDataSize = (uint32_t)(skinningData.size() * sizeof(glm::vec4));
+		GlRingBuffer::Allocation allocation = frameRingBuffer.Allocate(skinningDataSize, storageBufferOffsetAlignment);
+		memcpy(allocation.pointer, skinningData.data(), skinningDataSize);
+		GlState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, SKINNING_DATA_SSBO_BINDING, allocation.gl_buffer, allocation.offset, skinningDataSize);
+	}
+
+	GlMaterial* boundMaterial = nullptr;
+	for (uint32_t i = 0; i < renderQueue.Size();)
+	{
+		const DrawPacket& packet = renderQueue.Get(i);
+
+		if (packet.glMaterial != boundMaterial)
+		{
+			packet.glMaterial->Bind(rendererUniformVector);
+			boundMaterial = packet.glMaterial;
+		}
+
+		if (packet.meshData != nullptr)
+			GlState::BindVertexArray(GetMeshGpuData(packet.meshData).arena->gl_vao);
+
+		if (packet.meshData == nullptr || !packet.glMaterial->m_shader->SupportsInstancing())
+		{
+			UploadObjectGpuData(packet.modelMatrix);
+			if (packet.meshData != nullptr && packet.meshData->vertexBufferLayout->GetComponentInfo(BufferComponent::BoneIndices) != nullptr)
+				UploadInstanceGpuData(i, 1); // the skinning offset is still read per instance
+			DrawPacketGeometry(packet);
+			i++;
+			continue;
+		}
+
+		// shaders using MODEL_MATRIX read it from the instance ssbo along with the skinning offset, the whole
+		// run of packets sharing this material goes out in a single multi draw indirect call
+		uint32_t packetCount = 1;
+		while (i + packetCount < renderQueue.Size() && CanShareMultiDraw(packet, renderQueue.Get(i + packetCount)))
+			packetCount++;
+		DrawPacketsIndirect(i, packetCount);
+		i += packetCount;
+	}
+
+	renderQueue.Clear();
+	skinningData.clear();
+	skinningGeneration++;
+}
+
+void sf::Renderer::Release(const MeshData* meshData)
+{
+	for (const MeshData* lod : meshData->lods)
+		Release(lod);
+	if (meshGpuData.Get(meshData->gpuHandle, meshData) == nullptr)
+		return;
+	meshGpuData.Retire(meshData->gpuHandle);
+	pendingReleases.push_back({ GpuResourceType::Mesh, meshData->gpuHandle, GL_RING_BUFFER_FRAME_COUNT });
+	meshData->gpuHandle = GpuHandle();
+}
+
+void sf::Renderer::Release(const SkeletonData* skeletonData)
+{
+	if (skeletonGpuData.Get(skeletonData->gpuHandle, skeletonData) == nullptr)
+		return;
+	skeletonGpuData.Retire(skeletonData->gpuHandle);
+	pendingReleases.push_back({ GpuResourceType::Skeleton, skeletonData->gpuHandle, GL_RING_BUFFER_FRAME_COUNT });
+	skeletonData->gpuHandle = GpuHandle();
+}
+
+void sf::Renderer::Release(const Bitmap* bitmap)
+{
+	if (spriteRegions.Get(bitmap->gpuHandle, bitmap) == nullptr)
+		return;
+	spriteRegions.Retire(bitmap->gpuHandle);
+	pendingReleases.push_back({ GpuResourceType::Bitmap, bitmap->gpuHandle, GL_RING_BUFFER_FRAME_COUNT });
+	bitmap->gpuHandle = GpuHandle();
+}
+
+void sf::Renderer::PrewarmMaterial(const Material* material, const BufferLayout* vertexBufferLayout)
+{
+	GlMaterial* glMaterial = GetOrCreateMaterialVariant(material, vertexBufferLayout, false);
+	if (!glMaterial->IsFinished() && std::find(prewarmingMaterials.begin(), prewarmingMaterials.end(), glMaterial) == prewarmingMaterials.end())
+		prewarmingMaterials.push_back(glMaterial);
+}
+
+bool sf::Renderer::IsPrewarmingDone()
+{
+	for (int i = (int)prewarmingMaterials.size() - 1; i > -1; i--)
+	{
+		if (!prewarmingMaterials[i]->IsReady())
+			continue;
+		prewarmingMaterials[i]->Finish();
+		prewarmingMaterials.erase(prewarmingMaterials.begin() + i);
+	}
+	return prewarmingMaterials.size() == 0;
+}
+
+void sf::Renderer::Release(const Material* material)
+{
+	if (materials.Get(material->gpuHandle, material) == nullptr)
+		return;
+	materials.Retire(material->gpuHandle);
+	pendingReleases.push_back({ GpuResourceType::Material, material->gpuHandle, GL_RING_BUFFER_FRAME_COUNT });
+	material->gpuHandle = GpuHandle();
+}
+
 void sf::Renderer::DrawParticleSystem(ParticleSystem& particleSystem, Transform& transform, float deltaTime)
 {
 	if (!activeCameraEntity)
@@ -595,204 +1013,160 @@ void sf::Renderer::DrawParticleSystem(ParticleSystem& particleSystem, Transform&
 	void* perParticleBuffer = particleSystem.material->buffers[0].pointer;
 	uint32_t particleBufferSize = particleSystem.material->buffers[0].size;
 
-	if (meshGpuData.find(particleSystem.meshData) == meshGpuData.end()) // create mesh data if not there
-		CreateMeshGpuData(particleSystem.meshData);
+	const ArenaMeshGpuData& particleMeshGpuData = GetOrCreateMeshGpuData(particleSystem.meshData);
 
 	if (!particleSystem.dynamic)
 	{
 		materialToUse->Bind(rendererUniformVector);
 
-		sharedGpuData.modelMatrix = transform.ComputeMatrix();
-		glBindBuffer(GL_UNIFORM_BUFFER, sharedGpuData_gl_ubo);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(SharedGpuData), &sharedGpuData, GL_DYNAMIC_DRAW);
+		UploadObjectGpuData(transform.ComputeMatrix());
 
-		glBindVertexArray(meshGpuData[particleSystem.meshData].gl_vao);
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, sharedGpuData_gl_ubo);
-		glDrawElementsInstanced(GL_TRIANGLES, particleSystem.meshData->indexCount, GL_UNSIGNED_INT, (void*)0, particleSystem.particleCount);
+		const GlGeometryArena::Allocation& allocation = particleMeshGpuData.arena->Get(particleMeshGpuData.id);
+		GlState::BindVertexArray(particleMeshGpuData.arena->gl_vao);
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, particleSystem.meshData->indexCount, particleMeshGpuData.arena->GetGlIndexType(),
+			(void*)((uint64_t)allocation.firstIndex * particleMeshGpuData.arena->GetIndexSize()), particleSystem.particleCount, allocation.baseVertex);
+		RendererStats::Draw(particleSystem.particleCount, (uint64_t)particleSystem.meshData->indexCount / 3 * particleSystem.particleCount);
 		return;
 	}
 
-	glDepthMask(GL_FALSE); // Do not write to depth buffer
+	GlState::DepthMask(false); // Do not write to depth buffer
 
+	// particles move in the vertex shader, the velocity they were emitted with has to be in the buffer
+	assert(particleSystem.initialVelocity == glm::vec3(0.0f) || particleBufferLayout->GetComponentInfo(BufferComponent::Velocity) != nullptr);
+
+	ParticlePool& pool = particleSystem.pool;
 	float cycleTotalTime = particleSystem.timeBetweenEmissions * (particleSystem.particleCount / particleSystem.particlesPerEmission);
-	if (particleSystemData.find(&particleSystem) == particleSystemData.end())
+	if (pool.capacity != particleSystem.particleCount)
 	{
 		assert((particleSystem.particleCount % particleSystem.particlesPerEmission) == 0);
-		ParticleSystemData newParticleData;
+		assert(particleBufferSize >= particleSystem.particleCount * particleBufferLayout->GetSize());
 		memset(perParticleBuffer, 0, particleBufferSize);
+		pool.Create(particleSystem.particleCount);
+		pool.Pack(perParticleBuffer, *particleBufferLayout, 0, pool.capacity);
+		pool.dirtyCount = 0;
 		materialToUse->UpdateBufferData(0);
-		particleSystemData[&particleSystem] = newParticleData;
 	}
 
-	if (particleSystemData[&particleSystem].emissionTimer < 0.0f)
+	if (pool.emissionTimer < 0.0f)
 	{
 		if (particleSystem.emit)
 		{
-			for (uint32_t i = 0; i < particleSystem.particlesPerEmission; i++)
+			const Transform* initialTransforms = nullptr;
+			if (particleSystem.initialTransforms != nullptr || particleSystem.initialTransform != nullptr)
 			{
-				uint32_t emittingParticle = (particleSystemData[&particleSystem].currentParticle + i) % particleSystem.particleCount;
-				glm::vec3* emittingParticlePosition = particleBufferLayout->Access<glm::vec3>(perParticleBuffer, BufferComponent::Position, emittingParticle);
-				glm::quat* emittingParticleRotation = particleBufferLayout->Access<glm::quat>(perParticleBuffer, BufferComponent::Rotation, emittingParticle);
-				float* emittingParticleScale = particleBufferLayout->Access<float>(perParticleBuffer, BufferComponent::Scale, emittingParticle);
-				float* emittingParticleSpawnTime = particleBufferLayout->Access<float>(perParticleBuffer, BufferComponent::SpawnTime, emittingParticle);
-
-				*emittingParticlePosition = transform.position;
-				*emittingParticleRotation = transform.rotation;
-				*emittingParticleScale = transform.scale;
-				*emittingParticleSpawnTime = particleSystemData[&particleSystem].cycleCurrentTime;
-
-				if (particleSystem.initialTransform != nullptr)
+				particleInitialTransforms.resize(particleSystem.particlesPerEmission);
+				if (particleSystem.initialTransforms != nullptr)
+					particleSystem.initialTransforms(particleInitialTransforms.data(), particleSystem.particlesPerEmission);
+				else
 				{
-					Transform initial = particleSystem.initialTransform();
-					*emittingParticlePosition += transform.rotation * initial.position;
-					*emittingParticleRotation *= initial.rotation;
-					*emittingParticleScale *= initial.scale;
+					for (uint32_t i = 0; i < particleSystem.particlesPerEmission; i++)
+						particleInitialTransforms[i] = particleSystem.initialTransform();
 				}
+				initialTransforms = particleInitialTransforms.data();
 			}
+			pool.Emit(pool.currentParticle, particleSystem.particlesPerEmission, transform, initialTransforms, particleSystem.initialVelocity, pool.cycleCurrentTime);
 		}
 		else
-		{
-			for (uint32_t i = 0; i < particleSystem.particlesPerEmission; i++)
-			{
-				uint32_t disablingParticle = (particleSystemData[&particleSystem].currentParticle + i) % particleSystem.particleCount;
-				float* disablingParticleScale = particleBufferLayout->Access<float>(perParticleBuffer, BufferComponent::Scale, disablingParticle);
-				float* disablingParticleSpawnTime = particleBufferLayout->Access<float>(perParticleBuffer, BufferComponent::SpawnTime, disablingParticle);
-
-				*disablingParticleScale = 0.0f;
-				*disablingParticleSpawnTime = -1.0f;
-			}
-		}
+			pool.Disable(pool.currentParticle, particleSystem.particlesPerEmission);
 
-		materialToUse->UpdateBufferData(0,
-			particleBufferLayout->GetSize() * particleSystemData[&particleSystem].currentParticle,
-			particleBufferLayout->GetSize() * particleSystem.particlesPerEmission);
-
-		particleSystemData[&particleSystem].emissionTimer += particleSystem.timeBetweenEmissions;
+		pool.emissionTimer += particleSystem.timeBetweenEmissions;
 		if (particleSystem.emit)
-			particleSystemData[&particleSystem].particlesToWaitFor = particleSystem.particleCount;
-		else if (particleSystemData[&particleSystem].particlesToWaitFor > 0u)
-			particleSystemData[&particleSystem].particlesToWaitFor -=  particleSystem.particlesPerEmission;
-		particleSystemData[&particleSystem].currentParticle = (particleSystemData[&particleSystem].currentParticle + particleSystem.particlesPerEmission) % particleSystem.particleCount;
+			pool.particlesToWaitFor = particleSystem.particleCount;
+		else if (pool.particlesToWaitFor > 0u)
+			pool.particlesToWaitFor -= particleSystem.particlesPerEmission;
+		pool.currentParticle = (pool.currentParticle + particleSystem.particlesPerEmission) % particleSystem.particleCount;
 	}
 
-	if (particleSystemData[&particleSystem].particlesToWaitFor != 0)
+	if (pool.dirtyCount > 0)
+	{
+		// the dirty range can wrap around the end of the ring
+		uint32_t stride = particleBufferLayout->GetSize();
+		uint32_t firstRangeCount = std::min(pool.dirtyCount, pool.capacity - pool.dirtyFirst);
+		pool.Pack(perParticleBuffer, *particleBufferLayout, pool.dirtyFirst, firstRangeCount);
+		materialToUse->UpdateBufferData(0, stride * pool.dirtyFirst, stride * firstRangeCount);
+		if (pool.dirtyCount > firstRangeCount)
+		{
+			pool.Pack(perParticleBuffer, *particleBufferLayout, 0, pool.dirtyCount - firstRangeCount);
+			materialToUse->UpdateBufferData(0, 0, stride * (pool.dirtyCount - firstRangeCount));
+		}
+		pool.dirtyCount = 0;
+	}
+
+	if (pool.particlesToWaitFor != 0)
 	{
 		materialToUse->Bind(rendererUniformVector);
 
-		materialToUse->m_shader->SetUniform1f("PARTICLE_CYCLE_TIME", particleSystemData[&particleSystem].cycleCurrentTime);
-		materialToUse->m_shader->SetUniform1f("PARTICLE_LIFETIME", cycleTotalTime);
+		materialToUse->m_shader->SetUniform1f(BuiltinUniform::ParticleCycleTime, pool.cycleCurrentTime);
+		materialToUse->m_shader->SetUniform1f(BuiltinUniform::ParticleLifetime, cycleTotalTime);
+		materialToUse->m_shader->SetUniform3fv(BuiltinUniform::ParticleAcceleration, &particleSystem.acceleration.x);
 
-		sharedGpuData.modelMatrix = transform.ComputeMatrix();
-		glBindBuffer(GL_UNIFORM_BUFFER, sharedGpuData_gl_ubo);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(SharedGpuData), &sharedGpuData, GL_DYNAMIC_DRAW);
+		UploadObjectGpuData(transform.ComputeMatrix());
 
-		glBindVertexArray(meshGpuData[particleSystem.meshData].gl_vao);
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, sharedGpuData_gl_ubo);
-		glDrawElementsInstanced(GL_TRIANGLES, particleSystem.meshData->indexCount, GL_UNSIGNED_INT, (void*)0, particleSystem.particleCount);
+		const GlGeometryArena::Allocation& allocation = particleMeshGpuData.arena->Get(particleMeshGpuData.id);
+		GlState::BindVertexArray(particleMeshGpuData.arena->gl_vao);
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, particleSystem.meshData->indexCount, particleMeshGpuData.arena->GetGlIndexType(),
+			(void*)((uint64_t)allocation.firstIndex * particleMeshGpuData.arena->GetIndexSize()), particleSystem.particleCount, allocation.baseVertex);
+		RendererStats::Draw(particleSystem.particleCount, (uint64_t)particleSystem.meshData->indexCount / 3 * particleSystem.particleCount);
 	}
 
-	particleSystemData[&particleSystem].emissionTimer -= deltaTime;
-	particleSystemData[&particleSystem].cycleCurrentTime = glm::mod(particleSystemData[&particleSystem].cycleCurrentTime + deltaTime, cycleTotalTime);
+	pool.emissionTimer -= deltaTime;
+	pool.cycleCurrentTime = glm::mod(pool.cycleCurrentTime + deltaTime, cycleTotalTime);
 
-	glDepthMask(GL_TRUE); // Restore depth mask
+	GlState::DepthMask(true); // Restore depth mask
 }
 
 void sf::Renderer::DrawSprite(Sprite& sprite, ScreenCoordinates& screenCoordinates)
 {
-	glDisable(GL_DEPTH_TEST);
-
-	if (!spriteShader.Initialized())
-		CreateSpriteGpuData();
-
-	if (spriteTextures.find(sprite.bitmap) == spriteTextures.end()) // create mesh data if not there
-		spriteTextures[sprite.bitmap].CreateFromBitmap(*sprite.bitmap, GlTexture::ClampToEdge, false);
+	GlSpriteBatcher::Region* region = spriteRegions.Get(sprite.bitmap->gpuHandle, sprite.bitmap);
+	if (region == nullptr) // pack bitmap if not there
+	{
+		sprite.bitmap->gpuHandle = spriteRegions.Add(sprite.bitmap, spriteBatcher.AddBitmap(*sprite.bitmap));
+		region = spriteRegions.Get(sprite.bitmap->gpuHandle, sprite.bitmap);
+	}
 
 	glm::vec2 spriteTopLeft = screenCoordinates.origin * glm::vec2(window->GetWidth(), window->GetHeight()) + (glm::vec2)screenCoordinates.offset;
 	if (sprite.alignmentH != ALIGNMENT_LEFT) spriteTopLeft.x -= ((float)sprite.bitmap->width) * (sprite.alignmentH * 0.5f);
 	if (sprite.alignmentV != ALIGNMENT_LEFT) spriteTopLeft.y -= ((float)sprite.bitmap->height) * (sprite.alignmentV * 0.5f);
 	spriteTopLeft = glm::vec2(glm::round(spriteTopLeft.x), glm::round(spriteTopLeft.y));
-	spriteQuad.vertices[2] = spriteTopLeft;
-	spriteQuad.vertices[0] = spriteTopLeft + glm::vec2(0.0f, (float)(sprite.bitmap->height));
-	spriteQuad.vertices[6] = spriteTopLeft + glm::vec2((float)(sprite.bitmap->width), (float)(sprite.bitmap->height));
-	spriteQuad.vertices[4] = spriteTopLeft + glm::vec2((float)(sprite.bitmap->width), 0.0f);
-
-	glBindBuffer(GL_UNIFORM_BUFFER, sharedGpuData_gl_ubo);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(SharedGpuData), &sharedGpuData, GL_DYNAMIC_DRAW);
-
-	spriteShader.Bind();
-	spriteTextures[sprite.bitmap].Bind(0);
-	spriteShader.SetUniform1i("bitmap", 0);
-	glPolygonMode(GL_FRONT, GL_FILL);
-	glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
-
-	glBindVertexArray(spriteQuad.gl_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, spriteQuad.gl_vertexBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * 2 * 4, spriteQuad.vertices, GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, spriteQuad.gl_indexBuffer);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * 6, spriteQuad.indices, GL_DYNAMIC_DRAW);
-
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, sharedGpuData_gl_ubo);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-	glEnable(GL_DEPTH_TEST);
+	spriteBatcher.Add(*region, spriteTopLeft, glm::vec2((float)sprite.bitmap->width, (float)sprite.bitmap->height));
 }
 
-void sf::Renderer::DrawText(Text& text, ScreenCoordinates& screenCoordinates)
+void sf::Renderer::DrawSpriteBatch()
 {
-	glDisable(GL_DEPTH_TEST);
+	if (screenQuadGpuData.gl_indexBuffer == ~0U)
+		CreateScreenQuadGpuData();
 
-	unsigned fontPathHash = Hash::SimpleStringHash(text.fontPath);
-	unsigned stringHash = Hash::SimpleStringHash(text.string);
-	if (fontPathToFontData.find(fontPathHash) == fontPathToFontData.end())
-		fontPathToFontData.insert({ fontPathHash, SebText::FontData(text.fontPath) });
-	if (fontPathAndStringToTextData.find(fontPathHash) == fontPathAndStringToTextData.end() || fontPathAndStringToTextData[fontPathHash].find(stringHash) == fontPathAndStringToTextData[fontPathHash].end())
+	if (!spriteShader.Initialized())
 	{
-		fontPathAndStringToTextData.insert({ fontPathHash, std::unordered_map<unsigned, TextGpuData>() });
-		fontPathAndStringToTextData[fontPathHash].insert({ stringHash, TextGpuData(text.string, fontPathToFontData.at(fontPathHash)) });
-		SebText::TextData& td = fontPathAndStringToTextData[fontPathHash].at(stringHash).textData;
-		if (td.PrintableCharacters.size() > 0)
-		{
-			SebText::TextRenderData trd = SebText::CreateRenderData(td.UniquePrintableCharacters, fontPathToFontData.at(fontPathHash));
-			prevGlyphRenderData = trd.AllGlyphData;
-			CreateTextGpuData(text.fontPath, text.string, trd, td);
-		}
+		Material spriteMat;
+		spriteMat.vertShaderFilePath = "assets/shaders/sprite.vert";
+		spriteMat.fragShaderFilePath = "assets/shaders/sprite.frag";
+		spriteShader.Create(spriteMat, &positionUvVertexLayout);
 	}
-	if (textMeshGpuData.gl_indexBuffer == ~0U)
-	{
-		glGenVertexArrays(1, &textMeshGpuData.gl_vao);
-		glGenBuffers(1, &textMeshGpuData.gl_vertexBuffer);
-		glGenBuffers(1, &textMeshGpuData.gl_indexBuffer);
-
-		glBindVertexArray(textMeshGpuData.gl_vao);
-		glBindBuffer(GL_ARRAY_BUFFER, textMeshGpuData.gl_vertexBuffer);
 
-		// update vertices
-		glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(SebText::Vertex), SebText::MeshVertices, GL_STATIC_DRAW);
-
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, textMeshGpuData.gl_indexBuffer);
-		// update indices to draw
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(unsigned int), SebText::MeshIndices, GL_STATIC_DRAW);
-
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SebText::Vertex), (void*)0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SebText::Vertex), (void*)(sizeof(glm::vec3)));
+	GlState::SetEnabled(GL_DEPTH_TEST, false);
+	spriteShader.Bind();
+	spriteShader.SetUniform1i(BuiltinUniform::Bitmap, 0);
+	GlState::PolygonMode(GL_FRONT, GL_FILL);
+	GlState::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+	GlState::BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
+	GlState::BindVertexArray(screenQuadGpuData.gl_vao);
 
-		glBindBuffer(GL_ARRAY_BUFFER, textMeshGpuData.gl_vertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(SebText::Vertex), SebText::MeshVertices, GL_STATIC_DRAW);
+	spriteBatcher.Draw(frameRingBuffer, storageBufferOffsetAlignment);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, textMeshGpuData.gl_indexBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(unsigned int), SebText::MeshIndices, GL_STATIC_DRAW);
+	GlState::SetEnabled(GL_DEPTH_TEST, true);
+}
 
-		glBindVertexArray(0);
-	}
+void sf::Renderer::DrawText(Text& text, ScreenCoordinates& screenCoordinates)
+{
+	glm::vec2 targetOffset = screenCoordinates.origin * glm::vec2(window->GetWidth(), window->GetHeight()) + (glm::vec2)screenCoordinates.offset;
+	textBatcher.Add(text.fontPath, text.string, text.color, text.size, text.alignmentH, text.alignmentV, targetOffset, text.renderMode);
+}
 
-	textLayoutSettings.FontSize = text.size;
-	textLayoutSettings.AlignmentH = text.alignmentH;
-	textLayoutSettings.AlignmentV = text.alignmentV;
-	glBindBuffer(GL_UNIFORM_BUFFER, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ubo_layoutData);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(SebText::LayoutSettings), &textLayoutSettings, GL_DYNAMIC_DRAW);
+void sf::Renderer::DrawTextBatch()
+{
+	if (screenQuadGpuData.gl_indexBuffer == ~0U)
+		CreateScreenQuadGpuData();
 
 	if (!textShader.Initialized())
 	{
@@ -802,26 +1176,30 @@ void sf::Renderer::DrawText(Text& text, ScreenCoordinates& screenCoordinates)
 		textShader.Create(textMat, &positionUvVertexLayout);
 	}
 
+	GlState::SetEnabled(GL_DEPTH_TEST, false);
 	textShader.Bind();
-	glPolygonMode(GL_FRONT, GL_FILL);
-	glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
-	textShader.SetUniform4fv("textCol", &text.color.r);
-	glm::vec2 targetOffset = screenCoordinates.origin * glm::vec2(window->GetWidth(), window->GetHeight()) + (glm::vec2)screenCoordinates.offset;
-	textShader.SetUniform2fv("globalOffset", &targetOffset.x);
-	textShader.SetUniform1i("lineCount", fontPathAndStringToTextData[fontPathHash].at(stringHash).textData.LineCount);
+	GlState::PolygonMode(GL_FRONT, GL_FILL);
+	GlState::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+	GlState::BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
+	GlState::BindVertexArray(screenQuadGpuData.gl_vao);
 
-	glBindVertexArray(textMeshGpuData.gl_vao);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, sharedGpuData_gl_ubo);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_perInstanceData);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_bezierData);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_glyphMetaData);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ssbo_lastCharPerLine);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 5, fontPathAndStringToTextData[fontPathHash].at(stringHash).gl_ubo_layoutData);
+	textBatcher.Draw(frameRingBuffer, storageBufferOffsetAlignment);
 
-	glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0, fontPathAndStringToTextData[fontPathHash].at(stringHash).textData.PrintableCharacters.size());
+	if (textBatcher.HasMsdfText())
+	{
+		if (!msdfTextShader.Initialized())
+		{
+			Material msdfTextMat;
+			msdfTextMat.vertShaderFilePath = "assets/shaders/msdfText.vert";
+			msdfTextMat.fragShaderFilePath = "assets/shaders/msdfText.frag";
+			msdfTextShader.Create(msdfTextMat, &positionUvVertexLayout);
+		}
+		msdfTextShader.Bind();
+		msdfTextShader.SetUniform1i(BuiltinUniform::Atlas, 0);
+		textBatcher.DrawMsdf(frameRingBuffer, storageBufferOffsetAlignment);
+	}
 
-	glEnable(GL_DEPTH_TEST);
+	GlState::SetEnabled(GL_DEPTH_TEST, true);
 }
 
 void sf::Renderer::AddLine(const glm::vec3& a, const glm::vec3& b, const glm::vec3& color)
@@ -848,8 +1226,7 @@ void sf::Renderer::DebugDrawSkeleton(SkinnedMesh& mesh, Transform& transform)
 	if (!activeCameraEntity)
 		return;
 
-	if (meshGpuData.find(&Defaults::MeshDataCube()) == meshGpuData.end()) // create mesh data if not there
-		CreateMeshGpuData(&Defaults::MeshDataCube());
+	GetOrCreateMeshGpuData(&Defaults::MeshDataCube());
 
 	for (uint32_t i = 0; i < mesh.skeletonData->m_boneData.size(); i++)
 	{
@@ -904,15 +1281,16 @@ void sf::Renderer::DrawLines()
 {
 	if (drawLineLines.size() == 0)
 		return;
-	glDisable(GL_DEPTH_TEST);
+	GlState::SetEnabled(GL_DEPTH_TEST, false);
 	if (!drawLineDataInitialized)
 	{
 		glGenVertexArrays(1, &drawLineVAO);
 		glGenBuffers(1, &drawLineVBO);
 
-		glBindVertexArray(drawLineVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, drawLineVBO);
+		GlState::BindVertexArray(drawLineVAO);
+		GlState::BindBuffer(GL_ARRAY_BUFFER, drawLineVBO);
 		glBufferData(GL_ARRAY_BUFFER, drawLineLines.size() * sizeof(LineVertex), drawLineLines.data(), GL_DYNAMIC_DRAW);
+		RendererStats::Upload(RendererStats::UploadSite::Lines, drawLineLines.size() * sizeof(LineVertex));
 
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex), (void*)offsetof(LineVertex, pos));
@@ -928,43 +1306,56 @@ void sf::Renderer::DrawLines()
 	}
 
 	drawLineShader.Bind();
-	glPolygonMode(GL_FRONT, GL_FILL);
-	glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
-
-	glBindBuffer(GL_UNIFORM_BUFFER, sharedGpuData_gl_ubo);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(SharedGpuData), &sharedGpuData, GL_DYNAMIC_DRAW);
-
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, sharedGpuData_gl_ubo);
+	GlState::PolygonMode(GL_FRONT, GL_FILL);
+	GlState::BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+	GlState::BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
 
-	glBindVertexArray(drawLineVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, drawLineVBO);
+	GlState::BindVertexArray(drawLineVAO);
+	GlState::BindBuffer(GL_ARRAY_BUFFER, drawLineVBO);
 
 	glBufferData(GL_ARRAY_BUFFER, drawLineLines.size() * sizeof(LineVertex), drawLineLines.data(), GL_DYNAMIC_DRAW);
+	RendererStats::Upload(RendererStats::UploadSite::Lines, drawLineLines.size() * sizeof(LineVertex));
 
 	glDrawArrays(GL_LINES, 0, drawLineLines.size());
+	RendererStats::Draw(1, 0); // lines are not counted as primitives
 
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glEnable(GL_DEPTH_TEST);
+	GlState::SetEnabled(GL_DEPTH_TEST, true);
 }
 
 void sf::Renderer::Terminate()
 {
-	for (auto& pair : meshGpuData)
-	{
-		glDeleteVertexArrays(1, &(pair.second.gl_vao));
-		glDeleteBuffers(1, &(pair.second.gl_indexBuffer));
-		glDeleteBuffers(1, &(pair.second.gl_vertexBuffer));
-	}
+	ProcessPendingReleases(true);
 
-	for (auto& pair : materials)
+	for (auto* arenas : { &geometryArenas, &shortIndexGeometryArenas })
 	{
-		for (auto& p : pair.second)
-			delete p.second;
+		for (auto& pair : *arenas)
+		{
+			pair.second->Delete();
+			delete pair.second;
+		}
+		arenas->clear();
 	}
+	meshGpuData.Clear();
+
+	materials.ForEach([](MaterialGpuData& gpuData) {
+		for (auto& variant : gpuData.variants)
+		{
+			variant.second->Delete();
+			delete variant.second;
+		}
+	});
+	materials.Clear();
+	prewarmingMaterials.clear();
+	skeletonGpuData.Clear();
+	skinningData.clear();
+	spriteRegions.Clear();
+	spriteBatcher.Delete();
 	drawLineShader.Delete();
 
+	frameRingBuffer.Delete();
+	offscreenTarget.Delete();
+	textBatcher.Delete();
+
 	environmentData.envTexture.Delete();
 	environmentData.envCubemap.Delete();
 	environmentData.irradianceCubemap.Delete();
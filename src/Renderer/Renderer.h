@@ -14,6 +14,7 @@
 #include <Components/BoxCollider.h>
 
 #include <Renderer/GlMaterial.h>
+#include <Renderer/RendererStats.h>
 #include <Window.h>
 #include <Material.h>
 
@@ -26,10 +27,20 @@ namespace sf::Renderer {
 
 	void Predraw();
 	void Postdraw();
+	/* Reads the frame drawn so far into an rgb bitmap with the first row at the top, call it before swapping buffers */
+	void ReadFrame(Bitmap& target);
+	/* Counters of the last finished frame, memory is what the renderer held when it ended */
+	const RendererStats::Frame& GetLastFrameStats();
+
+	/* Vertex shaders bake the format in, call it before any material is created */
+	void SetSkinningFormat(SkinningFormat format);
 
 	void SetClearColor(const glm::vec3& clearColorArg);
 	const glm::vec3& GetClearColor();
 
+	/* Meshes draw their coarsest lod whose simplification error is smaller than this on screen, see MeshProcessor::GenerateLods */
+	void SetLodThreshold(float pixels);
+
 	void SetActiveCameraEntity(Entity cameraEntity);
 	Entity GetActiveCameraEntity();
 
@@ -38,10 +49,24 @@ namespace sf::Renderer {
 	void DrawSkybox();
 	void DrawMesh(Mesh& mesh, Transform& transform);
 	void DrawSkinnedMesh(SkinnedMesh& mesh, Transform& transform);
+	void DrawRenderQueue();
+	/* Gpu data is deleted a few frames later, drawing the resource again creates it anew. Meshes release their lods too */
+	void Release(const MeshData* meshData);
+	void Release(const SkeletonData* skeletonData);
+	void Release(const Bitmap* bitmap);
+	void Release(const Material* material);
+	/* Starts compiling the material for the layout without waiting, compilation runs in parallel if the driver supports it */
+	void PrewarmMaterial(const Material* material, const BufferLayout* vertexBufferLayout);
+	/* Finishes prewarmed materials whose programs are ready, true once there are none left */
+	bool IsPrewarmingDone();
 	void DrawParticleSystem(ParticleSystem& particleSystem, Transform& transform, float deltaTime);
 
+	/* Sprites are queued and drawn together by DrawSpriteBatch */
 	void DrawSprite(Sprite& sprite, ScreenCoordinates& screenCoordinates);
+	void DrawSpriteBatch();
+	/* Texts are queued and drawn together by DrawTextBatch */
 	void DrawText(Text& text, ScreenCoordinates& screenCoordinates);
+	void DrawTextBatch();
 
 	void AddLine(const glm::vec3& a, const glm::vec3& b, const glm::vec3& color);
 
@@ -0,0 +1,111 @@
+#include "RendererStats.h"
+
+#include <unordered_map>
+
+namespace sf::RendererStats
+{
+	Frame currentFrame;
+	Frame lastFrame;
+	std::unordered_map<uint32_t, uint64_t> trackedObjects[(uint32_t)MemoryCategory::Count];
+	uint64_t heldMemory[(uint32_t)MemoryCategory::Count] = { 0 };
+
+	inline uint32_t GetBytesPerPixel(GLenum internalFormat)
+	{
+		switch (internalFormat)
+		{
+		case GL_R8: return 1;
+		case GL_RG8: case GL_R16: case GL_R16F: return 2;
+		case GL_RGB: case GL_RGB8: return 3;
+		case GL_RGBA: case GL_RGBA8: case GL_RG16: case GL_RG16F: case GL_R32F: return 4;
+		case GL_RGB16: case GL_RGB16F: return 6;
+		case GL_RGBA16: case GL_RGBA16F: case GL_RG32F: return 8;
+		case GL_RGB32F: return 12;
+		case GL_RGBA32F: return 16;
+		default: return 4;
+		}
+	}
+}
+
+void sf::RendererStats::Draw(uint32_t instanceCount, uint64_t primitiveCount)
+{
+	currentFrame.drawCalls++;
+	currentFrame.instances += instanceCount;
+	currentFrame.primitives += primitiveCount;
+}
+
+void sf::RendererStats::Upload(UploadSite site, uint64_t bytes)
+{
+	currentFrame.uploadedBytes[(uint32_t)site] += bytes;
+}
+
+void sf::RendererStats::TrackMemory(MemoryCategory category, uint32_t gl_id, uint64_t bytes)
+{
+	uint64_t& tracked = trackedObjects[(uint32_t)category][gl_id];
+	heldMemory[(uint32_t)category] += bytes - tracked;
+	tracked = bytes;
+}
+
+void sf::RendererStats::ReleaseMemory(MemoryCategory category, uint32_t gl_id)
+{
+	auto iterator = trackedObjects[(uint32_t)category].find(gl_id);
+	if (iterator == trackedObjects[(uint32_t)category].end())
+		return;
+	heldMemory[(uint32_t)category] -= iterator->second;
+	trackedObjects[(uint32_t)category].erase(iterator);
+}
+
+void sf::RendererStats::TrackTexture(uint32_t gl_id, GLenum internalFormat, uint32_t width, uint32_t height, uint32_t layers, bool mipmap)
+{
+	uint64_t levelBytes = (uint64_t)width * height * layers * GetBytesPerPixel(internalFormat);
+	uint64_t bytes = levelBytes;
+	if (mipmap)
+	{
+		while (width > 1 || height > 1)
+		{
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+			bytes += (uint64_t)width * height * layers * GetBytesPerPixel(internalFormat);
+		}
+	}
+	TrackMemory(MemoryCategory::Textures, gl_id, bytes);
+}
+
+void sf::RendererStats::EndFrame()
+{
+	currentFrame.glState = GlState::GetLastFrameStats();
+	for (uint32_t i = 0; i < (uint32_t)MemoryCategory::Count; i++)
+		currentFrame.memory[i] = heldMemory[i];
+	lastFrame = currentFrame;
+	currentFrame = Frame();
+}
+
+const sf::RendererStats::Frame& sf::RendererStats::GetLastFrame()
+{
+	return lastFrame;
+}
+
+const char* sf::RendererStats::GetUploadSiteName(UploadSite site)
+{
+	switch (site)
+	{
+	case UploadSite::MaterialBuffers: return "Material buffers";
+	case UploadSite::MeshGeometry: return "Mesh geometry";
+	case UploadSite::TextOutlines: return "Text outlines";
+	case UploadSite::Lines: return "Lines";
+	case UploadSite::StaticGeometry: return "Static geometry";
+	case UploadSite::FrameRingBuffer: return "Frame ring buffer";
+	default: return "";
+	}
+}
+
+const char* sf::RendererStats::GetMemoryCategoryName(MemoryCategory category)
+{
+	switch (category)
+	{
+	case MemoryCategory::Meshes: return "Meshes";
+	case MemoryCategory::Textures: return "Textures";
+	case MemoryCategory::TextBuffers: return "Text buffers";
+	case MemoryCategory::StorageBuffers: return "Storage buffers";
+	default: return "";
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+#include <Renderer/GlState.h>
+
+namespace sf::RendererStats {
+
+	/*
+	 * Per frame counters for what the renderer submits and uploads, plus the gpu memory it holds.
+	 * Memory is tracked per gl object so reallocating one just replaces its previous size.
+	 */
+
+	/* Places that write buffer data, ring buffer writes count when they are allocated */
+	enum class UploadSite
+	{
+		MaterialBuffers,
+		MeshGeometry,
+		TextOutlines,
+		Lines,
+		StaticGeometry,
+		FrameRingBuffer,
+		Count
+	};
+
+	enum class MemoryCategory
+	{
+		Meshes,
+		Textures,
+		TextBuffers,
+		StorageBuffers,
+		Count
+	};
+
+	struct Frame
+	{
+		uint32_t drawCalls = 0;
+		uint64_t instances = 0;
+		uint64_t primitives = 0; // triangles, or patches for tessellated materials
+		GlState::Stats glState;
+		uint64_t uploadedBytes[(uint32_t)UploadSite::Count] = { 0 };
+		uint64_t memory[(uint32_t)MemoryCategory::Count] = { 0 }; // bytes held when the frame ended
+	};
+
+	void Draw(uint32_t instanceCount, uint64_t primitiveCount);
+	void Upload(UploadSite site, uint64_t bytes);
+
+	/* Sets the size of a gl object, ids are only unique within a category */
+	void TrackMemory(MemoryCategory category, uint32_t gl_id, uint64_t bytes);
+	void ReleaseMemory(MemoryCategory category, uint32_t gl_id);
+	/* Mipmapped textures count a full chain, unknown formats count 4 bytes per pixel */
+	void TrackTexture(uint32_t gl_id, GLenum internalFormat, uint32_t width, uint32_t height, uint32_t layers, bool mipmap);
+
+	/* Call after GlState::EndFrame so the bind counts are the ones of the frame that just ended */
+	void EndFrame();
+	const Frame& GetLastFrame();
+
+	const char* GetUploadSiteName(UploadSite site);
+	const char* GetMemoryCategoryName(MemoryCategory category);
+}
@@ -3,6 +3,8 @@
 #include <cstring>
 #include <glm/gtx/vector_angle.hpp>
 
+#include <Profiler.h>
+
 uint32_t sf::SkeletonData::AddNodeSingle(uint32_t animationIndex, float speed)
 {
 	m_nodes.emplace_back();
@@ -74,6 +76,7 @@ uint32_t sf::SkeletonData::AddNodeBlendSpace2D(const std::vector<BlendSpacePoint
 
 void sf::SkeletonData::UpdateAnimation(float deltaTime)
 {
+	SF_PROFILE_SCOPE("SkeletonData::UpdateAnimation");
 	uint32_t nodeCount = m_nodes.size();
 	if (nodeCount == 0)
 		return;
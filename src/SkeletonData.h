@@ -5,6 +5,7 @@
 #include <unordered_map>
 
 #include <Animation.h>
+#include <GpuHandle.h>
 #include <Components/Transform.h>
 
 namespace sf
@@ -70,5 +71,7 @@ namespace sf
 
 		std::vector<Animation::Node> m_nodes;
 		std::unordered_map<uint32_t, TwoBoneIkData> m_ikData;
+
+		mutable GpuHandle gpuHandle; // assigned by the renderer
 	};
 }
\ No newline at end of file
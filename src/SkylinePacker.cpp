@@ -0,0 +1,84 @@
+#include "SkylinePacker.h"
+
+void sf::SkylinePacker::Create(uint32_t width, uint32_t height)
+{
+	this->width = width;
+	this->height = height;
+	Clear();
+}
+
+void sf::SkylinePacker::Clear()
+{
+	skyline.clear();
+	skyline.push_back({ 0, 0, width });
+}
+
+bool sf::SkylinePacker::Fit(uint32_t nodeIndex, uint32_t rectWidth, uint32_t rectHeight, uint32_t& outY) const
+{
+	uint32_t x = skyline[nodeIndex].x;
+	if (x + rectWidth > width)
+		return false;
+	// the rect rests on the highest node it spans
+	uint32_t y = 0;
+	uint32_t widthLeft = rectWidth;
+	for (uint32_t i = nodeIndex; widthLeft > 0; i++)
+	{
+		y = skyline[i].y > y ? skyline[i].y : y;
+		if (y + rectHeight > height)
+			return false;
+		widthLeft = skyline[i].width >= widthLeft ? 0 : widthLeft - skyline[i].width;
+	}
+	outY = y;
+	return true;
+}
+
+bool sf::SkylinePacker::Insert(uint32_t rectWidth, uint32_t rectHeight, glm::uvec2& outPosition)
+{
+	int bestIndex = -1;
+	uint32_t bestY = ~0U;
+	for (uint32_t i = 0; i < skyline.size(); i++)
+	{
+		uint32_t y;
+		if (Fit(i, rectWidth, rectHeight, y) && y < bestY)
+		{
+			bestIndex = i;
+			bestY = y;
+		}
+	}
+	if (bestIndex == -1)
+		return false;
+
+	outPosition = glm::uvec2(skyline[bestIndex].x, bestY);
+	Node newNode = { skyline[bestIndex].x, bestY + rectHeight, rectWidth };
+	skyline.insert(skyline.begin() + bestIndex, newNode);
+
+	// trim the nodes now covered by the new one
+	uint32_t newNodeEnd = newNode.x + newNode.width;
+	for (uint32_t i = bestIndex + 1; i < skyline.size();)
+	{
+		if (skyline[i].x >= newNodeEnd)
+			break;
+		uint32_t nodeEnd = skyline[i].x + skyline[i].width;
+		if (nodeEnd <= newNodeEnd)
+		{
+			skyline.erase(skyline.begin() + i);
+			continue;
+		}
+		skyline[i].width = nodeEnd - newNodeEnd;
+		skyline[i].x = newNodeEnd;
+		break;
+	}
+
+	// merge neighbours at the same height
+	for (uint32_t i = 0; i + 1 < skyline.size();)
+	{
+		if (skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else
+			i++;
+	}
+	return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace sf {
+
+	/*
+	 * Packs rectangles into a fixed size area keeping only the top edge of the used space, each
+	 * rectangle goes where it ends up lowest, leftmost on ties. Space can't be freed individually,
+	 * Clear resets the whole area.
+	 */
+	struct SkylinePacker
+	{
+		struct Node
+		{
+			uint32_t x;
+			uint32_t y;
+			uint32_t width;
+		};
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<Node> skyline;
+
+		void Create(uint32_t width, uint32_t height);
+		void Clear();
+		bool Insert(uint32_t rectWidth, uint32_t rectHeight, glm::uvec2& outPosition);
+
+	private:
+		bool Fit(uint32_t nodeIndex, uint32_t rectWidth, uint32_t rectHeight, uint32_t& outY) const;
+	};
+}
@@ -0,0 +1,216 @@
+#include "VertexFormat.h"
+
+#include <cstring>
+#include <cassert>
+
+namespace sf::VertexFormat
+{
+	// https://knarkowicz.wordpress.com/2014/04/16/octahedron-normal-vector-encoding/
+	inline glm::vec2 OctEncode(glm::vec3 n)
+	{
+		float l1Norm = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+		if (l1Norm == 0.0f)
+			return glm::vec2(0.0f);
+		n /= l1Norm;
+		if (n.z >= 0.0f)
+			return glm::vec2(n.x, n.y);
+		return glm::vec2(
+			(1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+			(1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+	}
+
+	inline glm::vec3 OctDecode(const glm::vec2& e)
+	{
+		glm::vec3 n = glm::vec3(e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+		float t = glm::max(-n.z, 0.0f);
+		n.x += n.x >= 0.0f ? -t : t;
+		n.y += n.y >= 0.0f ? -t : t;
+		return glm::normalize(n);
+	}
+
+	// rounds every weight and gives the rounding error to the biggest one so quantized weights still add up to one
+	template <typename T>
+	inline void QuantizeBoneWeights(const glm::vec4& weights, T* target, float maxValue)
+	{
+		float sum = weights.x + weights.y + weights.z + weights.w;
+		glm::vec4 normalized = sum > 0.0f ? weights / sum : glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+		int32_t total = 0;
+		uint32_t biggest = 0;
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			target[i] = (T)glm::clamp(normalized[i] * maxValue + 0.5f, 0.0f, maxValue);
+			total += target[i];
+			biggest = normalized[i] > normalized[biggest] ? i : biggest;
+		}
+		target[biggest] = (T)((int32_t)target[biggest] + (int32_t)maxValue - total);
+	}
+}
+
+bool sf::VertexFormat::IsSupported(BufferComponent component, DataType dataType)
+{
+	if (dataType == BufferLayout::GetComponentDataType(component))
+		return true;
+	switch (component)
+	{
+	case BufferComponent::Normal:
+	case BufferComponent::Tangent:
+		return dataType == DataType::vec4i16 || dataType == DataType::vec2i16;
+	case BufferComponent::Color:
+		return dataType == DataType::vec4u8;
+	case BufferComponent::UV:
+		return dataType == DataType::vec2f16;
+	case BufferComponent::BoneWeights:
+	case BufferComponent::BoneIndices:
+		return dataType == DataType::vec4u8 || dataType == DataType::vec4u16;
+	default:
+		return false;
+	}
+}
+
+bool sf::VertexFormat::IsInteger(BufferComponent component, DataType dataType)
+{
+	return component == BufferComponent::BoneIndices && (dataType == DataType::vec4u8 || dataType == DataType::vec4u16);
+}
+
+bool sf::VertexFormat::IsOctahedral(BufferComponent component, DataType dataType)
+{
+	return (component == BufferComponent::Normal || component == BufferComponent::Tangent) && dataType == DataType::vec2i16;
+}
+
+uint32_t sf::VertexFormat::GetShaderComponentCount(BufferComponent component, DataType dataType)
+{
+	switch (dataType)
+	{
+	case DataType::f32:
+		return 1;
+	case DataType::vec2f32:
+	case DataType::vec2f16:
+	case DataType::vec2i16:
+		return 2;
+	case DataType::vec3f32:
+		return 3;
+	case DataType::vec4i16:
+		return component == BufferComponent::Normal || component == BufferComponent::Tangent ? 3 : 4;
+	case DataType::vec4u8:
+		return component == BufferComponent::Color ? 3 : 4;
+	case DataType::vec4f32:
+	case DataType::vec4u16:
+		return 4;
+	default:
+		assert(!"Unsupported vertex data type");
+		return 0;
+	}
+}
+
+glm::vec4 sf::VertexFormat::Decode(BufferComponent component, DataType dataType, const void* source)
+{
+	glm::vec4 value = glm::vec4(0.0f);
+	switch (dataType)
+	{
+	case DataType::f32:
+	case DataType::vec2f32:
+	case DataType::vec3f32:
+	case DataType::vec4f32:
+		memcpy(&value, source, GetDataTypeSize(dataType));
+		return value;
+	case DataType::vec2f16:
+		return glm::vec4(glm::unpackHalf2x16(*(const uint32_t*)source), 0.0f, 0.0f);
+	case DataType::vec2i16:
+	{
+		glm::vec2 encoded = glm::unpackSnorm2x16(*(const uint32_t*)source);
+		if (IsOctahedral(component, dataType))
+			return glm::vec4(OctDecode(encoded), 0.0f);
+		return glm::vec4(encoded, 0.0f, 0.0f);
+	}
+	case DataType::vec4i16:
+		value = glm::vec4(glm::unpackSnorm2x16(((const uint32_t*)source)[0]), glm::unpackSnorm2x16(((const uint32_t*)source)[1]));
+		break;
+	case DataType::vec4u8:
+	{
+		const uint8_t* bytes = (const uint8_t*)source;
+		if (IsInteger(component, dataType))
+			return glm::vec4(bytes[0], bytes[1], bytes[2], bytes[3]);
+		value = glm::unpackUnorm4x8(*(const uint32_t*)source);
+		break;
+	}
+	case DataType::vec4u16:
+	{
+		const uint16_t* shorts = (const uint16_t*)source;
+		if (IsInteger(component, dataType))
+			return glm::vec4(shorts[0], shorts[1], shorts[2], shorts[3]);
+		value = glm::vec4(glm::unpackUnorm2x16(((const uint32_t*)source)[0]), glm::unpackUnorm2x16(((const uint32_t*)source)[1]));
+		break;
+	}
+	default:
+		assert(!"Unsupported vertex data type");
+		return value;
+	}
+	if (GetShaderComponentCount(component, dataType) == 3)
+		value.w = 0.0f;
+	return value;
+}
+
+void sf::VertexFormat::Encode(BufferComponent component, DataType dataType, const glm::vec4& value, void* target)
+{
+	switch (dataType)
+	{
+	case DataType::f32:
+	case DataType::vec2f32:
+	case DataType::vec3f32:
+	case DataType::vec4f32:
+		memcpy(target, &value, GetDataTypeSize(dataType));
+		return;
+	case DataType::vec2f16:
+		*(uint32_t*)target = glm::packHalf2x16(glm::vec2(value));
+		return;
+	case DataType::vec2i16:
+		*(uint32_t*)target = glm::packSnorm2x16(IsOctahedral(component, dataType) ? OctEncode(glm::vec3(value)) : glm::vec2(value));
+		return;
+	case DataType::vec4i16:
+	{
+		glm::vec4 padded = GetShaderComponentCount(component, dataType) == 3 ? glm::vec4(glm::vec3(value), 0.0f) : value;
+		((uint32_t*)target)[0] = glm::packSnorm2x16(glm::vec2(padded.x, padded.y));
+		((uint32_t*)target)[1] = glm::packSnorm2x16(glm::vec2(padded.z, padded.w));
+		return;
+	}
+	case DataType::vec4u8:
+	{
+		if (IsInteger(component, dataType))
+		{
+			uint8_t* bytes = (uint8_t*)target;
+			for (uint32_t i = 0; i < 4; i++)
+				bytes[i] = (uint8_t)glm::clamp(value[i] + 0.5f, 0.0f, 255.0f);
+			return;
+		}
+		if (component == BufferComponent::BoneWeights)
+		{
+			QuantizeBoneWeights(value, (uint8_t*)target, 255.0f);
+			return;
+		}
+		glm::vec4 padded = GetShaderComponentCount(component, dataType) == 3 ? glm::vec4(glm::vec3(value), 0.0f) : value;
+		*(uint32_t*)target = glm::packUnorm4x8(padded);
+		return;
+	}
+	case DataType::vec4u16:
+	{
+		if (IsInteger(component, dataType))
+		{
+			uint16_t* shorts = (uint16_t*)target;
+			for (uint32_t i = 0; i < 4; i++)
+				shorts[i] = (uint16_t)glm::clamp(value[i] + 0.5f, 0.0f, 65535.0f);
+			return;
+		}
+		if (component == BufferComponent::BoneWeights)
+		{
+			QuantizeBoneWeights(value, (uint16_t*)target, 65535.0f);
+			return;
+		}
+		((uint32_t*)target)[0] = glm::packUnorm2x16(glm::vec2(value.x, value.y));
+		((uint32_t*)target)[1] = glm::packUnorm2x16(glm::vec2(value.z, value.w));
+		return;
+	}
+	default:
+		assert(!"Unsupported vertex data type");
+		return;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <BufferLayout.h>
+
+/*
+ * Compact data types a buffer layout can store its components with instead of the default float ones:
+ * - Normal, Tangent: vec4i16 snorm (w unused), vec2i16 octahedral snorm
+ * - Color: vec4u8 unorm (a unused)
+ * - UV: vec2f16
+ * - BoneWeights: vec4u8 or vec4u16 unorm
+ * - BoneIndices: vec4u8 or vec4u16, read as integers by the vertex shader
+ * Meshes are built and processed with the default types and converted with MeshData::ChangeVertexBufferLayout
+ * right before they are uploaded, cpu side code reading vertices through views expects the float types.
+ */
+namespace sf::VertexFormat
+{
+	bool IsSupported(BufferComponent component, DataType dataType);
+	/* Integer attributes are not converted to float when the vertex shader reads them */
+	bool IsInteger(BufferComponent component, DataType dataType);
+	bool IsOctahedral(BufferComponent component, DataType dataType);
+	/* Components the vertex shader sees, padded types read fewer than they store */
+	uint32_t GetShaderComponentCount(BufferComponent component, DataType dataType);
+
+	/* Unused components are zero */
+	glm::vec4 Decode(BufferComponent component, DataType dataType, const void* source);
+	void Encode(BufferComponent component, DataType dataType, const glm::vec4& value, void* target);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+namespace sf
+{
+	/*
+	 * Strided view over one component of an interleaved vertex buffer. The offset and stride are resolved
+	 * once when the view is made, so indexing it is plain pointer arithmetic. A nonzero Stride argument makes
+	 * the stride a compile time constant, that is what StaticBufferLayout views use.
+	 */
+	template <typename T, uint32_t Stride = 0>
+	class VertexView
+	{
+	private:
+		uint8_t* m_data = nullptr;
+		uint32_t m_stride = Stride;
+		uint32_t m_count = 0;
+
+	public:
+		class Iterator
+		{
+		private:
+			uint8_t* m_pointer;
+			uint32_t m_stride;
+
+		public:
+			inline Iterator(uint8_t* pointer, uint32_t stride) : m_pointer(pointer), m_stride(stride) {}
+			inline T& operator*() const { return *(T*)m_pointer; }
+			inline T* operator->() const { return (T*)m_pointer; }
+			inline T& operator[](ptrdiff_t offset) const { return *(T*)(m_pointer + offset * (ptrdiff_t)GetStride()); }
+			inline Iterator& operator++() { m_pointer += GetStride(); return *this; }
+			inline Iterator& operator+=(ptrdiff_t offset) { m_pointer += offset * (ptrdiff_t)GetStride(); return *this; }
+			inline Iterator operator+(ptrdiff_t offset) const { return Iterator(m_pointer + offset * (ptrdiff_t)GetStride(), m_stride); }
+			inline ptrdiff_t operator-(const Iterator& other) const { return (m_pointer - other.m_pointer) / (ptrdiff_t)GetStride(); }
+			inline bool operator==(const Iterator& other) const { return m_pointer == other.m_pointer; }
+			inline bool operator!=(const Iterator& other) const { return m_pointer != other.m_pointer; }
+			inline uint32_t GetStride() const { return Stride != 0 ? Stride : m_stride; }
+		};
+
+		VertexView() = default;
+		/* data points at the component in the first vertex */
+		inline VertexView(void* data, uint32_t stride, uint32_t count) : m_data((uint8_t*)data), m_stride(stride), m_count(count) {}
+
+		inline bool IsValid() const { return m_data != nullptr; }
+		inline uint32_t Size() const { return m_count; }
+		inline uint32_t GetStride() const { return Stride != 0 ? Stride : m_stride; }
+		/* True when the components are packed back to back, bulk copies are then a single memcpy */
+		inline bool IsContiguous() const { return GetStride() == sizeof(T); }
+
+		inline T& operator[](uint32_t index) const { return *(T*)(m_data + (size_t)GetStride() * index); }
+		inline Iterator begin() const { return Iterator(m_data, GetStride()); }
+		inline Iterator end() const { return Iterator(m_data + (size_t)GetStride() * m_count, GetStride()); }
+
+		/* A view over count vertices starting at first */
+		inline VertexView Subview(uint32_t first, uint32_t count) const
+		{
+			if (m_data == nullptr)
+				return VertexView();
+			return VertexView(m_data + (size_t)GetStride() * first, GetStride(), count);
+		}
+
+		template <typename Target>
+		inline void CopyTo(Target* target) const
+		{
+			static_assert(sizeof(Target) == sizeof(T));
+			if (IsContiguous())
+			{
+				memcpy((void*)target, m_data, (size_t)m_count * sizeof(T));
+				return;
+			}
+			for (uint32_t i = 0; i < m_count; i++)
+				memcpy((void*)(target + i), m_data + (size_t)GetStride() * i, sizeof(T));
+		}
+
+		template <typename Source>
+		inline void CopyFrom(const Source* source) const
+		{
+			static_assert(sizeof(Source) == sizeof(T));
+			if (IsContiguous())
+			{
+				memcpy(m_data, (const void*)source, (size_t)m_count * sizeof(T));
+				return;
+			}
+			for (uint32_t i = 0; i < m_count; i++)
+				memcpy(m_data + (size_t)GetStride() * i, (const void*)(source + i), sizeof(T));
+		}
+
+		inline void Fill(const T& value) const
+		{
+			for (uint32_t i = 0; i < m_count; i++)
+				(*this)[i] = value;
+		}
+	};
+}
@@ -2,6 +2,7 @@
 
 #include <Geometry.h>
 #include <Math.hpp>
+#include <Profiler.h>
 
 void sf::VoxelVolumeData::BuildEmpty(const glm::uvec3& voxelCountPerAxis, const BufferLayout* voxelBufferLayout, float voxelSize, const glm::vec3& offset)
 {
@@ -14,6 +15,7 @@ void sf::VoxelVolumeData::BuildEmpty(const glm::uvec3& voxelCountPerAxis, const
 
 void sf::VoxelVolumeData::BuildFromMesh(const MeshData& mesh, float voxelSize, const BufferLayout* voxelBufferLayout)
 {
+	SF_PROFILE_SCOPE("VoxelVolumeData::BuildFromMesh");
 	if (voxelBufferLayout != nullptr)
 		this->voxelBufferLayout = *voxelBufferLayout;
 	DataType positionDataType = mesh.vertexBufferLayout->GetComponentInfo(BufferComponent::Position)->dataType;
@@ -23,18 +25,28 @@ void sf::VoxelVolumeData::BuildFromMesh(const MeshData& mesh, float voxelSize, c
 
 	this->voxelSize = voxelSize;
 
+	VertexView<glm::vec3> positions = mesh.GetVertexView<glm::vec3>(BufferComponent::Position);
+
 	// compute mesh AABB
-	glm::vec3 minP = *mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, 0);
+	glm::vec3 minP = positions[0];
 	glm::vec3 maxP = minP;
-	for (int i = 1; i < mesh.vertexCount; i++)
+	for (const glm::vec3& position : positions)
+	{
+		minP = glm::min(minP, position);
+		maxP = glm::max(maxP, position);
+	}
+
+	// mesh components blended into each voxel component, resolved once instead of per voxel
+	std::vector<VertexView<glm::vec2>> meshVec2Components;
+	std::vector<VertexView<glm::vec3>> meshVec3Components;
+	if (voxelBufferLayout != nullptr)
 	{
-		glm::vec3* posPtr = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, i);
-		minP.x = glm::min(minP.x, posPtr->x);
-		minP.y = glm::min(minP.y, posPtr->y);
-		minP.z = glm::min(minP.z, posPtr->z);
-		maxP.x = glm::max(maxP.x, posPtr->x);
-		maxP.y = glm::max(maxP.y, posPtr->y);
-		maxP.z = glm::max(maxP.z, posPtr->z);
+		for (const BufferComponentInfo& bci : voxelBufferLayout->GetComponentInfos())
+		{
+			bool blended = bci.component == BufferComponent::Normal || bci.component == BufferComponent::Color || bci.component == BufferComponent::UV;
+			meshVec2Components.push_back(blended && bci.dataType == DataType::vec2f32 ? mesh.GetVertexView<glm::vec2>(bci.component) : VertexView<glm::vec2>());
+			meshVec3Components.push_back(blended && bci.dataType == DataType::vec3f32 ? mesh.GetVertexView<glm::vec3>(bci.component) : VertexView<glm::vec3>());
+		}
 	}
 
 	this->offset = minP;
@@ -53,15 +65,15 @@ void sf::VoxelVolumeData::BuildFromMesh(const MeshData& mesh, float voxelSize, c
 		uint32_t indexB = mesh.indexBuffer[indexI + 1];
 		uint32_t indexC = mesh.indexBuffer[indexI + 2];
 
-		glm::vec3* posPtrA = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, indexA);
-		glm::vec3* posPtrB = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, indexB);
-		glm::vec3* posPtrC = mesh.AccessVertexComponent<glm::vec3>(BufferComponent::Position, indexC);
+		const glm::vec3& posA = positions[indexA];
+		const glm::vec3& posB = positions[indexB];
+		const glm::vec3& posC = positions[indexC];
 		glm::vec3 triNormal = glm::cross(
-			*posPtrB - *posPtrA,
-			*posPtrC - *posPtrA);
+			posB - posA,
+			posC - posA);
 
-		glm::vec3 trianglebbmin = glm::min(glm::min(*posPtrA, *posPtrB), *posPtrC);
-		glm::vec3 trianglebbmax = glm::max(glm::max(*posPtrA, *posPtrB), *posPtrC);
+		glm::vec3 trianglebbmin = glm::min(glm::min(posA, posB), posC);
+		glm::vec3 trianglebbmax = glm::max(glm::max(posA, posB), posC);
 		glm::uvec3 minVoxelCoords = {
 			glm::clamp((int)((trianglebbmin.x - minP.x) / voxelSize), 0, (int)(voxelCountPerAxis.x - 1)),
 			glm::clamp((int)((trianglebbmin.y - minP.y) / voxelSize), 0, (int)(voxelCountPerAxis.y - 1)),
@@ -83,9 +95,9 @@ void sf::VoxelVolumeData::BuildFromMesh(const MeshData& mesh, float voxelSize, c
 					glm::vec3 currentVoxelCenter = (currentVoxelMin + currentVoxelMax) / 2.0f;
 
 					// approximation is good and fast
-					glm::vec3 voxelCenterOnTriangle = Geometry::ClosestPointPointTriangle(currentVoxelCenter, *posPtrA, *posPtrB, *posPtrC);
+					glm::vec3 voxelCenterOnTriangle = Geometry::ClosestPointPointTriangle(currentVoxelCenter, posA, posB, posC);
 					bool shouldFill = glm::distance2(voxelCenterOnTriangle, currentVoxelCenter) < voxelSize * voxelSize;
-					// bool shouldFill = Geometry::IntersectAABBTriangle(currentVoxelMin, currentVoxelMax, *posPtrA, *posPtrB, *posPtrC);
+					// bool shouldFill = Geometry::IntersectAABBTriangle(currentVoxelMin, currentVoxelMax, posA, posB, posC);
 
 					if (!shouldFill)
 						continue;
@@ -101,8 +113,10 @@ void sf::VoxelVolumeData::BuildFromMesh(const MeshData& mesh, float voxelSize, c
 						else
 							voxelCollisions[existingVoxel]++;
 					}
-					for (const BufferComponentInfo& bci : voxelBufferLayout->GetComponentInfos())
+					const std::vector<BufferComponentInfo>& voxelComponents = voxelBufferLayout->GetComponentInfos();
+					for (uint32_t j = 0; j < voxelComponents.size(); j++)
 					{
+						const BufferComponentInfo& bci = voxelComponents[j];
 						if (bci.component == BufferComponent::Position)
 						{
 							glm::vec3* voxelPosPointer = AccessVoxelComponent<glm::vec3>(BufferComponent::Position, currentVoxel);
@@ -110,71 +124,62 @@ void sf::VoxelVolumeData::BuildFromMesh(const MeshData& mesh, float voxelSize, c
 								*voxelPosPointer = currentVoxelCenter;
 							continue;
 						}
-						BufferComponent targetVertexComponent;
-						switch (bci.component)
-						{
-							case BufferComponent::Normal:
-								targetVertexComponent = BufferComponent::Normal;
-								break;
-							case BufferComponent::Color:
-								targetVertexComponent = BufferComponent::Color;
-								break;
-							case BufferComponent::UV:
-								targetVertexComponent = BufferComponent::UV;
-								break;
-							default:
-								continue;
-						}
-						if (mesh.vertexBufferLayout->GetComponentInfo(targetVertexComponent) == nullptr)
+						if (!meshVec2Components[j].IsValid() && !meshVec3Components[j].IsValid())
 							continue;
 
 						glm::vec2 toBlendVec2[3];
 						glm::vec3 toBlendVec3[3];
 						glm::vec2 blendVec2Out;
 						glm::vec3 blendVec3Out;
-						glm::vec3 barycentricCoords = Geometry::Barycentric(voxelCenterOnTriangle, *posPtrA, *posPtrB, *posPtrC);
+						glm::vec3 barycentricCoords = Geometry::Barycentric(voxelCenterOnTriangle, posA, posB, posC);
 
-						switch (bci.dataType)
+						if (meshVec2Components[j].IsValid())
 						{
-							case DataType::vec2f32:
-								toBlendVec2[0] = *mesh.AccessVertexComponent<glm::vec2>(targetVertexComponent, indexA);
-								toBlendVec2[1] = *mesh.AccessVertexComponent<glm::vec2>(targetVertexComponent, indexB);
-								toBlendVec2[2] = *mesh.AccessVertexComponent<glm::vec2>(targetVertexComponent, indexC);
-								Math::WeightedBlend(toBlendVec2, &barycentricCoords.x, 3, blendVec2Out);
-								*AccessVoxelComponent<glm::vec2>(bci.component, currentVoxel) += blendVec2Out;
-								break;
-							case DataType::vec3f32:
-								toBlendVec3[0] = *mesh.AccessVertexComponent<glm::vec3>(targetVertexComponent, indexA);
-								toBlendVec3[1] = *mesh.AccessVertexComponent<glm::vec3>(targetVertexComponent, indexB);
-								toBlendVec3[2] = *mesh.AccessVertexComponent<glm::vec3>(targetVertexComponent, indexC);
-								Math::WeightedBlend(toBlendVec3, &barycentricCoords.x, 3, blendVec3Out);
-								*AccessVoxelComponent<glm::vec3>(bci.component, currentVoxel) += blendVec3Out;
-								break;
+							toBlendVec2[0] = meshVec2Components[j][indexA];
+							toBlendVec2[1] = meshVec2Components[j][indexB];
+							toBlendVec2[2] = meshVec2Components[j][indexC];
+							Math::WeightedBlend(toBlendVec2, &barycentricCoords.x, 3, blendVec2Out);
+							*AccessVoxelComponent<glm::vec2>(bci.component, currentVoxel) += blendVec2Out;
+						}
+						else
+						{
+							toBlendVec3[0] = meshVec3Components[j][indexA];
+							toBlendVec3[1] = meshVec3Components[j][indexB];
+							toBlendVec3[2] = meshVec3Components[j][indexC];
+							Math::WeightedBlend(toBlendVec3, &barycentricCoords.x, 3, blendVec3Out);
+							*AccessVoxelComponent<glm::vec3>(bci.component, currentVoxel) += blendVec3Out;
 						}
 					}
 				}
 	}
 
-	for (const auto& pair : voxelCollisions)
+	if (voxelBufferLayout == nullptr)
+		return;
+	uint32_t voxelCount = (uint32_t)(voxelBuffer.size() / this->voxelBufferLayout.GetSize());
+	for (const BufferComponentInfo& bci : voxelBufferLayout->GetComponentInfos())
 	{
-		for (const BufferComponentInfo& bci : voxelBufferLayout->GetComponentInfos())
+		if (bci.component == BufferComponent::Position)
+			continue;
+		switch (bci.dataType)
 		{
-			if (bci.component == BufferComponent::Position)
-				continue;
-			switch (bci.dataType)
+			case DataType::vec2f32:
+			{
+				VertexView<glm::vec2> voxelComponent = this->voxelBufferLayout.View<glm::vec2>(voxelBuffer.data(), bci.component, voxelCount);
+				for (const auto& pair : voxelCollisions)
+					voxelComponent[pair.first] /= (float) pair.second;
+				break;
+			}
+			case DataType::vec3f32:
 			{
-				case DataType::vec2f32:
-					*(voxelBufferLayout->Access<glm::vec2>(voxelBuffer.data(), bci.component, pair.first)) /= (float) pair.second;
-					break;
-				case DataType::vec3f32:
+				VertexView<glm::vec3> voxelComponent = this->voxelBufferLayout.View<glm::vec3>(voxelBuffer.data(), bci.component, voxelCount);
+				for (const auto& pair : voxelCollisions)
+				{
 					if (bci.component == BufferComponent::Normal)
-					{
-						glm::vec3& temp = *(voxelBufferLayout->Access<glm::vec3>(voxelBuffer.data(), bci.component, pair.first));
-						temp = glm::normalize(temp);
-					}
+						voxelComponent[pair.first] = glm::normalize(voxelComponent[pair.first]);
 					else
-						*(voxelBufferLayout->Access<glm::vec3>(voxelBuffer.data(), bci.component, pair.first)) /= (float) pair.second;
-					break;
+						voxelComponent[pair.first] /= (float) pair.second;
+				}
+				break;
 			}
 		}
 	}
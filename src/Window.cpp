@@ -18,21 +18,22 @@
 #ifdef SF_USE_VULKAN
 #include <vulkan/vulkan.h>
 #endif
+#ifdef SF_PLATFORM_LINUX
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 #include <iostream>
+#include <chrono>
+#include <cstdlib>
 #include <cassert>
 
 #include <Input.h>
 
 std::unordered_map<GLFWwindow*, sf::Window*> sf::Window::windowMappingForCallbacks;
 
-sf::Window::Window(const Game::InitData& gameInitData)
+sf::Window::Window(const Game::InitData& gameInitData, bool headless)
 {
-	if (!glfwInit())
-	{
-		std::cout << "[Window] Failed to create window\n";
-		return;
-	}
 	title = gameInitData.windowTitle;
 	size = gameInitData.windowSize;
 	msaaCount = gameInitData.msaaCount;
@@ -41,6 +42,23 @@ sf::Window::Window(const Game::InitData& gameInitData)
 	cursorEnabled = cursorRequired = gameInitData.cursorRequired;
 	vsyncEnabled = gameInitData.vsyncEnabled;
 
+	this->headless = headless;
+	if (headless)
+	{
+		fullscreenEnabled = false;
+		vsyncEnabled = false;
+		headlessStartTime = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#ifdef SF_PLATFORM_LINUX
+		CreateHeadlessContext();
+		return;
+#endif
+	}
+
+	if (!glfwInit())
+	{
+		std::cout << "[Window] Failed to create window\n";
+		return;
+	}
 
 #ifdef SF_USE_VULKAN
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
@@ -51,6 +69,8 @@ sf::Window::Window(const Game::InitData& gameInitData)
 	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, true);
 #endif
 #endif
+	if (headless)
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
 	windowHandle = glfwCreateWindow(size.x, size.y, title.c_str(), fullscreenEnabled ? glfwGetPrimaryMonitor() : NULL, NULL);
 	if (!windowHandle)
@@ -94,33 +114,121 @@ sf::Window::Window(const Game::InitData& gameInitData)
 
 sf::Window::~Window()
 {
-	glfwDestroyWindow(windowHandle);
+#ifdef SF_PLATFORM_LINUX
+	if (eglDisplay != nullptr)
+	{
+		eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (eglContext != nullptr)
+			eglDestroyContext(eglDisplay, eglContext);
+		if (eglSurface != nullptr)
+			eglDestroySurface(eglDisplay, eglSurface);
+		eglTerminate(eglDisplay);
+		return;
+	}
+#endif
+	if (windowHandle != nullptr)
+		glfwDestroyWindow(windowHandle);
+}
+
+#ifdef SF_PLATFORM_LINUX
+void sf::Window::CreateHeadlessContext()
+{
+	// shaders are #version 460 and older llvmpipe builds only report 4.5, the user's own overrides win
+	setenv("MESA_GL_VERSION_OVERRIDE", "4.6", 0);
+	setenv("MESA_GLSL_VERSION_OVERRIDE", "460", 0);
+
+	// the surfaceless platform needs neither a display server nor a gpu, mesa falls back to its software rasterizer
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != nullptr)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint majorVersion, minorVersion;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &majorVersion, &minorVersion))
+	{
+		std::cout << "[Window] Failed to initialize EGL display\n";
+		return;
+	}
+	eglDisplay = display;
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "[Window] No EGL config supports desktop OpenGL pbuffers\n";
+		return;
+	}
+
+	// frames are drawn into the renderer's framebuffer, the pbuffer only gives the context a surface
+	const EGLint surfaceAttributes[] = { EGL_WIDTH, (EGLint)size.x, EGL_HEIGHT, (EGLint)size.y, EGL_NONE };
+	eglSurface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+	if (eglSurface == EGL_NO_SURFACE)
+	{
+		eglSurface = nullptr;
+		std::cout << "[Window] Failed to create EGL pbuffer surface\n";
+		return;
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+	const EGLint contextAttributes[] = {
+#ifdef SF_DEBUG
+		EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+		EGL_NONE
+	};
+	eglContext = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (eglContext == EGL_NO_CONTEXT || !eglMakeCurrent(display, eglSurface, eglSurface, eglContext))
+	{
+		std::cout << "[Window] Failed to create EGL context\n";
+		return;
+	}
+	std::cout << "[Window] Created headless EGL " << majorVersion << '.' << minorVersion << " context\n";
 }
+#endif
 
 void sf::Window::PollEvents()
 {
+	if (headless)
+		return;
 	glfwPollEvents();
 	glfwGetGamepadState(GLFW_JOYSTICK_1, (GLFWgamepadstate*)Input::GetGamepadState());
 }
 
 void sf::Window::SwapBuffers()
 {
+	if (headless)
+		return;
 	glfwSwapBuffers(windowHandle);
 }
 
 double sf::Window::GetTime()
 {
+	if (headless)
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count() - headlessStartTime;
 	return glfwGetTime();
 }
 
 bool sf::Window::ShouldClose()
 {
+	if (headless)
+		return false;
 	return glfwWindowShouldClose(windowHandle);
 }
 
 void sf::Window::SetFullScreenEnabled(bool enabled)
 {
-	if (fullscreenEnabled == enabled)
+	if (fullscreenEnabled == enabled || headless)
 		return;
 
 	fullscreenEnabled = enabled;
@@ -160,6 +268,8 @@ void sf::Window::SetFullScreenEnabled(bool enabled)
 
 void sf::Window::SetVsyncEnabled(bool enabled)
 {
+	if (headless)
+		return;
 	vsyncEnabled = enabled;
 	glfwSwapInterval(vsyncEnabled);
 }
@@ -168,7 +278,7 @@ void sf::Window::SetToolBarEnabled(bool enabled)
 {
 	toolBarEnabled = enabled;
 	bool cursorShouldBeEnabled = toolBarEnabled || cursorRequired;
-	if (cursorEnabled == cursorShouldBeEnabled)
+	if (cursorEnabled == cursorShouldBeEnabled || headless)
 		return;
 	cursorEnabled = cursorShouldBeEnabled;
 	glfwSetInputMode(windowHandle, GLFW_CURSOR, cursorEnabled ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
@@ -179,7 +289,7 @@ void sf::Window::SetCursorRequired(bool enabled)
 {
 	cursorRequired = enabled;
 	bool cursorShouldBeEnabled = toolBarEnabled || cursorRequired;
-	if (cursorEnabled == cursorShouldBeEnabled)
+	if (cursorEnabled == cursorShouldBeEnabled || headless)
 		return;
 	cursorEnabled = cursorShouldBeEnabled;
 	glfwSetInputMode(windowHandle, GLFW_CURSOR, cursorEnabled ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
@@ -206,6 +316,10 @@ bool sf::Window::ImGuiInitForOpenGL(bool(*initForOpenGL)(GLFWwindow*, bool))
 }
 void* sf::Window::GetOpenGlFunctionAddress() const
 {
+#ifdef SF_PLATFORM_LINUX
+	if (eglDisplay != nullptr)
+		return (void*) eglGetProcAddress;
+#endif
 	return (void*) glfwGetProcAddress;
 }
 #endif
@@ -276,7 +390,7 @@ void sf::Window::WindowResizeCallback(int width, int height)
 
 void sf::Window::Terminate()
 {
-	glfwTerminate();
+	glfwTerminate(); // does nothing if glfw was never initialized
 }
 
 void sf::Window::CursorPositionCallback(GLFWwindow* window, double xpos, double ypos) { windowMappingForCallbacks[window]->CursorPositionCallback(xpos, ypos); }
@@ -30,7 +30,8 @@ namespace sf
 {
 	struct Window
 	{
-		Window(const Game::InitData& gameInitData);
+		/* Headless windows render offscreen, on linux through an egl context that needs no display server */
+		Window(const Game::InitData& gameInitData, bool headless = false);
 		~Window();
 		void PollEvents();
 		void SwapBuffers();
@@ -45,6 +46,7 @@ namespace sf
 		inline bool GetVsyncEnabled() const { return vsyncEnabled; }
 		inline bool GetToolBarEnabled() const { return toolBarEnabled; }
 		inline bool GetCursorRequired() const { return cursorRequired; }
+		inline bool IsHeadless() const { return headless; }
 
 		void AddOnResizeCallback(void (*newCallback)(void)) const;
 
@@ -66,9 +68,18 @@ namespace sf
 		static void Terminate();
 
 	private:
-		GLFWwindow* windowHandle;
+		GLFWwindow* windowHandle = nullptr;
 		GLFWwindow* contextBackup; // used for imgui viewports
 
+		bool headless = false;
+		double headlessStartTime = 0.0;
+#ifdef SF_PLATFORM_LINUX
+		void* eglDisplay = nullptr;
+		void* eglSurface = nullptr;
+		void* eglContext = nullptr;
+		void CreateHeadlessContext();
+#endif
+
 		std::string title;
 		glm::uvec2 size = { 0, 0 };
 		uint32_t msaaCount = 4;
@@ -1,6 +1,7 @@
 #include <glm/glm.hpp>
 #include <filesystem>
 #include <iostream>
+#include <cstring>
 #include <vector>
 
 #include <Window.h>
@@ -24,6 +25,9 @@
 #include <Components/BoxCollider.h>
 
 #include <ImGuiController.h>
+#include <Profiler.h>
+
+#define HEADLESS_DELTA_TIME (1.0 / 60.0)
 
 float gameTime = 0.0;
 double lastFrameTime = 0.0;
@@ -48,13 +52,34 @@ int main(int argc, char** argv)
 		std::cout << "Adjusting working directory\n";
 	}
 
+	// --headless <frame count> draws that many frames offscreen with a fixed time step and exits,
+	// --capture <png path> writes the last one, --trace <json path> writes the profiler history on exit
+	bool headless = false;
+	uint32_t headlessFrameCount = 0;
+	const char* capturePath = nullptr;
+	const char* tracePath = nullptr;
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], "--headless") == 0)
+		{
+			headless = true;
+			headlessFrameCount = (uint32_t)atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--capture") == 0)
+			capturePath = argv[i + 1];
+		else if (strcmp(argv[i], "--trace") == 0)
+			tracePath = argv[i + 1];
+	}
+
 	sf::Game::InitData initData = sf::Game::GetInitData();
-	sf::Window window = sf::Window(initData);
+	sf::Window window = sf::Window(initData, headless);
 
-	sf::ImGuiController::Initialize(window);
+	if (!headless)
+		sf::ImGuiController::Initialize(window);
 
 	if (!sf::Renderer::Initialize(window, initData.clearColor))
 		std::cout << "Failed to initialize renderer\n";
+	sf::Profiler::Initialize();
 
 	sf::Entity::SetOnComponentAddCallback(sf::OnComponentAddedToEntity);
 
@@ -62,9 +87,13 @@ int main(int argc, char** argv)
 	sf::Game::Initialize(argc, argv);
 	//-------------------//
 
+	uint32_t frameCount = 0;
+	double headlessFrameTime = 0.0;
+
 	/* Loop until the user closes the window */
-	while (!window.ShouldClose())
+	while (!window.ShouldClose() && !(headless && frameCount == headlessFrameCount))
 	{
+		sf::Profiler::BeginFrame();
 		if (deltaTimeLock)
 		{
 			currentFrameTime = lastFrameTime = window.GetTime();
@@ -72,37 +101,56 @@ int main(int argc, char** argv)
 		}
 		else
 			currentFrameTime = window.GetTime();
-		deltaTime = currentFrameTime - lastFrameTime;
+		deltaTime = headless ? HEADLESS_DELTA_TIME : currentFrameTime - lastFrameTime;
 
-		//-------------------//
-		sf::Game::OnUpdate(deltaTime, gameTime);
-		//-------------------//
+		{
+			SF_PROFILE_SCOPE("Game::OnUpdate");
+			//-------------------//
+			sf::Game::OnUpdate(deltaTime, gameTime);
+			//-------------------//
+		}
 
 		gameTime += deltaTime;
 
 		/* Draw scene */
-		sf::Renderer::Predraw();
-		sf::Renderer::DrawSkybox();
-		auto meshRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::Mesh, sf::Transform>();
-		for (auto entity : meshRenderView)
 		{
-			auto [base, mesh, transform] = meshRenderView.get<sf::Base, sf::Mesh, sf::Transform>(entity);
-			if (base.isEntityEnabled)
-				sf::Renderer::DrawMesh(mesh, transform);
+			SF_PROFILE_GPU_SCOPE("Predraw");
+			sf::Renderer::Predraw();
+			sf::Renderer::DrawSkybox();
+		}
+		{
+			SF_PROFILE_GPU_SCOPE("Meshes");
+			auto meshRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::Mesh, sf::Transform>();
+			for (auto entity : meshRenderView)
+			{
+				auto [base, mesh, transform] = meshRenderView.get<sf::Base, sf::Mesh, sf::Transform>(entity);
+				if (base.isEntityEnabled)
+					sf::Renderer::DrawMesh(mesh, transform);
+			}
+		}
+		{
+			SF_PROFILE_GPU_SCOPE("Skinned meshes");
+			auto skinnedMeshRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::SkinnedMesh, sf::Transform>();
+			for (auto entity : skinnedMeshRenderView)
+			{
+				auto [base, mesh, transform] = skinnedMeshRenderView.get<sf::Base, sf::SkinnedMesh, sf::Transform>(entity);
+				if (base.isEntityEnabled)
+					sf::Renderer::DrawSkinnedMesh(mesh, transform);
+			}
 		}
-		auto skinnedMeshRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::SkinnedMesh, sf::Transform>();
-		for (auto entity : skinnedMeshRenderView)
 		{
-			auto [base, mesh, transform] = skinnedMeshRenderView.get<sf::Base, sf::SkinnedMesh, sf::Transform>(entity);
-			if (base.isEntityEnabled)
-				sf::Renderer::DrawSkinnedMesh(mesh, transform);
+			SF_PROFILE_GPU_SCOPE("Render queue");
+			sf::Renderer::DrawRenderQueue();
 		}
-		auto particlesRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::ParticleSystem, sf::Transform>();
-		for (auto entity : particlesRenderView)
 		{
-			auto [base, particleSystem, transform] = particlesRenderView.get<sf::Base, sf::ParticleSystem, sf::Transform>(entity);
-			if (base.isEntityEnabled)
-				sf::Renderer::DrawParticleSystem(particleSystem, transform, deltaTime);
+			SF_PROFILE_GPU_SCOPE("Particles");
+			auto particlesRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::ParticleSystem, sf::Transform>();
+			for (auto entity : particlesRenderView)
+			{
+				auto [base, particleSystem, transform] = particlesRenderView.get<sf::Base, sf::ParticleSystem, sf::Transform>(entity);
+				if (base.isEntityEnabled)
+					sf::Renderer::DrawParticleSystem(particleSystem, transform, deltaTime);
+			}
 		}
 		if (sf::Renderer::IsDebugDrawEnabled())
 		{
@@ -129,38 +177,71 @@ int main(int argc, char** argv)
 			}
 		}
 
-		sf::Renderer::DrawLines();
+		{
+			SF_PROFILE_GPU_SCOPE("Lines");
+			sf::Renderer::DrawLines();
+		}
 
-		auto spriteRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::Sprite, sf::ScreenCoordinates>();
-		for (auto entity : spriteRenderView)
 		{
-			auto [base, sprite, screenCooordinates] = spriteRenderView.get<sf::Base, sf::Sprite, sf::ScreenCoordinates>(entity);
-			if (base.isEntityEnabled)
-				sf::Renderer::DrawSprite(sprite, screenCooordinates);
+			SF_PROFILE_GPU_SCOPE("Sprites");
+			auto spriteRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::Sprite, sf::ScreenCoordinates>();
+			for (auto entity : spriteRenderView)
+			{
+				auto [base, sprite, screenCooordinates] = spriteRenderView.get<sf::Base, sf::Sprite, sf::ScreenCoordinates>(entity);
+				if (base.isEntityEnabled)
+					sf::Renderer::DrawSprite(sprite, screenCooordinates);
+			}
+			sf::Renderer::DrawSpriteBatch();
 		}
-		auto textRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::Text, sf::ScreenCoordinates>();
-		for (auto entity : textRenderView)
 		{
-			auto [base, text, screenCooordinates] = textRenderView.get<sf::Base, sf::Text, sf::ScreenCoordinates>(entity);
-			if (base.isEntityEnabled)
-				sf::Renderer::DrawText(text, screenCooordinates);
+			SF_PROFILE_GPU_SCOPE("Text");
+			auto textRenderView = sf::Scene::activeScene->GetRegistry().view<sf::Base, sf::Text, sf::ScreenCoordinates>();
+			for (auto entity : textRenderView)
+			{
+				auto [base, text, screenCooordinates] = textRenderView.get<sf::Base, sf::Text, sf::ScreenCoordinates>(entity);
+				if (base.isEntityEnabled)
+					sf::Renderer::DrawText(text, screenCooordinates);
+			}
+			sf::Renderer::DrawTextBatch();
 		}
 
-		sf::ImGuiController::Tick(deltaTime);
+		{
+			SF_PROFILE_GPU_SCOPE("ImGui");
+			if (!headless)
+				sf::ImGuiController::Tick(deltaTime);
+		}
+		if (headless && capturePath != nullptr && frameCount + 1 == headlessFrameCount)
+		{
+			sf::Bitmap frame;
+			sf::Renderer::ReadFrame(frame);
+			frame.WritePng(capturePath);
+		}
 		window.SwapBuffers();
 
 		sf::Renderer::Postdraw();
 		sf::Input::FrameEnd();
 		window.PollEvents();
 
+		if (headless)
+			headlessFrameTime += window.GetTime() - currentFrameTime;
 		lastFrameTime = currentFrameTime;
+		frameCount++;
+		sf::Profiler::EndFrame();
 	}
 
+	if (headless && frameCount > 0)
+		std::cout << "[Headless] " << frameCount << " frames, " << 1000.0 * headlessFrameTime / frameCount << " ms average frame time\n";
+
 	//-------------------//
 	sf::Game::Terminate();
 	//-------------------//
 
-	sf::ImGuiController::Terminate();
+	if (tracePath != nullptr)
+		sf::Profiler::WriteChromeTrace(tracePath);
+	sf::Profiler::Terminate();
+
+	if (!headless)
+		sf::ImGuiController::Terminate();
 	sf::Renderer::Terminate();
 	sf::Window::Terminate();
 	return 0;